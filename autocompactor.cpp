@@ -0,0 +1,34 @@
+/**
+ * @file autocompactor.cpp
+ * @brief File containing the implementation of the AutoCompactor class.
+ */
+
+#include "autocompactor.hpp"
+#include <algorithm>
+
+AutoCompactor::AutoCompactor(Libary &libary, const std::string &databaseFile, std::chrono::minutes interval)
+    : libary(libary), databaseFile(databaseFile), interval(std::max(interval, std::chrono::minutes(1)))
+{
+    thread = std::thread(&AutoCompactor::run, this);
+}
+
+AutoCompactor::~AutoCompactor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    thread.join();
+}
+
+void AutoCompactor::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wakeup.wait_for(lock, interval, [this]
+                            { return stopping; }))
+    {
+        // Skipped if the previous compaction is still running
+        libary.compactInBackground(databaseFile);
+    }
+}
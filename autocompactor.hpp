@@ -0,0 +1,58 @@
+/**
+ * @file autocompactor.hpp
+ * @brief File containing the declaration of the AutoCompactor class.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "libary.hpp"
+
+#ifndef AUTOCOMPACTOR_HPP
+#define AUTOCOMPACTOR_HPP
+
+/**
+ * @class AutoCompactor
+ * @brief Compacts the database file of a Libary at a fixed interval while the program runs.
+ *
+ * @details Every compaction runs in the background with Libary::compactInBackground(), so the library stays fully
+ * usable while the database file is written. If a compaction is still running when the next one is due, the next
+ * one is skipped. The compactor must be destroyed before the library.
+ */
+class AutoCompactor
+{
+private:
+    Libary &libary;  ///< The library to compact.
+    std::string databaseFile;  ///< The database file to replace.
+    std::chrono::minutes interval;  ///< The time between two compactions.
+    std::mutex mutex;  ///< Protects stopping.
+    std::condition_variable wakeup;  ///< Wakes the thread when stopping is set.
+    bool stopping = false;  ///< Whether the thread should end.
+    std::thread thread;  ///< Waits for the next compaction and starts it.
+
+    /**
+     * @brief Starts a compaction every interval until the compactor is destroyed.
+     */
+    void run();
+
+public:
+    /**
+     * @brief Starts compacting at a fixed interval. The first compaction starts one interval from now.
+     *
+     * @param libary The library to compact.
+     * @param databaseFile The database file to replace.
+     * @param interval The time between two compactions, at least one minute.
+     */
+    AutoCompactor(Libary &libary, const std::string &databaseFile, std::chrono::minutes interval);
+    AutoCompactor(const AutoCompactor &) = delete;
+    AutoCompactor &operator=(const AutoCompactor &) = delete;
+
+    /**
+     * @brief Stops starting compactions. A compaction that is running goes on, see Libary::waitForCompaction().
+     */
+    ~AutoCompactor();
+};
+
+#endif // AUTOCOMPACTOR_HPP
@@ -0,0 +1,480 @@
+/**
+ * @file batchrunner.cpp
+ * @brief File containing the implementation of the BatchRunner class.
+ */
+
+#include "batchrunner.hpp"
+#include "feedimporter.hpp"
+#include "utils.hpp"
+#include <cstdio>
+#include <iostream>
+
+/**
+ * @brief The number of buffered bytes after which results are written.
+ */
+static const std::size_t flushSize = 64 * 1024;
+
+/**
+ * @brief The words for the values of CopyOutcome in the result lines of atomic.
+ */
+static const char *const copyOutcomeNames[] = {"applied", "discarded", "notfound", "nocopies", "notborrowed", "stockexceeded"};
+
+BatchRunner::BatchRunner(Libary &libary, const std::string &databaseFile, std::ostream &out)
+    : libary(libary), databaseFile(databaseFile), out(&out)
+{
+    buffer.reserve(flushSize + 4096);
+}
+
+BatchRunner::BatchRunner(Libary &libary, const std::string &databaseFile, bool fileCommands)
+    : libary(libary), databaseFile(databaseFile), fileCommands(fileCommands)
+{
+}
+
+std::size_t BatchRunner::run(std::istream &in)
+{
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(in, line))
+    {
+        if (execute(line, ++lineNumber, buffer, options))
+        {
+            flushIfFull();
+        }
+    }
+    if (!libary.commitJournal())
+    {
+        ++failures;
+        std::cerr << "Das Journal konnte nicht geschrieben werden. Die Aenderungen sind erst nach dem Speichern sicher.\n";
+    }
+    out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out->flush();
+    buffer.clear();
+    return failures;
+}
+
+void BatchRunner::flushIfFull()
+{
+    if (buffer.size() >= flushSize)
+    {
+        out->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+bool BatchRunner::execute(std::string_view line, std::size_t lineNumber, std::string &output, ResultOptions &options)
+{
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.remove_suffix(1);
+    }
+    if (line.empty() || line.front() == '#')
+    {
+        return false;
+    }
+    runCommand(line, lineNumber, output, options);
+    return true;
+}
+
+void BatchRunner::fail(std::string &output, std::size_t lineNumber, const char *message)
+{
+    ++failures;
+    output += "ERR ";
+    output += std::to_string(lineNumber);
+    output += ' ';
+    output += message;
+    output += '\n';
+}
+
+void BatchRunner::writeTotals(std::string &output, const InventoryFigures &figures)
+{
+    // The value is exact in cents, so it is not converted to a floating point number
+    char line[128];
+    std::snprintf(line, sizeof(line), "TOTALS %lld %lld %lld %lld.%02lld\n", static_cast<long long>(figures.magazines),
+                  static_cast<long long>(figures.stock), static_cast<long long>(figures.borrowed),
+                  static_cast<long long>(figures.valueCents / 100), static_cast<long long>(figures.valueCents % 100));
+    output += line;
+}
+
+void BatchRunner::writeStats(std::string &output, const std::vector<OperationStats> &stats)
+{
+    char line[192];
+    std::snprintf(line, sizeof(line), "STATS %zu\n", stats.size());
+    output += line;
+    for (const OperationStats &operation : stats)
+    {
+        unsigned long long mean = operation.timed ? operation.totalNanoseconds / operation.timed : 0;
+        std::snprintf(line, sizeof(line), "%s\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\t%llu\n", operation.name,
+                      static_cast<unsigned long long>(operation.count), static_cast<unsigned long long>(operation.timed), mean,
+                      static_cast<unsigned long long>(operation.percentile(0.5)), static_cast<unsigned long long>(operation.percentile(0.9)),
+                      static_cast<unsigned long long>(operation.percentile(0.99)), static_cast<unsigned long long>(operation.maxNanoseconds));
+        output += line;
+    }
+}
+
+void BatchRunner::writeCopyResults(std::string &output, const std::vector<CopyChange> &changes, const std::vector<CopyResult> &results)
+{
+    bool applied = results.empty() || results.front().outcome == CopyOutcome::Applied;
+    if (!applied)
+    {
+        ++failures;
+    }
+    output += applied ? "APPLIED " : "REJECTED ";
+    output += std::to_string(results.size());
+    output += '\n';
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        output += changes[i].issn;
+        output += '\t';
+        output += copyOutcomeNames[static_cast<int>(results[i].outcome)];
+        output += '\t';
+        output += std::to_string(results[i].stock);
+        output += '\t';
+        output += std::to_string(results[i].borrowedCopies);
+        output += '\n';
+    }
+}
+
+void BatchRunner::writeMagazines(std::string &output, const std::vector<Magazine> &magazines, const ResultOptions &options)
+{
+    bool paged = options.offset > 0 || options.limit > 0;
+    std::size_t first = std::min(options.offset, magazines.size());
+    std::size_t count = options.limit == 0 ? magazines.size() - first : std::min(options.limit, magazines.size() - first);
+    output += "FOUND ";
+    output += std::to_string(count);
+    if (paged)
+    {
+        output += ' ';
+        output += std::to_string(magazines.size());
+    }
+    output += '\n';
+    formatter.appendPage(output, magazines, first, options.limit);
+}
+
+void BatchRunner::runCommand(std::string_view line, std::size_t lineNumber, std::string &output, ResultOptions &options)
+{
+    formatter.setFormat(options.format);
+    // Split into tab separated fields, reusing the strings of the previous command
+    std::size_t count = 0;
+    for (std::size_t begin = 0;; ++count)
+    {
+        std::size_t end = line.find('\t', begin);
+        if (count == fields.size())
+        {
+            fields.emplace_back();
+        }
+        fields[count].assign(line.substr(begin, end == std::string_view::npos ? std::string_view::npos : end - begin));
+        if (end == std::string_view::npos)
+        {
+            ++count;
+            break;
+        }
+        begin = end + 1;
+    }
+    const std::string &command = fields[0];
+
+    if (command == "add")
+    {
+        int stock;
+        double price;
+        std::uint32_t packedISSN;
+        ISSNStatus issnStatus = count == 8 ? Utils::parseISSN(fields[4], packedISSN) : ISSNStatus::Malformed;
+        if (count != 8)
+        {
+            fail(output, lineNumber, "add erwartet Autor, Titel, Verlag, ISSN, Anzahl, Datum und Preis");
+        }
+        else if (!Utils::containsValidChars(fields[1]) || !Utils::containsValidChars(fields[2]) || !Utils::containsValidChars(fields[3]))
+        {
+            fail(output, lineNumber, "Autor, Titel oder Verlag enthaelt ungueltige Zeichen");
+        }
+        else if (issnStatus == ISSNStatus::Malformed)
+        {
+            fail(output, lineNumber, "Ungueltige ISSN");
+        }
+        else if (issnStatus == ISSNStatus::WrongCheckDigit)
+        {
+            // Like in feeds, a typo in a new ISSN is caught here, only loaded catalogues keep wrong check characters
+            fail(output, lineNumber, "Pruefziffer der ISSN stimmt nicht");
+        }
+        else if (!Utils::parseNumber(fields[5], stock) || stock < 0 || stock > MagazineStore::maxCopies)
+        {
+            fail(output, lineNumber, "Ungueltige Anzahl im Lager");
+        }
+        else if (!Utils::isValidDate(fields[6]))
+        {
+            fail(output, lineNumber, "Ungueltiges Erscheinungsdatum");
+        }
+        else if (!Utils::parseNumber(fields[7], price) || price < 0.0)
+        {
+            fail(output, lineNumber, "Ungueltiger Preis");
+        }
+        else if (libary.addMagazine(Magazine(fields[1], fields[2], fields[3], fields[4], stock, fields[6], price)))
+        {
+            output += "OK\n";
+        }
+        else if (!libary.magazineExists(fields[4]))
+        {
+            fail(output, lineNumber, "Der Preis muss zwischen 0 und 40000000 Euro liegen");
+        }
+        else if (libary.increaseStock(fields[4], stock))
+        {
+            // Like the menu, adding an existing ISSN increases its stock
+            output += "OK ";
+            output += std::to_string(libary.searchByISSN(fields[4])->stock);
+            output += '\n';
+        }
+        else
+        {
+            fail(output, lineNumber, "Anzahl im Lager zu gross");
+        }
+    }
+    else if (command == "search" && count == 2)
+    {
+        writeMagazines(output, libary.searchByTitle(fields[1]), options);
+    }
+    else if (command == "published" && count == 3)
+    {
+        if (!Utils::isValidDate(fields[1]) || !Utils::isValidDate(fields[2]))
+        {
+            fail(output, lineNumber, "Ungueltiges Datum");
+        }
+        else
+        {
+            writeMagazines(output, libary.searchByDate(fields[1], fields[2]), options);
+        }
+    }
+    else if (command == "price" && count == 3)
+    {
+        double minimum, maximum;
+        if (!Utils::parseNumber(fields[1], minimum) || !Utils::parseNumber(fields[2], maximum))
+        {
+            fail(output, lineNumber, "Ungueltiger Preis");
+        }
+        else
+        {
+            writeMagazines(output, libary.searchByPrice(minimum, maximum), options);
+        }
+    }
+    else if (command == "mostborrowed" && count == 2)
+    {
+        std::size_t limit;
+        if (!Utils::parseNumber(fields[1], limit))
+        {
+            fail(output, lineNumber, "Ungueltige Anzahl");
+        }
+        else
+        {
+            writeMagazines(output, libary.mostBorrowed(limit), options);
+        }
+    }
+    else if (command == "lowstock" && (count == 2 || count == 3))
+    {
+        int maximum;
+        std::size_t limit = 0;
+        if (!Utils::parseNumber(fields[1], maximum) || maximum < 0 || (count == 3 && !Utils::parseNumber(fields[2], limit)))
+        {
+            fail(output, lineNumber, "Ungueltige Anzahl");
+        }
+        else
+        {
+            writeMagazines(output, libary.leastAvailable(maximum, limit), options);
+        }
+    }
+    else if (command == "issn" && count == 2)
+    {
+        std::optional<Magazine> magazine = libary.searchByISSN(fields[1]);
+        output += magazine ? "FOUND 1\n" : "FOUND 0\n";
+        if (magazine)
+        {
+            formatter.append(output, *magazine);
+        }
+    }
+    else if ((command == "borrow" || command == "return") && count == 2)
+    {
+        Magazine magazine("", "", "", fields[1], 0, "", 0.0);
+        bool borrowing = command == "borrow";
+        if (borrowing ? libary.borrowMagazine(magazine) : libary.returnMagazine(magazine))
+        {
+            output += "OK ";
+            output += std::to_string(magazine.borrowedCopies);
+            output += '\n';
+        }
+        else if (!libary.magazineExists(fields[1]))
+        {
+            fail(output, lineNumber, "Magazin nicht gefunden");
+        }
+        else
+        {
+            fail(output, lineNumber, borrowing ? "Keine Exemplare zum Ausleihen vorhanden" : "Keine ausgeliehenen Exemplare zum Zurueckgeben vorhanden");
+        }
+    }
+    else if (command == "stock" && count == 3)
+    {
+        int amount;
+        if (!Utils::parseNumber(fields[2], amount) || amount < -MagazineStore::maxCopies || amount > MagazineStore::maxCopies)
+        {
+            fail(output, lineNumber, "Ungueltige Anzahl");
+        }
+        else if (libary.increaseStock(fields[1], amount))
+        {
+            output += "OK ";
+            output += std::to_string(libary.searchByISSN(fields[1])->stock);
+            output += '\n';
+        }
+        else if (!libary.magazineExists(fields[1]))
+        {
+            fail(output, lineNumber, "Magazin nicht gefunden");
+        }
+        else
+        {
+            fail(output, lineNumber, "Anzahl im Lager ausserhalb des gueltigen Bereichs");
+        }
+    }
+    else if (command == "atomic")
+    {
+        // The fields after the command are actions, each followed by an ISSN and for stock by an amount
+        std::vector<CopyChange> changes;
+        std::size_t next = 1;
+        while (next + 1 < count)
+        {
+            CopyChange change;
+            change.issn = fields[next + 1];
+            if (fields[next] == "borrow")
+            {
+                change.action = CopyAction::Borrow;
+            }
+            else if (fields[next] == "return")
+            {
+                change.action = CopyAction::Return;
+            }
+            else if (fields[next] == "stock" && next + 2 < count && Utils::parseNumber(fields[next + 2], change.amount))
+            {
+                change.action = CopyAction::IncreaseStock;
+                ++next;
+            }
+            else
+            {
+                break;
+            }
+            changes.push_back(std::move(change));
+            next += 2;
+        }
+        if (changes.empty() || next != count)
+        {
+            fail(output, lineNumber, "atomic erwartet borrow ISSN, return ISSN oder stock ISSN Anzahl, beliebig oft");
+        }
+        else
+        {
+            writeCopyResults(output, changes, libary.changeCopies(changes));
+        }
+    }
+    else if (command == "totals" && count <= 2)
+    {
+        std::optional<InventoryFigures> figures = count == 2 ? libary.publisherTotals(fields[1]) : libary.inventoryTotals();
+        if (figures)
+        {
+            writeTotals(output, *figures);
+        }
+        else
+        {
+            fail(output, lineNumber, "Verlag nicht gefunden");
+        }
+    }
+    else if (command == "format" && count == 2)
+    {
+        ResultFormat format;
+        if (!ResultFormatter::parseFormat(fields[1], format) || format == ResultFormat::Text)
+        {
+            fail(output, lineNumber, "Unbekanntes Format, erlaubt sind tsv und json");
+        }
+        else
+        {
+            options.format = format;
+            output += "OK\n";
+        }
+    }
+    else if (command == "page" && count == 3)
+    {
+        std::size_t offset, limit;
+        if (!Utils::parseNumber(fields[1], offset) || !Utils::parseNumber(fields[2], limit))
+        {
+            fail(output, lineNumber, "Ungueltiger Bereich");
+        }
+        else
+        {
+            options.offset = offset;
+            options.limit = limit;
+            output += "OK\n";
+        }
+    }
+    else if (command == "stats" && count == 1)
+    {
+        if (Metrics::enabled())
+        {
+            writeStats(output, Metrics::collect());
+        }
+        else
+        {
+            fail(output, lineNumber, "Die Statistik ist nicht einkompiliert");
+        }
+    }
+    else if (command == "verify" && count == 1)
+    {
+        if (libary.verifyInventoryTotals())
+        {
+            output += "OK\n";
+        }
+        else
+        {
+            fail(output, lineNumber, "Die Bestandssummen weichen von der Neuberechnung ab");
+        }
+    }
+    else if (!fileCommands && ((command == "save" && count == 2) || command == "import"))
+    {
+        fail(output, lineNumber, "Befehl mit Dateinamen ist hier nicht erlaubt");
+    }
+    else if (command == "save" && count <= 2)
+    {
+        bool saved = count == 2 ? libary.view().saveToFile(fields[1], libary.getFileFormat()) : libary.compact(databaseFile);
+        if (saved)
+        {
+            output += "OK\n";
+        }
+        else
+        {
+            fail(output, lineNumber, "Die Datenbank konnte nicht gespeichert werden");
+        }
+    }
+    else if (command == "snapshot" && count == 1)
+    {
+        if (libary.compactInBackground(databaseFile))
+        {
+            output += "OK\n";
+        }
+        else
+        {
+            fail(output, lineNumber, "Die letzte Sicherung laeuft noch");
+        }
+    }
+    else if (command == "import" && (count == 2 || count == 3))
+    {
+        ImportSummary summary;
+        if (FeedImporter::import(libary, fields[1], count == 3 ? fields[2] : fields[1] + ".rejected.tsv", summary))
+        {
+            output += "OK ";
+            output += std::to_string(summary.added);
+            output += ' ';
+            output += std::to_string(summary.increased);
+            output += ' ';
+            output += std::to_string(summary.rejected);
+            output += '\n';
+        }
+        else
+        {
+            fail(output, lineNumber, "Der Feed konnte nicht gelesen oder der Bericht nicht geschrieben werden");
+        }
+    }
+    else
+    {
+        fail(output, lineNumber, "Unbekannter Befehl oder falsche Anzahl Felder");
+    }
+}
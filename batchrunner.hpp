@@ -0,0 +1,181 @@
+/**
+ * @file batchrunner.hpp
+ * @brief File containing the declaration of the BatchRunner class.
+ */
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "libary.hpp"
+#include "metrics.hpp"
+#include "resultformatter.hpp"
+
+#ifndef BATCHRUNNER_HPP
+#define BATCHRUNNER_HPP
+
+/**
+ * @struct ResultOptions
+ * @brief How the results of searches are rendered, set with the format and page commands.
+ *
+ * @details Kept apart from the BatchRunner, so that every client of a Server has its own.
+ */
+struct ResultOptions
+{
+    ResultFormat format = ResultFormat::Tsv;  ///< The format of the magazine lines, tsv or json.
+    std::size_t offset = 0;  ///< The number of hits skipped.
+    std::size_t limit = 0;  ///< The largest number of hits written, 0 for all.
+};
+
+/**
+ * @class BatchRunner
+ * @brief Runs a stream of commands against a Libary without any prompts.
+ *
+ * @details Every line of the input is one command whose fields are separated by tabs, so titles and names may
+ * contain blanks. Empty lines and lines starting with # are skipped. The commands are:
+ *
+ * - add Author Title Publisher ISSN Stock Date Price: adds a magazine, or increases the stock if the ISSN exists
+ * - search Title: searches by title
+ * - issn ISSN: searches by ISSN
+ * - published From To: searches for magazines published from one date to another, both in the format DD.MM.YYYY
+ * - price Minimum Maximum: searches for magazines whose price in Euro lies in a range
+ * - borrow ISSN / return ISSN: borrows or returns a copy
+ * - mostborrowed Count: the magazines with the most borrowed copies, at most Count of them, see Libary::mostBorrowed()
+ * - lowstock Maximum [Limit]: the magazines with at most Maximum copies available, fewest first, see Libary::leastAvailable()
+ * - stock ISSN Amount: changes the stock by a possibly negative amount
+ * - atomic Action ISSN [Amount] ...: borrows, returns and changes the stock of many magazines all at once or not at
+ *   all, see Libary::changeCopies(); every action is borrow ISSN, return ISSN or stock ISSN Amount
+ * - totals [Publisher]: the inventory totals of all magazines or of one publisher, see Libary::inventoryTotals()
+ * - verify: checks the inventory totals against a full recomputation, see Libary::verifyInventoryTotals()
+ * - stats: the calls and latencies of the library operations since the start, see Metrics
+ * - format tsv|json: writes the magazines of the following results as tab separated lines or as JSON objects
+ * - page Offset Limit: writes only the hits from Offset on and at most Limit of them, page 0 0 writes all again
+ * - save [File]: saves the library to a file, or compacts the database file and journal if no file is given
+ * - snapshot: starts compacting the database file and journal in the background, see Libary::compactInBackground()
+ * - import Feed [Report]: imports a CSV or TSV feed, see FeedImporter; rejected rows go to the report, by default
+ *   the feed name followed by .rejected.tsv
+ *
+ * Every command writes exactly one status line: OK, optionally followed by the number of borrowed copies or the new
+ * stock, or for import by the number of added, increased and rejected rows; TOTALS followed by the number
+ * of magazines, the copies in stock, the copies on loan and the value of the stock in Euro; STATS and the number of
+ * operations, followed by one tab separated line per operation (name, calls, timed calls, then the mean, median, 90th
+ * and 99th percentile and highest latency of the timed calls in nanoseconds); APPLIED or, if nothing was changed,
+ * REJECTED and the number of actions of atomic, followed by one tab separated line per action (ISSN, outcome, stock,
+ * borrowed copies), where the outcome is applied, discarded, notfound, nocopies, notborrowed or stockexceeded; FOUND and the number of hits, followed by one tab separated line per magazine (ISSN, title, author,
+ * publisher, date, price, stock, borrowed copies) or one JSON object per line, see ResultFormatter. While a page is
+ * set, FOUND is followed by the number of lines written and the number of all hits; or ERR, the line number and a description. Results are collected
+ * in a buffer and written in large blocks.
+ */
+class BatchRunner
+{
+private:
+    Libary &libary;  ///< The library the commands run against.
+    std::string databaseFile;  ///< The database file that save without a file name compacts.
+    std::ostream *out = nullptr;  ///< Receives the results of run().
+    bool fileCommands = true;  ///< Whether save with a file name and import are allowed.
+    std::string buffer;  ///< Results that have not been written to out yet.
+    std::vector<std::string> fields;  ///< The fields of the current command, reused for every line.
+    std::size_t failures = 0;  ///< The number of commands that failed.
+    ResultOptions options;  ///< The result options of the commands given to run().
+    ResultFormatter formatter;  ///< Renders the magazines of results, set to the format of the current command.
+
+    /**
+     * @brief Runs a single command.
+     *
+     * @param line The command line without line break.
+     * @param lineNumber The line number of the command, starting at 1.
+     * @param output Receives the result.
+     * @param options How results are rendered, changed by the format and page commands.
+     */
+    void runCommand(std::string_view line, std::size_t lineNumber, std::string &output, ResultOptions &options);
+
+    /**
+     * @brief Writes an error line for the current command.
+     *
+     * @param output Receives the error line.
+     * @param lineNumber The line number of the command.
+     * @param message The description of the problem.
+     */
+    void fail(std::string &output, std::size_t lineNumber, const char *message);
+
+    /**
+     * @brief Writes inventory totals as TOTALS line.
+     * @param output Receives the line.
+     * @param figures The totals to write.
+     */
+    void writeTotals(std::string &output, const InventoryFigures &figures);
+
+    /**
+     * @brief Writes the operation stats as STATS line followed by one line per operation.
+     * @param output Receives the lines.
+     * @param stats The stats to write, see Metrics::collect().
+     */
+    void writeStats(std::string &output, const std::vector<OperationStats> &stats);
+
+    /**
+     * @brief Writes the results of atomic as APPLIED or REJECTED line followed by one line per change.
+     * @param output Receives the lines.
+     * @param changes The changes, for their ISSNs.
+     * @param results The results of the changes, see Libary::changeCopies().
+     */
+    void writeCopyResults(std::string &output, const std::vector<CopyChange> &changes, const std::vector<CopyResult> &results);
+
+    /**
+     * @brief Writes the result of a search: FOUND, the number of hits and one line per magazine of the page.
+     * @param output Receives the lines.
+     * @param magazines The magazines found.
+     * @param options The format and the page to write.
+     */
+    void writeMagazines(std::string &output, const std::vector<Magazine> &magazines, const ResultOptions &options);
+
+    /**
+     * @brief Writes the buffered results to out once enough have been collected.
+     */
+    void flushIfFull();
+
+public:
+    /**
+     * @brief Creates a batch runner.
+     *
+     * @param libary The library the commands run against.
+     * @param databaseFile The database file that save without a file name compacts.
+     * @param out Receives the results.
+     */
+    BatchRunner(Libary &libary, const std::string &databaseFile, std::ostream &out);
+
+    /**
+     * @brief Creates a batch runner that only runs single commands with execute().
+     *
+     * @param libary The library the commands run against.
+     * @param databaseFile The database file that save without a file name compacts.
+     * @param fileCommands Whether save with a file name and import may read and write other files. Should be false
+     * when the commands come from the network.
+     */
+    BatchRunner(Libary &libary, const std::string &databaseFile, bool fileCommands);
+
+    /**
+     * @brief Runs a single command line and appends its result to a buffer.
+     *
+     * The journal is not committed, see Libary::commitJournal().
+     * @param line The command line, with or without a carriage return at the end.
+     * @param lineNumber The number reported in an error line.
+     * @param output Receives the result.
+     * @param options How results are rendered, kept by the caller from one command to the next.
+     * @return true if a command was run, false if the line is empty or a comment, which gives no result.
+     */
+    bool execute(std::string_view line, std::size_t lineNumber, std::string &output, ResultOptions &options);
+
+    /**
+     * @brief Runs all commands of a stream and writes the results to the stream given to the constructor.
+     *
+     * The journal is committed at the end. If that fails, a message goes to stderr and it counts as one more failure,
+     * since the changes reported as done are not on disk.
+     * @param in The commands, one per line.
+     * @return The number of commands that failed, plus one if the journal could not be committed.
+     */
+    std::size_t run(std::istream &in);
+};
+
+#endif // BATCHRUNNER_HPP
@@ -0,0 +1,160 @@
+/**
+ * @file allocations.cpp
+ * @brief Counts the heap allocations of adding and loading magazines.
+ *
+ * Build from the repository root with:
+ * g++ -std=c++17 -O2 -pthread benchmark/allocations.cpp $(ls *.cpp | grep -v main.cpp) -o libary_allocations
+ *
+ * Run with: libary_allocations [--size 100000] [--seed 1]
+ *
+ * The global operator new is replaced by one that counts every call, so the numbers include all allocations of the
+ * library and of the standard library on its behalf, on every thread. A synthetic catalogue (see CatalogueGenerator)
+ * is written as text and as binary file and loaded into a fresh library, and then added magazine by magazine through
+ * addMagazine() and mergeMagazines(). Every measurement is written to stdout as one line of JSON with the operation,
+ * the number of magazines, the allocations and allocated bytes in total and per magazine, and the time taken.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../libary.hpp"
+#include "catalogue.hpp"
+
+/**
+ * @brief The number of calls to operator new so far.
+ */
+static std::atomic<std::uint64_t> allocationCount{0};
+
+/**
+ * @brief The number of bytes requested from operator new so far.
+ */
+static std::atomic<std::uint64_t> allocatedBytes{0};
+
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+/**
+ * @class AllocationMeter
+ * @brief Counts the allocations and the time of one measurement.
+ */
+class AllocationMeter
+{
+private:
+    std::uint64_t count = allocationCount.load();  ///< The allocations when the measurement started.
+    std::uint64_t bytes = allocatedBytes.load();  ///< The allocated bytes when the measurement started.
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();  ///< When the measurement started.
+
+public:
+    /**
+     * @brief Writes the measurement as one line of JSON to stdout.
+     *
+     * @param operation The name of the measured operation.
+     * @param magazines The number of magazines the operation handled.
+     */
+    void report(const char *operation, std::size_t magazines) const
+    {
+        double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::uint64_t allocations = allocationCount.load() - count;
+        std::uint64_t allocated = allocatedBytes.load() - bytes;
+        std::printf("{\"operation\":\"%s\",\"magazines\":%zu,\"allocations\":%llu,\"allocations_per_magazine\":%.3f,"
+                    "\"bytes\":%llu,\"bytes_per_magazine\":%.1f,\"ms\":%.1f}\n",
+                    operation, magazines, static_cast<unsigned long long>(allocations), magazines ? static_cast<double>(allocations) / magazines : 0.0,
+                    static_cast<unsigned long long>(allocated), magazines ? static_cast<double>(allocated) / magazines : 0.0, milliseconds);
+        std::fflush(stdout);
+    }
+};
+
+int main(int argc, char *argv[])
+{
+    std::size_t size = 100000;
+    std::uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string argument = argv[i];
+        if (argument == "--size")
+        {
+            size = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (argument == "--seed")
+        {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    CatalogueGenerator generator(seed);
+    std::vector<Magazine> magazines;
+    magazines.reserve(size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        magazines.push_back(generator.magazine(i));
+    }
+
+    {
+        std::unique_ptr<Libary> libary(new Libary);
+        AllocationMeter meter;
+        for (const Magazine &magazine : magazines)
+        {
+            libary->addMagazine(magazine);
+        }
+        meter.report("addMagazine", size);
+        libary->saveToFile("libary_allocations.txt", FileFormat::Text);
+        libary->saveToFile("libary_allocations.bin", FileFormat::Binary);
+    }
+    {
+        std::unique_ptr<Libary> libary(new Libary);
+        AllocationMeter meter;
+        libary->mergeMagazines(magazines);
+        meter.report("mergeMagazines", size);
+    }
+    const char *files[] = {"libary_allocations.txt", "libary_allocations.bin"};
+    const char *names[] = {"loadFromFile.text", "loadFromFile.binary"};
+    for (int f = 0; f < 2; ++f)
+    {
+        // The library is created outside the measurement, so only the loading itself is counted
+        std::unique_ptr<Libary> libary(new Libary);
+        AllocationMeter meter;
+        libary->loadFromFile(files[f]);
+        meter.report(names[f], libary->size());
+        std::remove(files[f]);
+    }
+    return 0;
+}
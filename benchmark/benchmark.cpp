@@ -0,0 +1,480 @@
+/**
+ * @file benchmark.cpp
+ * @brief Micro benchmarks for the Libary class.
+ *
+ * Build from the repository root with:
+ * g++ -std=c++17 -O2 -pthread benchmark/benchmark.cpp $(ls *.cpp | grep -v main.cpp) -o libary_benchmark
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "../libary.hpp"
+#include "../feedimporter.hpp"
+#include "../shardedlibary.hpp"
+#include "../utils.hpp"
+
+/**
+ * @brief Builds a valid ISSN including its mod-11 check digit from a running number.
+ *
+ * @param number The running number, must be below 10000000.
+ * @return The ISSN in the format XXXX-XXXX.
+ */
+static std::string makeISSN(unsigned number)
+{
+    unsigned sum = 0;
+    unsigned rest = number;
+    for (unsigned weight = 2; weight <= 8; ++weight)
+    {
+        sum += (rest % 10) * weight;
+        rest /= 10;
+    }
+    unsigned check = (11 - sum % 11) % 11;
+    char buffer[16];
+    std::snprintf(buffer, sizeof(buffer), "%04u-%03u%c", number / 1000 % 10000, number % 1000, check == 10 ? 'X' : char('0' + check));
+    return buffer;
+}
+
+/**
+ * @brief Measures the average latency of ISSN lookups for growing catalogue sizes.
+ *
+ * Latency should stay flat as the catalogue grows, since lookups go through the ISSN index.
+ */
+static void benchmarkISSNLookup()
+{
+    const int lookups = 1000000;
+    std::printf("%-12s %-14s\n", "magazines", "ns/lookup");
+    for (unsigned size : {1000u, 10000u, 100000u, 1000000u})
+    {
+        Libary libary;
+        std::vector<std::string> issns;
+        for (unsigned i = 0; i < size; ++i)
+        {
+            issns.push_back(makeISSN(i));
+            libary.addMagazine(Magazine("Autor", "Titel", "Verlag", issns.back(), 1, "01.01.2024", 4.99));
+        }
+
+        unsigned found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; ++i)
+        {
+            found += libary.searchByISSN(issns[(i * 7919u) % size]).has_value();
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-12u %-14.1f%s\n", size, elapsed / lookups, found == lookups ? "" : " (lookup failed)");
+    }
+}
+
+/**
+ * @brief Builds a pronounceable title of two or three words from a running number.
+ *
+ * @param number The running number.
+ * @return The title.
+ */
+static std::string makeTitle(unsigned number)
+{
+    static const char *syllables[] = {"ka", "ri", "mo", "spie", "gel", "tech", "nik", "ver", "lag", "zeit",
+                                      "sport", "bild", "welt", "haus", "gar", "ten", "au", "to", "fo", "kunst",
+                                      "rei", "se", "wo", "che", "markt", "geld", "bo", "te", "na", "tur",
+                                      "kin", "der", "mu", "sik", "rad", "flug", "le", "ben", "stil", "kom",
+                                      "pu", "ter", "spiel", "film", "buch", "la", "den", "wirt", "schaft", "po",
+                                      "li", "tik", "wis", "sen", "ge", "sund", "heit", "koch", "mo", "de"};
+    std::uint64_t state = number * 0x9E3779B97F4A7C15ull + 1;
+    std::string title;
+    unsigned words = 2 + number % 2;
+    for (unsigned w = 0; w < words; ++w)
+    {
+        if (w > 0)
+        {
+            title += ' ';
+        }
+        for (int s = 0; s < 3; ++s)
+        {
+            state ^= state >> 29;
+            state *= 0xBF58476D1CE4E5B9ull;
+            title += syllables[(state >> 32) % 60];
+        }
+    }
+    return title;
+}
+
+/**
+ * @brief Measures the latency of typo tolerant title suggestions for growing catalogue sizes.
+ */
+static void benchmarkTitleSuggestions()
+{
+    const int queries = 200;
+    std::printf("%-12s %-14s\n", "magazines", "ms/suggestion");
+    for (unsigned size : {1000u, 100000u, 1000000u})
+    {
+        Libary libary;
+        for (unsigned i = 0; i < size; ++i)
+        {
+            libary.addMagazine(Magazine("Autor", makeTitle(i), "Verlag", makeISSN(i), 1, "01.01.2024", 4.99));
+        }
+
+        std::size_t suggestions = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < queries; ++i)
+        {
+            // Misspell a random title by dropping one character
+            std::string title = makeTitle((i * 7919u) % size);
+            title.erase(title.size() / 2, 1);
+            suggestions += libary.suggestByTitle(title).size();
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-12u %-14.3f%s\n", size, elapsed / queries, suggestions > 0 ? "" : " (nothing suggested)");
+    }
+}
+
+/**
+ * @brief Measures borrow and return throughput with a growing number of threads.
+ *
+ * Every thread borrows and returns copies of randomly chosen magazines. Borrowing and returning only take the
+ * reader lock, change a single atomic word and flag the magazine for the leaderboards without a lock, so throughput
+ * should grow nearly linearly with the number of cores as long as the threads rarely hit the same magazine. A second run lets all threads fight over one magazine with
+ * few copies while an observer checks that it is never lent out more often than it is in stock.
+ */
+static void benchmarkConcurrentBorrow()
+{
+    const unsigned size = 100000;
+    const int operations = 1000000;
+    Libary libary;
+    std::vector<std::string> issns;
+    for (unsigned i = 0; i < size; ++i)
+    {
+        issns.push_back(makeISSN(i));
+        libary.addMagazine(Magazine("Autor", "Titel", "Verlag", issns.back(), i == 0 ? 4 : 100, "01.01.2024", 4.99));
+    }
+
+    unsigned maxThreads = std::max(8u, std::thread::hardware_concurrency());
+    std::printf("%-12s %-16s %-10s\n", "threads", "ops/s", "speedup");
+    double singleThreaded = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        std::atomic<unsigned> failed(0);
+        auto worker = [&](unsigned seed)
+        {
+            std::uint64_t state = seed * 0x9E3779B97F4A7C15ull + 1;
+            Magazine magazine("", "", "", "", 0, "", 0.0);
+            for (int i = 0; i < operations / 2; ++i)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                magazine.issn = issns[1 + state % (size - 1)];
+                if (!libary.borrowMagazine(magazine) || !libary.returnMagazine(magazine))
+                {
+                    failed++;
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            pool.emplace_back(worker, t);
+        }
+        for (std::thread &thread : pool)
+        {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double throughput = threads * double(operations) / seconds;
+        if (threads == 1)
+        {
+            singleThreaded = throughput;
+        }
+        std::printf("%-12u %-16.0f %-10.2f%s\n", threads, throughput, throughput / singleThreaded, failed == 0 ? "" : " (operation failed)");
+    }
+
+    // All threads borrow the first magazine, which has only four copies
+    std::atomic<bool> running(true);
+    std::atomic<unsigned> overLent(0);
+    std::thread observer([&]
+                         {
+        while (running)
+        {
+            std::optional<Magazine> magazine = libary.searchByISSN(issns[0]);
+            if (magazine->borrowedCopies > magazine->stock)
+            {
+                overLent++;
+            }
+        } });
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < maxThreads; ++t)
+    {
+        pool.emplace_back([&]
+                          {
+            Magazine magazine("", "", "", issns[0], 0, "", 0.0);
+            for (int i = 0; i < operations / 10; ++i)
+            {
+                if (libary.borrowMagazine(magazine))
+                {
+                    libary.returnMagazine(magazine);
+                }
+            } });
+    }
+    for (std::thread &thread : pool)
+    {
+        thread.join();
+    }
+    running = false;
+    observer.join();
+    std::optional<Magazine> contended = libary.searchByISSN(issns[0]);
+    std::printf("contended magazine: %d of %d copies borrowed after the run, %s\n", contended->borrowedCopies, contended->stock,
+                overLent == 0 ? "never over-lent" : "OVER-LENT");
+}
+
+/**
+ * @brief Measures a mixed workload on one library and on a sharded one with a growing number of threads.
+ *
+ * Every thread borrows and returns copies of randomly chosen magazines, and now and then adds a magazine or searches
+ * by title. Adding takes the writer lock of the whole library, which stalls all other threads of a single library,
+ * but only those working on the same shard of a sharded one. Title searches run on all shards at once.
+ */
+static void benchmarkShardedMixedLoad()
+{
+    const unsigned size = 100000;
+    const int operations = 200000;
+    unsigned maxThreads = std::max(8u, std::thread::hardware_concurrency());
+    Libary single;
+    ShardedLibary sharded(std::max(4u, std::thread::hardware_concurrency()));
+    std::vector<std::string> issns;
+    std::vector<Magazine> magazines;
+    for (unsigned i = 0; i < size; ++i)
+    {
+        issns.push_back(makeISSN(i));
+        magazines.emplace_back("Autor", makeTitle(i), "Verlag", issns.back(), 100, "01.01.2024", 4.99);
+    }
+    single.mergeMagazines(magazines);
+    sharded.mergeMagazines(magazines);
+
+    // Runs the workload with a number of threads, each adding its own range of new magazines, about 4000 per run
+    auto run = [&](auto &libary, unsigned threads, unsigned round)
+    {
+        auto worker = [&](unsigned t)
+        {
+            std::uint64_t state = (round * 64 + t) * 0x9E3779B97F4A7C15ull + 1;
+            Magazine magazine("", "", "", "", 0, "", 0.0);
+            unsigned added = 0;
+            for (int i = 0; i < operations; ++i)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                unsigned kind = static_cast<unsigned>(state % 100);
+                if (kind < 2)
+                {
+                    libary.addMagazine(Magazine("Autor", "Neu", "Verlag", makeISSN(size + (round * maxThreads + t) * 5000 + added++), 1, "01.01.2024", 4.99));
+                }
+                else if (kind < 3)
+                {
+                    libary.searchByTitle(makeTitle(static_cast<unsigned>(state >> 32) % size));
+                }
+                else
+                {
+                    magazine.issn = issns[(state >> 8) % size];
+                    libary.borrowMagazine(magazine);
+                    libary.returnMagazine(magazine);
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            pool.emplace_back(worker, t);
+        }
+        for (std::thread &thread : pool)
+        {
+            thread.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return threads * double(operations) / seconds;
+    };
+
+    std::printf("%-12s %-16s %-16s %-10s\n", "threads", "single ops/s", "sharded ops/s", "speedup");
+    double singleBase = 0;
+    double shardedBase = 0;
+    unsigned round = 0;
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2, ++round)
+    {
+        double singleThroughput = run(single, threads, round);
+        double shardedThroughput = run(sharded, threads, round);
+        if (threads == 1)
+        {
+            singleBase = singleThroughput;
+            shardedBase = shardedThroughput;
+        }
+        std::printf("%-12u %-16.0f %-16.0f %.2f / %.2f\n", threads, singleThroughput, shardedThroughput,
+                    singleThroughput / singleBase, shardedThroughput / shardedBase);
+    }
+}
+
+/**
+ * @brief Measures how long reports on a view take while other threads borrow, return and add magazines.
+ *
+ * A view holds no lock while it is read, so the report latency should not depend on the number of writers.
+ */
+static void benchmarkViewUnderLoad()
+{
+    const unsigned size = 1000000;
+    const int reports = 20;
+    Libary libary;
+    std::vector<std::string> issns;
+    for (unsigned i = 0; i < size; ++i)
+    {
+        issns.push_back(makeISSN(i));
+        libary.addMagazine(Magazine("Autor", makeTitle(i), i % 100 == 0 ? "Kleinverlag" : "Verlag", issns.back(), 10, "01.01.2024", 4.99));
+    }
+
+    std::printf("%-12s %-16s %-16s\n", "writers", "us/view", "ms/report");
+    for (unsigned writers : {0u, 1u, 2u, 4u})
+    {
+        std::atomic<bool> running(true);
+        std::vector<std::thread> pool;
+        for (unsigned t = 0; t < writers; ++t)
+        {
+            pool.emplace_back([&, t]
+                              {
+                std::uint64_t state = t * 0x9E3779B97F4A7C15ull + 1;
+                Magazine magazine("", "", "", "", 0, "", 0.0);
+                unsigned added = 0;
+                while (running)
+                {
+                    state ^= state << 13;
+                    state ^= state >> 7;
+                    state ^= state << 17;
+                    magazine.issn = issns[state % size];
+                    libary.borrowMagazine(magazine);
+                    libary.returnMagazine(magazine);
+                    // Every writer also adds a magazine now and then
+                    if (state % 64 == 0 && added < 100000)
+                    {
+                        libary.addMagazine(Magazine("Autor", "Neu", "Verlag", makeISSN(size + t * 100000 + added++), 1, "01.01.2024", 4.99));
+                    }
+                } });
+        }
+
+        double viewTime = 0;
+        double reportTime = 0;
+        for (int i = 0; i < reports; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            LibaryView view = libary.view();
+            auto created = std::chrono::steady_clock::now();
+            view.searchByPublisher("Kleinverlag");
+            auto finished = std::chrono::steady_clock::now();
+            viewTime += std::chrono::duration<double, std::micro>(created - start).count();
+            reportTime += std::chrono::duration<double, std::milli>(finished - created).count();
+        }
+        running = false;
+        for (std::thread &thread : pool)
+        {
+            thread.join();
+        }
+        std::printf("%-12u %-16.1f %-16.2f\n", writers, viewTime / reports, reportTime / reports);
+    }
+}
+
+/**
+ * @brief Measures importing publisher feeds of growing size into an empty library.
+ *
+ * Every tenth row repeats an earlier ISSN and increases its stock, and every hundredth row is invalid, so all three
+ * outcomes of an import are part of the measurement.
+ */
+static void benchmarkFeedImport()
+{
+    const char *feedFile = "benchmark_feed.tsv";
+    const char *reportFile = "benchmark_feed.rejected.tsv";
+    std::printf("%-12s %-12s %-14s %-12s\n", "rows", "ms", "rows/s", "rejected");
+    for (unsigned rows : {10000u, 100000u, 1000000u})
+    {
+        {
+            std::ofstream feed(feedFile);
+            feed << "Autor\tTitel\tVerlag\tISSN\tAnzahl\tDatum\tPreis\n";
+            for (unsigned i = 0; i < rows; ++i)
+            {
+                unsigned number = i % 10 == 9 ? i / 2 : i;
+                feed << "Autor " << number % 5000 << '\t' << makeTitle(number) << "\tVerlag " << number % 300 << '\t'
+                     << (i % 100 == 42 ? "1234-567" : makeISSN(number)) << "\t3\t01.01.2024\t4,99\n";
+            }
+        }
+        Libary libary;
+        ImportSummary summary;
+        auto start = std::chrono::steady_clock::now();
+        bool imported = FeedImporter::import(libary, feedFile, reportFile, summary);
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-12u %-12.0f %-14.0f %-12zu%s\n", rows, elapsed, rows / elapsed * 1000, summary.rejected, imported ? "" : " (import failed)");
+    }
+    std::remove(feedFile);
+    std::remove(reportFile);
+}
+
+/**
+ * @brief Measures the field validators of Utils on typical catalogue fields, one by one and as batch.
+ */
+static void benchmarkValidators()
+{
+    const unsigned count = 1000000;
+    std::vector<std::string> titles, dates, issns;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        titles.push_back(makeTitle(i) + " Sonderausgabe " + std::to_string(i));
+        char date[16];
+        std::snprintf(date, sizeof(date), "%02u.%02u.%04u", 1 + i % 28, 1 + i % 12, 1950 + i % 75);
+        dates.push_back(date);
+        issns.push_back(makeISSN(i));
+    }
+    std::vector<std::string_view> views;
+    for (unsigned i = 0; i < count; ++i)
+    {
+        views.insert(views.end(), {titles[i], dates[i], issns[i]});
+    }
+    std::vector<char> valid(count);
+    std::vector<std::int32_t> days(count);
+    std::vector<std::uint32_t> packed(count);
+    std::vector<ISSNStatus> status(count);
+
+    auto measure = [&](const char *name, auto &&check)
+    {
+        auto start = std::chrono::steady_clock::now();
+        std::size_t passed = check();
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-24s %-12.1f%s\n", name, elapsed / count, passed == count ? "" : " (check failed)");
+    };
+    std::printf("%-24s %-12s\n", "validator", "ns/field");
+    measure("containsValidChars", [&]()
+            { std::size_t n = 0; for (const std::string &title : titles) n += Utils::containsValidChars(title); return n; });
+    measure("validateChars", [&]()
+            { return Utils::validateChars(views.data(), count, 3, reinterpret_cast<bool *>(valid.data())); });
+    measure("isValidDate", [&]()
+            { std::size_t n = 0; for (const std::string &date : dates) n += Utils::isValidDate(date); return n; });
+    measure("validateDates", [&]()
+            { return Utils::validateDates(views.data() + 1, count, 3, days.data(), reinterpret_cast<bool *>(valid.data())); });
+    measure("isValidISSN", [&]()
+            { std::size_t n = 0; for (const std::string &issn : issns) n += Utils::isValidISSN(issn); return n; });
+    measure("validateISSNs", [&]()
+            { return Utils::validateISSNs(views.data() + 2, count, 3, packed.data(), status.data()); });
+}
+
+int main()
+{
+    benchmarkISSNLookup();
+    benchmarkTitleSuggestions();
+    benchmarkConcurrentBorrow();
+    benchmarkShardedMixedLoad();
+    benchmarkViewUnderLoad();
+    benchmarkFeedImport();
+    benchmarkValidators();
+    return 0;
+}
@@ -0,0 +1,231 @@
+/**
+ * @file catalogue.hpp
+ * @brief A deterministic generator for realistic synthetic catalogues.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../magazine.hpp"
+#include "../utils.hpp"
+
+#ifndef CATALOGUE_HPP
+#define CATALOGUE_HPP
+
+/**
+ * @class ZipfDistribution
+ * @brief Draws ranks 0 to n-1, where rank k is drawn with a probability proportional to 1 / (k + 1)^s.
+ */
+class ZipfDistribution
+{
+private:
+    std::vector<double> cumulative;  ///< The probability of drawing a rank up to and including each rank.
+
+public:
+    /**
+     * @brief Prepares the distribution.
+     *
+     * @param n The number of ranks.
+     * @param s The exponent, 1 gives the classic Zipf distribution of word frequencies.
+     */
+    ZipfDistribution(std::size_t n, double s = 1.0) : cumulative(n)
+    {
+        double sum = 0;
+        for (std::size_t k = 0; k < n; ++k)
+        {
+            sum += 1.0 / std::pow(static_cast<double>(k + 1), s);
+            cumulative[k] = sum;
+        }
+        for (double &value : cumulative)
+        {
+            value /= sum;
+        }
+    }
+
+    /**
+     * @brief Turns a uniformly distributed number into a rank.
+     * @param uniform A number in [0, 1).
+     * @return The rank.
+     */
+    std::size_t operator()(double uniform) const
+    {
+        std::size_t rank = std::upper_bound(cumulative.begin(), cumulative.end(), uniform) - cumulative.begin();
+        return std::min(rank, cumulative.size() - 1);
+    }
+};
+
+/**
+ * @class CatalogueGenerator
+ * @brief Generates the same synthetic catalogue on every run and every machine.
+ *
+ * @details Title words, authors and publishers are drawn from fixed vocabularies with Zipf distributed frequencies,
+ * so a few words and publishers are very common and most are rare, as in a real catalogue. Every magazine is a pure
+ * function of its index, so magazines can be generated in any order, and a benchmark can recreate any magazine of the
+ * catalogue to look it up. ISSNs are unique for up to 10 million magazines and carry the right check character,
+ * dates lie between 1950 and 2025.
+ */
+class CatalogueGenerator
+{
+private:
+    std::uint64_t seed;  ///< Distinguishes catalogues that should differ.
+    std::vector<std::string> words;  ///< The vocabulary of titles, most frequent first.
+    std::vector<std::string> authors;  ///< The authors, most frequent first.
+    std::vector<std::string> publishers;  ///< The publishers, most frequent first.
+    ZipfDistribution wordRanks;  ///< Draws title words.
+    ZipfDistribution authorRanks;  ///< Draws authors.
+    ZipfDistribution publisherRanks;  ///< Draws publishers.
+
+    /**
+     * @brief Mixes a number into a well distributed 64 bit value (splitmix64).
+     */
+    static std::uint64_t mix(std::uint64_t value)
+    {
+        value += 0x9E3779B97F4A7C15ull;
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+    /**
+     * @brief Turns a random value into a number in [0, 1).
+     */
+    static double uniform(std::uint64_t value)
+    {
+        return static_cast<double>(value >> 11) / 9007199254740992.0;
+    }
+
+    /**
+     * @brief Builds a pronounceable word from a number.
+     *
+     * @param number The number of the word.
+     * @param syllableCount The number of syllables.
+     * @return The word, capitalized.
+     */
+    static std::string makeWord(std::uint64_t number, int syllableCount)
+    {
+        static const char *syllables[] = {"ka", "ri", "mo", "spie", "gel", "tech", "nik", "ver", "lag", "zeit",
+                                          "sport", "bild", "welt", "haus", "gar", "ten", "au", "to", "fo", "kunst",
+                                          "rei", "se", "wo", "che", "markt", "geld", "bo", "te", "na", "tur",
+                                          "kin", "der", "mu", "sik", "rad", "flug", "le", "ben", "stil", "kom",
+                                          "pu", "ter", "spiel", "film", "buch", "la", "den", "wirt", "schaft", "po",
+                                          "li", "tik", "wis", "sen", "ge", "sund", "heit", "koch", "mo", "de"};
+        std::string word;
+        std::uint64_t state = number;
+        for (int s = 0; s < syllableCount; ++s)
+        {
+            state = mix(state);
+            word += syllables[state % 60];
+        }
+        word[0] = static_cast<char>(word[0] - 'a' + 'A');
+        return word;
+    }
+
+public:
+    /**
+     * @brief Prepares the vocabularies.
+     * @param seed Distinguishes catalogues that should differ. The same seed always gives the same catalogue.
+     */
+    explicit CatalogueGenerator(std::uint64_t seed = 1)
+        : seed(seed), wordRanks(20000), authorRanks(50000), publisherRanks(1000)
+    {
+        for (std::uint64_t i = 0; i < 20000; ++i)
+        {
+            // Frequent words are short, as in natural language
+            words.push_back(makeWord(seed * 1000003 + i, i < 100 ? 1 + static_cast<int>(i % 2) : 2 + static_cast<int>(i % 3)));
+        }
+        for (std::uint64_t i = 0; i < 50000; ++i)
+        {
+            authors.push_back(makeWord(seed * 2000003 + i, 2) + " " + makeWord(seed * 3000017 + i, 3));
+        }
+        for (std::uint64_t i = 0; i < 1000; ++i)
+        {
+            publishers.push_back(makeWord(seed * 4000037 + i, 2) + " Verlag");
+        }
+    }
+
+    /**
+     * @brief Returns the ISSN of a magazine without generating the rest of it.
+     *
+     * @param index The index of the magazine, below 10000000.
+     * @return The ISSN in the format XXXX-XXXX.
+     */
+    std::string issn(std::uint64_t index) const
+    {
+        // Multiplying by a number coprime to 10^7 permutes the seven digit numbers
+        std::uint64_t number = (index * 3456789 + seed * 7919) % 10000000;
+        unsigned sum = 0;
+        std::uint64_t rest = number;
+        for (unsigned weight = 2; weight <= 8; ++weight)
+        {
+            sum += static_cast<unsigned>(rest % 10) * weight;
+            rest /= 10;
+        }
+        unsigned check = (11 - sum % 11) % 11;
+        char buffer[16];
+        std::snprintf(buffer, sizeof(buffer), "%04u-%03u%c", static_cast<unsigned>(number / 1000), static_cast<unsigned>(number % 1000),
+                      check == 10 ? 'X' : static_cast<char>('0' + check));
+        return buffer;
+    }
+
+    /**
+     * @brief Returns the title of a magazine without generating the rest of it.
+     *
+     * @param index The index of the magazine.
+     * @return Two to four title words.
+     */
+    std::string title(std::uint64_t index) const
+    {
+        std::uint64_t state = mix(seed ^ mix(index));
+        std::string text;
+        int count = 2 + static_cast<int>(state % 3);
+        for (int w = 0; w < count; ++w)
+        {
+            state = mix(state);
+            if (w > 0)
+            {
+                text += ' ';
+            }
+            text += words[wordRanks(uniform(state))];
+        }
+        return text;
+    }
+
+    /**
+     * @brief Generates a magazine of the catalogue.
+     *
+     * @param index The index of the magazine, below 10000000.
+     * @return The magazine, with nothing borrowed.
+     */
+    Magazine magazine(std::uint64_t index) const
+    {
+        std::uint64_t state = mix(mix(seed ^ mix(index)) + 1);
+        std::string author = authors[authorRanks(uniform(state))];
+        state = mix(state);
+        std::string publisher = publishers[publisherRanks(uniform(state))];
+        state = mix(state);
+        // 01.01.1950 to 31.12.2025
+        std::string date = Utils::daysToDate(static_cast<std::int32_t>(-7305 + static_cast<std::int64_t>(state % 27759)));
+        state = mix(state);
+        int stock = 1 + static_cast<int>(state % 20);
+        state = mix(state);
+        double price = static_cast<double>(100 + state % 1900) / 100.0;
+        return Magazine(author, title(index), publisher, issn(index), stock, date, price);
+    }
+
+    /**
+     * @brief Returns a well distributed random number for a benchmark, the same for the same step.
+     *
+     * @param step The number of the step.
+     * @return The random number.
+     */
+    std::uint64_t random(std::uint64_t step) const
+    {
+        return mix(mix(seed + 0x5851F42D4C957F2Dull) ^ step);
+    }
+};
+
+#endif // CATALOGUE_HPP
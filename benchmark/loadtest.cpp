@@ -0,0 +1,407 @@
+/**
+ * @file loadtest.cpp
+ * @brief Load test client for the server mode of the application.
+ *
+ * Build from the repository root with:
+ * g++ -std=c++17 -O2 benchmark/loadtest.cpp utils.cpp -o libary_loadtest
+ *
+ * Run with: libary_loadtest [--host 127.0.0.1] [--port 7070] [--connections 1000] [--depth 4] [--seconds 10]
+ *                           [--populate 0] [--catalogue 10000] [--seed 1]
+ *
+ * Start the server first, for example with "app --serve 7070". With --populate N the first N magazines of the
+ * synthetic catalogue (see CatalogueGenerator) are added through a single connection before the test; otherwise the
+ * first --catalogue magazines are expected to be there already. The test then opens the given number of connections
+ * and keeps --depth requests in flight on each of them for the given number of seconds. 80 percent of the requests
+ * look up an ISSN, 1 percent search for a title, and the rest borrow a copy and return it right away.
+ *
+ * The result is written to stdout as one line of JSON with the number of connections, the number of completed
+ * requests, the throughput, the 50th, 99th and 99.9th percentile and the maximum of the latency from sending a
+ * request to receiving its complete result, and the number of requests that were answered with ERR. Progress goes to
+ * stderr. The client needs epoll and only runs on Linux.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "catalogue.hpp"
+
+/**
+ * @struct Client
+ * @brief The state of one connection of the load test.
+ */
+struct Client
+{
+    int fd = -1;  ///< The socket.
+    std::string output;  ///< Requests that have not been sent yet, from position sent on.
+    std::size_t sent = 0;  ///< The number of bytes of output that were sent.
+    std::string input;  ///< Received bytes that do not form a complete result yet.
+    std::deque<std::chrono::steady_clock::time_point> inFlight;  ///< The time every unanswered request was queued.
+    std::size_t rows = 0;  ///< The number of result rows still expected for the oldest request.
+    std::uint64_t step = 0;  ///< The number of requests made, picks the next request.
+};
+
+/**
+ * @brief Opens a blocking connection to the server.
+ *
+ * @param host The IPv4 address of the server.
+ * @param port The port of the server.
+ * @return The socket, -1 if the connection failed.
+ */
+static int connectTo(const std::string &host, std::uint16_t port)
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1)
+    {
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+/**
+ * @brief Adds the first magazines of the catalogue through one connection.
+ *
+ * @param generator The catalogue generator.
+ * @param count The number of magazines.
+ * @param host The IPv4 address of the server.
+ * @param port The port of the server.
+ * @return true if every magazine was added, false otherwise.
+ */
+static bool populate(const CatalogueGenerator &generator, std::size_t count, const std::string &host, std::uint16_t port)
+{
+    const std::size_t block = 4096;
+    int fd = connectTo(host, port);
+    if (fd < 0)
+    {
+        return false;
+    }
+    bool success = true;
+    std::string requests;
+    std::string results;
+    char chunk[65536];
+    for (std::size_t first = 0; first < count && success; first += block)
+    {
+        std::size_t last = std::min(count, first + block);
+        requests.clear();
+        for (std::size_t i = first; i < last; ++i)
+        {
+            Magazine magazine = generator.magazine(i);
+            char numbers[64];
+            std::snprintf(numbers, sizeof(numbers), "\t%d\t", magazine.stock);
+            requests += "add\t" + magazine.author + "\t" + magazine.title + "\t" + magazine.publisher + "\t" + magazine.issn +
+                        numbers + magazine.publicationDate;
+            std::snprintf(numbers, sizeof(numbers), "\t%.2f\n", magazine.price);
+            requests += numbers;
+        }
+        // The results of a block are small enough to wait in the socket buffers until all of its requests are sent
+        for (std::size_t position = 0; position < requests.size();)
+        {
+            ssize_t written = send(fd, requests.data() + position, requests.size() - position, MSG_NOSIGNAL);
+            if (written <= 0)
+            {
+                close(fd);
+                return false;
+            }
+            position += static_cast<std::size_t>(written);
+        }
+        std::size_t lines = 0;
+        while (lines < last - first)
+        {
+            ssize_t received = recv(fd, chunk, sizeof(chunk), 0);
+            if (received <= 0)
+            {
+                close(fd);
+                return false;
+            }
+            results.append(chunk, static_cast<std::size_t>(received));
+            std::size_t begin = 0;
+            for (std::size_t end; (end = results.find('\n', begin)) != std::string::npos; begin = end + 1)
+            {
+                success = success && results.compare(begin, 2, "OK") == 0;
+                ++lines;
+            }
+            results.erase(0, begin);
+        }
+        std::fprintf(stderr, "%zu of %zu magazines added\n", last, count);
+    }
+    close(fd);
+    return success;
+}
+
+/**
+ * @brief Queues the next request of a connection.
+ *
+ * @param generator The catalogue generator.
+ * @param catalogue The number of magazines in the library.
+ * @param client The connection.
+ */
+static void queueRequest(const CatalogueGenerator &generator, std::size_t catalogue, Client &client)
+{
+    std::uint64_t random = generator.random(client.step++ ^ (static_cast<std::uint64_t>(client.fd) << 40));
+    std::size_t index = static_cast<std::size_t>(random % catalogue);
+    unsigned kind = static_cast<unsigned>((random >> 48) % 100);
+    auto now = std::chrono::steady_clock::now();
+    if (kind < 80)
+    {
+        client.output += "issn\t" + generator.issn(index) + "\n";
+    }
+    else if (kind < 81)
+    {
+        client.output += "search\t" + generator.title(index) + "\n";
+    }
+    else
+    {
+        std::string issn = generator.issn(index);
+        client.output += "borrow\t" + issn + "\nreturn\t" + issn + "\n";
+        client.inFlight.push_back(now);
+    }
+    client.inFlight.push_back(now);
+}
+
+/**
+ * @brief Sends as many queued requests as the socket takes without blocking.
+ * @param client The connection.
+ * @return false if the connection broke, true otherwise.
+ */
+static bool sendRequests(Client &client)
+{
+    while (client.sent < client.output.size())
+    {
+        ssize_t written = send(client.fd, client.output.data() + client.sent, client.output.size() - client.sent, MSG_NOSIGNAL);
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        if (written <= 0)
+        {
+            return false;
+        }
+        client.sent += static_cast<std::size_t>(written);
+    }
+    if (client.sent == client.output.size())
+    {
+        client.output.clear();
+        client.sent = 0;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string host = "127.0.0.1";
+    unsigned long port = 7070;
+    std::size_t connections = 1000;
+    std::size_t depth = 4;
+    double seconds = 10;
+    std::size_t populateCount = 0;
+    std::size_t catalogue = 10000;
+    std::uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string argument = argv[i];
+        if (argument == "--host")
+        {
+            host = argv[i + 1];
+        }
+        else if (argument == "--port")
+        {
+            port = std::strtoul(argv[i + 1], nullptr, 10);
+        }
+        else if (argument == "--connections")
+        {
+            connections = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (argument == "--depth")
+        {
+            depth = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (argument == "--seconds")
+        {
+            seconds = std::strtod(argv[i + 1], nullptr);
+        }
+        else if (argument == "--populate")
+        {
+            populateCount = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (argument == "--catalogue")
+        {
+            catalogue = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (argument == "--seed")
+        {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+    if (populateCount > 0)
+    {
+        catalogue = populateCount;
+    }
+    if (port == 0 || port > 65535 || connections == 0 || depth == 0 || catalogue == 0 || catalogue > 10000000)
+    {
+        std::fprintf(stderr, "Invalid options, see the description in loadtest.cpp\n");
+        return 1;
+    }
+
+    // Every connection needs a file descriptor
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    CatalogueGenerator generator(seed);
+    if (populateCount > 0 && !populate(generator, populateCount, host, static_cast<std::uint16_t>(port)))
+    {
+        std::fprintf(stderr, "The catalogue could not be added\n");
+        return 1;
+    }
+
+    int poller = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<Client> clients(connections);
+    for (std::size_t c = 0; c < connections; ++c)
+    {
+        Client &client = clients[c];
+        client.fd = connectTo(host, static_cast<std::uint16_t>(port));
+        if (client.fd < 0)
+        {
+            std::fprintf(stderr, "Connection %zu of %zu failed: %s\n", c + 1, connections, std::strerror(errno));
+            return 1;
+        }
+        fcntl(client.fd, F_SETFL, fcntl(client.fd, F_GETFL) | O_NONBLOCK);
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+        event.data.ptr = &client;
+        epoll_ctl(poller, EPOLL_CTL_ADD, client.fd, &event);
+    }
+    std::fprintf(stderr, "%zu connections open, running for %.0f seconds\n", connections, seconds);
+
+    std::vector<std::uint64_t> latencies;
+    std::size_t errors = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+    for (Client &client : clients)
+    {
+        while (client.inFlight.size() < depth)
+        {
+            queueRequest(generator, catalogue, client);
+        }
+        sendRequests(client);
+    }
+
+    std::vector<epoll_event> events(1024);
+    char chunk[65536];
+    std::size_t open = connections;
+    while (open > 0)
+    {
+        bool running = std::chrono::steady_clock::now() < deadline;
+        int count = epoll_wait(poller, events.data(), static_cast<int>(events.size()), 100);
+        for (int i = 0; i < count; ++i)
+        {
+            Client &client = *static_cast<Client *>(events[i].data.ptr);
+            if (client.fd < 0)
+            {
+                continue;
+            }
+            bool broken = false;
+            while (!broken)
+            {
+                ssize_t received = recv(client.fd, chunk, sizeof(chunk), 0);
+                if (received > 0)
+                {
+                    client.input.append(chunk, static_cast<std::size_t>(received));
+                    continue;
+                }
+                broken = received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                break;
+            }
+            auto now = std::chrono::steady_clock::now();
+            std::size_t begin = 0;
+            for (std::size_t end; (end = client.input.find('\n', begin)) != std::string::npos; begin = end + 1)
+            {
+                if (client.rows > 0)
+                {
+                    --client.rows;
+                }
+                else if (client.input.compare(begin, 6, "FOUND ") == 0)
+                {
+                    client.rows = std::strtoull(client.input.c_str() + begin + 6, nullptr, 10);
+                }
+                else
+                {
+                    errors += client.input.compare(begin, 3, "ERR") == 0;
+                }
+                if (client.rows == 0 && !client.inFlight.empty())
+                {
+                    latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - client.inFlight.front()).count());
+                    client.inFlight.pop_front();
+                }
+            }
+            client.input.erase(0, begin);
+            while (running && client.inFlight.size() < depth)
+            {
+                queueRequest(generator, catalogue, client);
+            }
+            if (broken || !sendRequests(client) || (!running && client.inFlight.empty()))
+            {
+                if (broken || !client.inFlight.empty())
+                {
+                    std::fprintf(stderr, "A connection was closed by the server\n");
+                    errors += client.inFlight.size();
+                }
+                close(client.fd);
+                client.fd = -1;
+                --open;
+            }
+        }
+        if (count == 0 && !running && std::chrono::steady_clock::now() > deadline + std::chrono::seconds(10))
+        {
+            std::fprintf(stderr, "%zu connections did not receive all results in time\n", open);
+            break;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    close(poller);
+
+    std::sort(latencies.begin(), latencies.end());
+    std::size_t completed = latencies.size();
+    auto percentile = [&](std::size_t perMille)
+    {
+        return completed ? latencies[std::min(completed - 1, completed * perMille / 1000)] / 1000.0 : 0.0;
+    };
+    std::printf("{\"connections\":%zu,\"depth\":%zu,\"requests\":%zu,\"ops_per_s\":%.1f,\"p50_us\":%.1f,\"p99_us\":%.1f,"
+                "\"p999_us\":%.1f,\"max_us\":%.1f,\"errors\":%zu}\n",
+                connections, depth, completed, completed / elapsed, percentile(500), percentile(990), percentile(999),
+                completed ? latencies.back() / 1000.0 : 0.0, errors);
+    return 0;
+}
@@ -0,0 +1,256 @@
+/**
+ * @file suite.cpp
+ * @brief Benchmark suite for the Libary class with machine readable results.
+ *
+ * Build from the repository root with:
+ * g++ -std=c++17 -O2 -pthread benchmark/suite.cpp $(ls *.cpp | grep -v main.cpp) -o libary_suite
+ *
+ * Run with: libary_suite [--sizes 1000,10000,100000,1000000,10000000] [--seed 1]
+ *
+ * For every catalogue size, a synthetic catalogue (see CatalogueGenerator) is added to an empty library, and the
+ * library is then searched, borrowed from, saved and loaded. Every measurement is written to stdout as one line of
+ * JSON with the operation, the catalogue size, the number of operations, the throughput, the 50th and 99th percentile
+ * of the latency and the peak resident memory of the process so far. The same seed gives the same catalogue and the
+ * same operations, so the output of two releases can be compared line by line. Progress goes to stderr.
+ *
+ * Every operation is timed on its own, which adds the cost of reading the clock twice, some 20 to 50 ns, to both the
+ * latencies and the throughput.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "../libary.hpp"
+#include "catalogue.hpp"
+
+/**
+ * @brief Returns the peak resident memory of the process so far.
+ * @return The peak in KiB, 0 if the platform does not tell.
+ */
+static long peakResidentKiB()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // macOS reports bytes
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @class Timings
+ * @brief Collects the latencies of the operations of one measurement.
+ */
+class Timings
+{
+private:
+    std::vector<std::uint64_t> latencies;  ///< The latency of every operation in nanoseconds.
+    std::uint64_t total = 0;  ///< The sum of all latencies in nanoseconds.
+
+public:
+    /**
+     * @brief Times a single operation.
+     * @param operation The operation to run.
+     */
+    template <typename Operation>
+    void time(Operation &&operation)
+    {
+        auto start = std::chrono::steady_clock::now();
+        operation();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        latencies.push_back(static_cast<std::uint64_t>(elapsed));
+        total += static_cast<std::uint64_t>(elapsed);
+    }
+
+    /**
+     * @brief Writes the measurement as one line of JSON to stdout.
+     *
+     * @param operation The name of the measured operation.
+     * @param magazines The size of the catalogue.
+     * @param failures The number of operations that did not give the expected result, which makes the measurement suspect.
+     */
+    void report(const char *operation, std::size_t magazines, std::size_t failures = 0)
+    {
+        std::sort(latencies.begin(), latencies.end());
+        std::size_t count = latencies.size();
+        std::uint64_t p50 = count ? latencies[count / 2] : 0;
+        std::uint64_t p99 = count ? latencies[std::min(count - 1, count * 99 / 100)] : 0;
+        double seconds = total / 1e9;
+        std::printf("{\"operation\":\"%s\",\"magazines\":%zu,\"operations\":%zu,\"ops_per_s\":%.1f,\"p50_ns\":%llu,\"p99_ns\":%llu,"
+                    "\"peak_rss_kib\":%ld,\"failures\":%zu}\n",
+                    operation, magazines, count, seconds > 0 ? count / seconds : 0.0, static_cast<unsigned long long>(p50),
+                    static_cast<unsigned long long>(p99), peakResidentKiB(), failures);
+        std::fflush(stdout);
+        latencies.clear();
+        total = 0;
+    }
+};
+
+/**
+ * @brief Runs all measurements for one catalogue size.
+ *
+ * @param generator The catalogue generator.
+ * @param size The number of magazines.
+ */
+static void runSuite(const CatalogueGenerator &generator, std::size_t size)
+{
+    const std::size_t lookups = 100000;
+    const std::size_t titleSearches = 2000;
+    const std::size_t fileRuns = 3;
+    const std::size_t block = 65536;
+    Timings timings;
+    std::size_t failures = 0;
+    std::unique_ptr<Libary> libary(new Libary);
+
+    // The magazines are generated in blocks outside the timed operations
+    std::fprintf(stderr, "%zu magazines: addMagazine\n", size);
+    std::vector<Magazine> magazines;
+    for (std::size_t first = 0; first < size; first += block)
+    {
+        magazines.clear();
+        for (std::size_t i = first; i < std::min(size, first + block); ++i)
+        {
+            magazines.push_back(generator.magazine(i));
+        }
+        for (const Magazine &magazine : magazines)
+        {
+            timings.time([&]
+                         { failures += !libary->addMagazine(magazine); });
+        }
+    }
+    magazines = std::vector<Magazine>();
+    timings.report("addMagazine", size, failures);
+
+    std::fprintf(stderr, "%zu magazines: searchByISSN\n", size);
+    std::vector<std::string> issns;
+    for (std::size_t i = 0; i < lookups; ++i)
+    {
+        issns.push_back(generator.issn(generator.random(i) % size));
+    }
+    failures = 0;
+    for (const std::string &issn : issns)
+    {
+        timings.time([&]
+                     { failures += !libary->searchByISSN(issn).has_value(); });
+    }
+    timings.report("searchByISSN", size, failures);
+
+    std::fprintf(stderr, "%zu magazines: searchByTitle\n", size);
+    std::vector<std::string> titles;
+    for (std::size_t i = 0; i < titleSearches; ++i)
+    {
+        titles.push_back(generator.title(generator.random(lookups + i) % size));
+    }
+    failures = 0;
+    for (const std::string &title : titles)
+    {
+        timings.time([&]
+                     { failures += libary->searchByTitle(title).empty(); });
+    }
+    timings.report("searchByTitle", size, failures);
+
+    std::fprintf(stderr, "%zu magazines: borrowMagazine, returnMagazine\n", size);
+    std::vector<Magazine> loans;
+    for (const std::string &issn : issns)
+    {
+        loans.emplace_back("", "", "", issn, 0, "", 0.0);
+    }
+    // Every copy is returned right after it was borrowed, so popular magazines never run out of copies
+    Timings returns;
+    failures = 0;
+    std::size_t returnFailures = 0;
+    for (Magazine &loan : loans)
+    {
+        timings.time([&]
+                     { failures += !libary->borrowMagazine(loan); });
+        returns.time([&]
+                     { returnFailures += !libary->returnMagazine(loan); });
+    }
+    timings.report("borrowMagazine", size, failures);
+    returns.report("returnMagazine", size, returnFailures);
+
+    const char *files[] = {"libary_suite.txt", "libary_suite.bin"};
+    const FileFormat formats[] = {FileFormat::Text, FileFormat::Binary};
+    const char *saveNames[] = {"saveToFile.text", "saveToFile.binary"};
+    const char *loadNames[] = {"loadFromFile.text", "loadFromFile.binary"};
+    for (int f = 0; f < 2; ++f)
+    {
+        std::fprintf(stderr, "%zu magazines: %s\n", size, saveNames[f]);
+        for (std::size_t run = 0; run < fileRuns; ++run)
+        {
+            timings.time([&]
+                         { libary->saveToFile(files[f], formats[f]); });
+        }
+        timings.report(saveNames[f], size);
+    }
+    libary.reset();
+    for (int f = 0; f < 2; ++f)
+    {
+        std::fprintf(stderr, "%zu magazines: %s\n", size, loadNames[f]);
+        failures = 0;
+        for (std::size_t run = 0; run < fileRuns; ++run)
+        {
+            // The library is created and destroyed outside the timed operation
+            std::unique_ptr<Libary> loaded(new Libary);
+            timings.time([&]
+                         { failures += !loaded->loadFromFile(files[f]) || loaded->size() != size; });
+        }
+        timings.report(loadNames[f], size, failures);
+        std::remove(files[f]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::size_t> sizes{1000, 10000, 100000, 1000000};
+    std::uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        std::string argument = argv[i];
+        if (argument == "--sizes")
+        {
+            sizes.clear();
+            std::string list = argv[i + 1];
+            for (std::size_t begin = 0; begin <= list.size();)
+            {
+                std::size_t end = std::min(list.find(',', begin), list.size());
+                sizes.push_back(std::strtoull(list.substr(begin, end - begin).c_str(), nullptr, 10));
+                begin = end + 1;
+            }
+        }
+        else if (argument == "--seed")
+        {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+
+    CatalogueGenerator generator(seed);
+    for (std::size_t size : sizes)
+    {
+        if (size == 0 || size > 10000000)
+        {
+            std::fprintf(stderr, "Catalogue sizes must be between 1 and 10000000, %zu is skipped\n", size);
+            continue;
+        }
+        runSuite(generator, size);
+    }
+    return 0;
+}
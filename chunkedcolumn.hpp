@@ -0,0 +1,140 @@
+/**
+ * @file chunkedcolumn.hpp
+ * @brief File containing the ChunkedColumn class template.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#ifndef CHUNKEDCOLUMN_HPP
+#define CHUNKEDCOLUMN_HPP
+
+/**
+ * @class ChunkedColumn
+ * @brief An append-only column of fixed width values, stored in chunks that never move.
+ *
+ * @details Unlike std::vector, growing the column never copies the values already stored. A new chunk is added
+ * whenever the last one is full, so a value stays at the same address for the lifetime of its chunk. Chunks are
+ * reference counted, which lets frozenCopy() hand out a copy of the column that shares all chunks: the copy keeps
+ * reading the values it was made with, while the original keeps appending behind them, even on other threads.
+ *
+ * @tparam T The type of the values, which must be trivially copyable.
+ */
+template <typename T>
+class ChunkedColumn
+{
+public:
+    static const std::uint32_t chunkBits = 12;  ///< The number of values per chunk as a power of two.
+    static const std::uint32_t chunkSize = 1u << chunkBits;  ///< The number of values per chunk.
+
+private:
+    std::vector<std::shared_ptr<T[]>> chunks;  ///< The chunks, all of them full except the last one.
+    std::uint32_t count = 0;  ///< The number of values.
+
+public:
+    ChunkedColumn() = default;
+    ChunkedColumn(const ChunkedColumn &) = delete;
+    ChunkedColumn &operator=(const ChunkedColumn &) = delete;
+    ChunkedColumn(ChunkedColumn &&) = default;
+    ChunkedColumn &operator=(ChunkedColumn &&) = default;
+
+    /**
+     * @brief Returns a copy of the column that shares its chunks.
+     *
+     * The copy must only be read. Values appended to the original afterwards are not part of the copy.
+     * @return The copy.
+     */
+    ChunkedColumn frozenCopy() const
+    {
+        ChunkedColumn copy;
+        copy.chunks = chunks;
+        copy.count = count;
+        return copy;
+    }
+
+    std::uint32_t size() const { return count; }  ///< @brief Returns the number of values.
+    const T &operator[](std::uint32_t index) const { return chunks[index >> chunkBits][index & (chunkSize - 1)]; }  ///< @brief Returns a value.
+    T &operator[](std::uint32_t index) { return chunks[index >> chunkBits][index & (chunkSize - 1)]; }  ///< @brief Returns a value.
+    std::uint32_t chunkCount() const { return static_cast<std::uint32_t>(chunks.size()); }  ///< @brief Returns the number of chunks.
+    const T *chunk(std::uint32_t index) const { return chunks[index].get(); }  ///< @brief Returns the values of a chunk.
+
+    /**
+     * @brief Returns the number of values in a chunk.
+     * @param index The index of the chunk.
+     * @return chunkSize for all chunks but the last one.
+     */
+    std::uint32_t chunkLength(std::uint32_t index) const
+    {
+        return index + 1 < chunks.size() ? chunkSize : count - (index << chunkBits);
+    }
+
+    /**
+     * @brief Reserves room for the chunk pointers of a number of values.
+     * @param values The expected number of values.
+     */
+    void reserve(std::size_t values)
+    {
+        chunks.reserve((values + chunkSize - 1) >> chunkBits);
+    }
+
+    /**
+     * @brief Appends a value.
+     * @param value The value to append.
+     */
+    void push_back(const T &value)
+    {
+        if ((count & (chunkSize - 1)) == 0)
+        {
+            chunks.emplace_back(new T[chunkSize]);
+        }
+        chunks.back()[count & (chunkSize - 1)] = value;
+        ++count;
+    }
+
+    /**
+     * @brief Appends many values at once.
+     *
+     * @param values The values, which may be unaligned.
+     * @param length The number of values.
+     */
+    void append(const void *values, std::size_t length)
+    {
+        const char *source = static_cast<const char *>(values);
+        while (length > 0)
+        {
+            if ((count & (chunkSize - 1)) == 0)
+            {
+                chunks.emplace_back(new T[chunkSize]);
+            }
+            std::uint32_t offset = count & (chunkSize - 1);
+            std::size_t part = length < chunkSize - offset ? length : chunkSize - offset;
+            std::memcpy(chunks.back().get() + offset, source, part * sizeof(T));
+            source += part * sizeof(T);
+            count += static_cast<std::uint32_t>(part);
+            length -= part;
+        }
+    }
+
+    /**
+     * @brief Returns the memory used by the column.
+     * @return The size of all chunks and chunk pointers in bytes.
+     */
+    std::size_t memoryUsage() const
+    {
+        return chunks.size() * chunkSize * sizeof(T) + chunks.capacity() * sizeof(std::shared_ptr<T[]>);
+    }
+
+    /**
+     * @brief Removes all values. Chunks still shared with a frozen copy are freed together with the copy.
+     */
+    void clear()
+    {
+        chunks.clear();
+        count = 0;
+    }
+};
+
+#endif // CHUNKEDCOLUMN_HPP
@@ -0,0 +1,115 @@
+/**
+ * @file copycolumn.cpp
+ * @brief File containing the implementation of the CopyColumn class.
+ */
+
+#include "copycolumn.hpp"
+#include <thread>
+
+CopyColumn::CopyColumn(CopyColumn &&other) noexcept
+    : slots(std::move(other.slots)), count(other.count), retired(std::move(other.retired))
+{
+    other.count = 0;
+}
+
+CopyColumn &CopyColumn::operator=(CopyColumn &&other) noexcept
+{
+    slots = std::move(other.slots);
+    count = other.count;
+    retired = std::move(other.retired);
+    other.count = 0;
+    return *this;
+}
+
+CounterPage *CopyColumn::thaw(std::uint32_t index)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Slot &slot = slots[index];
+    CounterPage *page = slot.page.load(std::memory_order_relaxed);
+    // Another writer may have copied the page while this one was waiting
+    if (!page->frozen)
+    {
+        return page;
+    }
+    std::shared_ptr<CounterPage> copy = std::make_shared<CounterPage>(*page);
+    copy->frozen = false;
+    retired.push_back(std::move(slot.owner));
+    slot.owner = copy;
+    slot.page.store(copy.get(), std::memory_order_release);
+    return copy.get();
+}
+
+void CopyColumn::reserve(std::size_t counters)
+{
+    slots.reserve((counters + CounterPage::pageSize - 1) >> CounterPage::pageBits);
+}
+
+void CopyColumn::push_back(std::uint32_t value)
+{
+    retired.clear();
+    std::uint32_t offset = count & (CounterPage::pageSize - 1);
+    if (offset == 0)
+    {
+        slots.emplace_back(std::make_shared<CounterPage>());
+    }
+    CounterPage *page = slots.back().page.load(std::memory_order_relaxed);
+    // A frozen copy may share the last page, so it is copied before a counter is added behind its counters
+    if (page->frozen)
+    {
+        page = thaw(static_cast<std::uint32_t>(slots.size() - 1));
+    }
+    page->counters[offset].word.store(value, std::memory_order_release);
+    ++count;
+}
+
+void CopyColumn::waitForFreeze()
+{
+    do
+    {
+        writers.fetch_sub(1, std::memory_order_seq_cst);
+        while (freezing.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+        writers.fetch_add(1, std::memory_order_seq_cst);
+    } while (freezing.load(std::memory_order_seq_cst));
+}
+
+CopyColumn CopyColumn::freeze()
+{
+    std::lock_guard<std::mutex> lock(freezeMutex);
+    CopyColumn copy;
+    copy.slots.reserve(slots.size());
+    // A writer counts itself before it looks at the flag and freeze() sets the flag before it looks at the count, so
+    // every writer either waits or is waited for
+    freezing.store(true, std::memory_order_seq_cst);
+    while (writers.load(std::memory_order_seq_cst) != 0)
+    {
+        std::this_thread::yield();
+    }
+    for (Slot &slot : slots)
+    {
+        slot.owner->frozen = true;
+        copy.slots.emplace_back(slot.owner);
+    }
+    copy.count = count;
+    freezing.store(false, std::memory_order_release);
+    return copy;
+}
+
+void CopyColumn::releaseRetired()
+{
+    retired.clear();
+}
+
+std::size_t CopyColumn::memoryUsage() const
+{
+    return slots.size() * sizeof(CounterPage) + slots.capacity() * sizeof(Slot);
+}
+
+void CopyColumn::clear()
+{
+    slots.clear();
+    retired.clear();
+    count = 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file copycolumn.hpp
+ * @brief File containing the declaration of the CopyColumn class.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef COPYCOLUMN_HPP
+#define COPYCOLUMN_HPP
+
+/**
+ * @struct CopyCounter
+ * @brief The stock and the borrowed copies of a magazine, combined into a single atomic word.
+ *
+ * @details The stock is kept in the upper and the borrowed copies in the lower 16 bits, so both can be checked
+ * and changed together with a single compare-and-swap. The copy operations are only meant for copying whole pages
+ * and must not run while other threads change the counter.
+ */
+struct CopyCounter
+{
+    std::atomic<std::uint32_t> word;  ///< The stock shifted left by 16 bits plus the borrowed copies.
+
+    explicit CopyCounter(std::uint32_t value = 0) : word(value) {}
+    CopyCounter(const CopyCounter &other) : word(other.word.load(std::memory_order_relaxed)) {}
+    CopyCounter &operator=(const CopyCounter &other)
+    {
+        word.store(other.word.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    static std::uint32_t pack(int stock, int borrowedCopies) { return static_cast<std::uint32_t>(stock) << 16 | static_cast<std::uint32_t>(borrowedCopies); }  ///< @brief Combines stock and borrowed copies into a word.
+    static int stock(std::uint32_t value) { return static_cast<int>(value >> 16); }  ///< @brief Extracts the stock from a word.
+    static int borrowed(std::uint32_t value) { return static_cast<int>(value & 0xFFFF); }  ///< @brief Extracts the borrowed copies from a word.
+};
+
+/**
+ * @struct CounterPage
+ * @brief A fixed number of consecutive CopyCounters.
+ */
+struct CounterPage
+{
+    static const std::uint32_t pageBits = 12;  ///< The number of counters per page as a power of two.
+    static const std::uint32_t pageSize = 1u << pageBits;  ///< The number of counters per page.
+
+    CopyCounter counters[pageSize];  ///< The counters.
+    bool frozen = false;  ///< Whether a frozen copy of the column refers to this page. A frozen page never changes again.
+};
+
+/**
+ * @class CopyColumn
+ * @brief The column with the stock and borrowed copies of all magazines, with copy-on-write pages.
+ *
+ * @details Counters are changed in place by any number of threads with compare-and-swap. To let a reader see all
+ * counters as they were at one instant without stopping those threads, freeze() marks every page as frozen and hands
+ * out a copy of the column that shares the pages. The next change to a frozen page first copies the page and then
+ * continues on the copy, so each page is copied at most once per frozen copy, and only if it changes at all.
+ *
+ * Changing counters, reading them and freeze() may happen concurrently. Every change goes through a Writer, and
+ * freeze() keeps new writers waiting until the ones it found are gone before it marks the pages, so no change lands
+ * in a page after it was frozen. The wait only lasts for the compare-and-swaps already under way. push_back(),
+ * releaseRetired() and clear() need exclusive access to the column. A page that was replaced by its copy is kept
+ * until one of them, because a concurrent reader may still be looking at it.
+ */
+class CopyColumn
+{
+private:
+    /**
+     * @struct Slot
+     * @brief The current version of a page.
+     */
+    struct Slot
+    {
+        std::atomic<CounterPage *> page;  ///< The page that is read and changed, for access without the mutex.
+        std::shared_ptr<CounterPage> owner;  ///< Keeps the page alive. Only changed with the mutex or exclusive access.
+
+        explicit Slot(std::shared_ptr<CounterPage> page) : page(page.get()), owner(std::move(page)) {}
+        Slot(Slot &&other) noexcept : page(other.page.load(std::memory_order_relaxed)), owner(std::move(other.owner)) {}
+    };
+
+    std::vector<Slot> slots;  ///< The pages, all of them full except the last one.
+    std::uint32_t count = 0;  ///< The number of counters.
+    std::vector<std::shared_ptr<CounterPage>> retired;  ///< Pages replaced by their copy since the last exclusive access.
+    std::mutex mutex;  ///< Serializes copying frozen pages.
+    std::mutex freezeMutex;  ///< Serializes freeze().
+    std::atomic<std::uint32_t> writers{0};  ///< The number of Writers of the column.
+    std::atomic<bool> freezing{false};  ///< Whether freeze() is waiting for the writers, which keeps new ones out.
+
+    /**
+     * @brief Replaces a frozen page by a copy that may be changed.
+     *
+     * @param index The index of the page.
+     * @return The page to change.
+     */
+    CounterPage *thaw(std::uint32_t index);
+
+    /**
+     * @brief Counts a new writer, after waiting for a running freeze() to finish.
+     */
+    void enter()
+    {
+        writers.fetch_add(1, std::memory_order_seq_cst);
+        if (freezing.load(std::memory_order_seq_cst))
+        {
+            waitForFreeze();
+        }
+    }
+
+    /**
+     * @brief Takes a counted writer out again until freeze() is done, and counts it once more.
+     */
+    void waitForFreeze();
+
+public:
+    /**
+     * @class Writer
+     * @brief Gives access to a counter for changing it with compare-and-swap.
+     *
+     * freeze() waits until every Writer that exists when it starts is gone, so a Writer should only live for one change.
+     */
+    class Writer
+    {
+    private:
+        std::atomic<std::uint32_t> &writers;  ///< The writer count of the column.
+        std::atomic<std::uint32_t> &counter;  ///< The counter to change.
+
+    public:
+        Writer(std::atomic<std::uint32_t> &writers, std::atomic<std::uint32_t> &counter) : writers(writers), counter(counter) {}
+        Writer(const Writer &) = delete;
+        Writer &operator=(const Writer &) = delete;
+        ~Writer() { writers.fetch_sub(1, std::memory_order_release); }
+
+        std::atomic<std::uint32_t> &word() const { return counter; }  ///< @brief Returns the atomic word of the counter.
+    };
+
+    CopyColumn() = default;
+    CopyColumn(const CopyColumn &) = delete;
+    CopyColumn &operator=(const CopyColumn &) = delete;
+    CopyColumn(CopyColumn &&other) noexcept;
+    CopyColumn &operator=(CopyColumn &&other) noexcept;
+
+    std::uint32_t size() const { return count; }  ///< @brief Returns the number of counters.
+
+    /**
+     * @brief Reads a counter.
+     * @param index The index of the counter.
+     * @return The packed stock and borrowed copies, see CopyCounter.
+     */
+    std::uint32_t load(std::uint32_t index) const
+    {
+        const CounterPage *page = slots[index >> CounterPage::pageBits].page.load(std::memory_order_acquire);
+        return page->counters[index & (CounterPage::pageSize - 1)].word.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Returns a counter for changing it with compare-and-swap.
+     *
+     * The counter stays the one to change while the Writer exists, since freeze() waits for it.
+     * @param index The index of the counter.
+     * @return The Writer of the counter.
+     */
+    Writer writable(std::uint32_t index)
+    {
+        enter();
+        CounterPage *page = slots[index >> CounterPage::pageBits].page.load(std::memory_order_acquire);
+        if (page->frozen)
+        {
+            try
+            {
+                page = thaw(index >> CounterPage::pageBits);
+            }
+            catch (...)
+            {
+                writers.fetch_sub(1, std::memory_order_release);
+                throw;
+            }
+        }
+        return Writer(writers, page->counters[index & (CounterPage::pageSize - 1)].word);
+    }
+
+    /**
+     * @brief Reserves room for the pages of a number of counters.
+     * @param counters The expected number of counters.
+     */
+    void reserve(std::size_t counters);
+
+    /**
+     * @brief Appends a counter. Needs exclusive access.
+     * @param value The packed stock and borrowed copies, see CopyCounter.
+     */
+    void push_back(std::uint32_t value);
+
+    /**
+     * @brief Returns a copy of the column that keeps the current counters while the original goes on changing.
+     *
+     * Takes time proportional to the number of pages, not counters. May run while counters are read and changed,
+     * but not alongside push_back(), releaseRetired() or clear().
+     * @return The copy. It must only be read.
+     */
+    CopyColumn freeze();
+
+    /**
+     * @brief Frees the pages that were replaced by their copy. Needs exclusive access.
+     */
+    void releaseRetired();
+
+    /**
+     * @brief Returns the memory used by the column.
+     * @return The size of all current pages in bytes.
+     */
+    std::size_t memoryUsage() const;
+
+    /**
+     * @brief Removes all counters. Needs exclusive access.
+     */
+    void clear();
+};
+
+#endif // COPYCOLUMN_HPP
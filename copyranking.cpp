@@ -0,0 +1,143 @@
+/**
+ * @file copyranking.cpp
+ * @brief File containing the implementation of the CopyRanking class.
+ */
+
+#include "copyranking.hpp"
+#include <algorithm>
+
+void CopyRanking::Order::append(int count)
+{
+    std::uint32_t row = static_cast<std::uint32_t>(counts.size());
+    if (buckets.size() <= static_cast<std::size_t>(count))
+    {
+        buckets.resize(count + 1);
+    }
+    positions.push_back(static_cast<std::uint32_t>(buckets[count].size()));
+    buckets[count].push_back(row);
+    counts.push_back(static_cast<std::uint16_t>(count));
+}
+
+void CopyRanking::Order::move(std::uint32_t row, int count)
+{
+    int previous = counts[row];
+    if (previous == count)
+    {
+        return;
+    }
+    // The last row of the old bucket takes the place of the moved one
+    std::vector<std::uint32_t> &from = buckets[previous];
+    std::uint32_t last = from.back();
+    from[positions[row]] = last;
+    positions[last] = positions[row];
+    from.pop_back();
+
+    if (buckets.size() <= static_cast<std::size_t>(count))
+    {
+        buckets.resize(count + 1);
+    }
+    positions[row] = static_cast<std::uint32_t>(buckets[count].size());
+    buckets[count].push_back(row);
+    counts[row] = static_cast<std::uint16_t>(count);
+}
+
+void CopyRanking::Order::clear()
+{
+    buckets.clear();
+    counts.clear();
+    positions.clear();
+}
+
+void CopyRanking::add(int stock, int borrowedCopies)
+{
+    borrowed.append(borrowedCopies);
+    available.append(availableCopies(stock, borrowedCopies));
+    links.emplace_back();
+}
+
+void CopyRanking::markChanged(std::uint32_t row)
+{
+    // Orders the change of the copies before reading the flag, against the fence in reconcile()
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    Link &link = links[row];
+    if (link.changed.load(std::memory_order_relaxed) || link.changed.exchange(true, std::memory_order_relaxed))
+    {
+        return;
+    }
+    std::uint32_t head = changedRows.load(std::memory_order_relaxed);
+    do
+    {
+        link.next.store(head, std::memory_order_relaxed);
+    } while (!changedRows.compare_exchange_weak(head, row, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void CopyRanking::reconcile(const MagazineStore &store)
+{
+    std::uint32_t row = changedRows.exchange(endOfList, std::memory_order_acquire);
+    while (row != endOfList)
+    {
+        // The next row is read before the flag is cleared, since a new change may push the row again right after
+        Link &link = links[row];
+        std::uint32_t next = link.next.load(std::memory_order_relaxed);
+        link.changed.store(false, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int stock, borrowedCopies;
+        store.copiesOf(row, stock, borrowedCopies);
+        borrowed.move(row, borrowedCopies);
+        available.move(row, availableCopies(stock, borrowedCopies));
+        row = next;
+    }
+}
+
+void CopyRanking::rebuild(const MagazineStore &store)
+{
+    clear();
+    for (std::uint32_t row = 0; row < store.size(); ++row)
+    {
+        int stock, borrowedCopies;
+        store.copiesOf(row, stock, borrowedCopies);
+        add(stock, borrowedCopies);
+    }
+}
+
+std::vector<std::uint32_t> CopyRanking::mostBorrowed(const MagazineStore &store, std::size_t limit)
+{
+    std::vector<std::uint32_t> rows;
+    std::lock_guard<std::mutex> lock(mutex);
+    reconcile(store);
+    for (std::size_t count = borrowed.buckets.size(); count-- > 1 && rows.size() < limit;)
+    {
+        // Only the rows taken are sorted, so a bucket that does not fit completely is not sorted as a whole
+        const std::vector<std::uint32_t> &bucket = borrowed.buckets[count];
+        std::size_t first = rows.size();
+        rows.insert(rows.end(), bucket.begin(), bucket.begin() + std::min(bucket.size(), limit - rows.size()));
+        std::sort(rows.begin() + first, rows.end());
+    }
+    return rows;
+}
+
+std::vector<std::uint32_t> CopyRanking::leastAvailable(const MagazineStore &store, int maximum, std::size_t limit)
+{
+    std::vector<std::uint32_t> rows;
+    std::lock_guard<std::mutex> lock(mutex);
+    reconcile(store);
+    // No row has more than maxCopies available, and clamping first keeps the bucket count from overflowing
+    int highest = maximum > MagazineStore::maxCopies ? MagazineStore::maxCopies : std::max(maximum, -1);
+    std::size_t last = std::min(available.buckets.size(), static_cast<std::size_t>(highest + 1));
+    for (std::size_t count = 0; count < last && (limit == 0 || rows.size() < limit); ++count)
+    {
+        const std::vector<std::uint32_t> &bucket = available.buckets[count];
+        std::size_t first = rows.size();
+        rows.insert(rows.end(), bucket.begin(), bucket.begin() + (limit == 0 ? bucket.size() : std::min(bucket.size(), limit - rows.size())));
+        std::sort(rows.begin() + first, rows.end());
+    }
+    return rows;
+}
+
+void CopyRanking::clear()
+{
+    borrowed.clear();
+    available.clear();
+    links.clear();
+    changedRows.store(endOfList, std::memory_order_relaxed);
+}
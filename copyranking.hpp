@@ -0,0 +1,151 @@
+/**
+ * @file copyranking.hpp
+ * @brief File containing the declaration of the CopyRanking class.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "magazinestore.hpp"
+
+#ifndef COPYRANKING_HPP
+#define COPYRANKING_HPP
+
+/**
+ * @class CopyRanking
+ * @brief Keeps all rows ordered by their borrowed copies and by their available copies, for leaderboards.
+ *
+ * @details Every row sits in one bucket per order, the bucket of its current count. Counts are at most
+ * MagazineStore::maxCopies, so the buckets are a plain array indexed by the count, and moving a row to another
+ * bucket after a change costs O(1) no matter by how much the count changed. The K rows with the most borrowed
+ * copies are found by walking the buckets from the highest count down, and the rows with few available copies by
+ * walking up from zero, so a query costs O(K log K) for sorting the rows it returns plus one step per count it
+ * passes, independent of the size of the catalogue.
+ *
+ * The copies of a row are changed with a compare-and-swap by many threads at once while the library is only locked
+ * shared, and those threads must not wait for each other. markChanged() therefore only flags the row and, if it was
+ * not flagged yet, pushes it onto a lock-free list. The queries take the ranking's mutex, move every listed row to
+ * the buckets of the copies it has now, and only then walk the buckets. A row is unflagged before its copies are
+ * read, so a change that the query misses flags it again. Queries thus pay for the rows changed since the last
+ * query, and borrowing costs one fence and, for the first change of a row, one compare-and-swap. add(), rebuild()
+ * and clear() need exclusive access to the store.
+ */
+class CopyRanking
+{
+private:
+    /**
+     * @struct Order
+     * @brief The rows in buckets by one count.
+     */
+    struct Order
+    {
+        std::vector<std::vector<std::uint32_t>> buckets;  ///< The rows of every count, in no particular order.
+        std::vector<std::uint16_t> counts;  ///< The count of every row.
+        std::vector<std::uint32_t> positions;  ///< The position of every row in its bucket.
+
+        /**
+         * @brief Adds the row after the last one.
+         * @param count The count of the row.
+         */
+        void append(int count);
+
+        /**
+         * @brief Moves a row to the bucket of a new count.
+         * @param row The row.
+         * @param count The new count of the row.
+         */
+        void move(std::uint32_t row, int count);
+
+        /**
+         * @brief Removes all rows.
+         */
+        void clear();
+    };
+
+    /**
+     * @struct Link
+     * @brief Whether a row changed since it was last moved, and the next row in the list of changed rows.
+     */
+    struct Link
+    {
+        std::atomic<bool> changed{false};  ///< Whether the row is in the list of changed rows.
+        std::atomic<std::uint32_t> next{0};  ///< The row after this one in the list, only valid while changed.
+
+        Link() = default;
+        Link(const Link &other) : changed(other.changed.load(std::memory_order_relaxed)), next(other.next.load(std::memory_order_relaxed)) {}
+    };
+
+    static const std::uint32_t endOfList = UINT32_MAX;  ///< Marks the end of the list of changed rows.
+
+    Order borrowed;  ///< The rows by their borrowed copies.
+    Order available;  ///< The rows by the copies in stock that are not borrowed.
+    std::vector<Link> links;  ///< The link of every row.
+    std::atomic<std::uint32_t> changedRows{endOfList};  ///< The row changed last, the head of the list of changed rows.
+    std::mutex mutex;  ///< Lets only one query at a time move rows and walk the orders.
+
+    /**
+     * @brief Moves every changed row to the buckets of its current copies. Needs the mutex.
+     * @param store The store the copies are read from.
+     */
+    void reconcile(const MagazineStore &store);
+
+    /**
+     * @brief Returns the copies of a row that are not borrowed, never below zero.
+     */
+    static int availableCopies(int stock, int borrowedCopies) { return stock > borrowedCopies ? stock - borrowedCopies : 0; }
+
+public:
+    /**
+     * @brief Adds the row after the last one added. Needs exclusive access.
+     *
+     * @param stock The copies in stock of the row.
+     * @param borrowedCopies The borrowed copies of the row.
+     */
+    void add(int stock, int borrowedCopies);
+
+    /**
+     * @brief Notes that the copies of a row were changed, without waiting for any other thread.
+     *
+     * The row is moved to its new buckets by the next query.
+     * @param row The changed row.
+     */
+    void markChanged(std::uint32_t row);
+
+    /**
+     * @brief Builds the ranking anew from all rows of a store. Needs exclusive access.
+     * @param store The store.
+     */
+    void rebuild(const MagazineStore &store);
+
+    /**
+     * @brief Returns the rows with the most borrowed copies.
+     *
+     * Rows without borrowed copies are left out. Rows with the same count are in the order they were added, but
+     * which of them are left out when they do not all fit is not specified.
+     * @param store The store the copies of changed rows are read from.
+     * @param limit The largest number of rows to return.
+     * @return The rows, most borrowed copies first.
+     */
+    std::vector<std::uint32_t> mostBorrowed(const MagazineStore &store, std::size_t limit);
+
+    /**
+     * @brief Returns the rows with at most a number of available copies.
+     *
+     * Rows with the same count are in the order they were added, but which of them are left out when they do not
+     * all fit is not specified.
+     * @param store The store the copies of changed rows are read from.
+     * @param maximum The largest number of available copies of a returned row, 0 for the rows that are all borrowed.
+     * @param limit The largest number of rows to return, 0 for all.
+     * @return The rows, fewest available copies first.
+     */
+    std::vector<std::uint32_t> leastAvailable(const MagazineStore &store, int maximum, std::size_t limit);
+
+    /**
+     * @brief Removes all rows. Needs exclusive access.
+     */
+    void clear();
+};
+
+#endif // COPYRANKING_HPP
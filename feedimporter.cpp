@@ -0,0 +1,251 @@
+/**
+ * @file feedimporter.cpp
+ * @brief File containing the implementation of the FeedImporter class.
+ */
+
+#include "feedimporter.hpp"
+#include "mappedfile.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+/**
+ * @brief The number of bytes of the feed one thread parses per round.
+ *
+ * Bounds the memory used for parsed rows, since each round is merged and freed before the next one is parsed.
+ */
+static const std::size_t rangeSize = 4 << 20;
+
+const char *FeedImporter::splitFields(std::string_view row, char delimiter, std::string (&fields)[fieldCount])
+{
+    std::size_t count = 0;
+    std::size_t position = 0;
+    while (true)
+    {
+        if (count == fieldCount)
+        {
+            return "Falsche Anzahl Felder, erwartet werden Autor, Titel, Verlag, ISSN, Anzahl, Datum und Preis";
+        }
+        std::string &field = fields[count++];
+        if (position < row.size() && row[position] == '"')
+        {
+            // A quoted field ends at a single quote, two quotes stand for one
+            field.clear();
+            ++position;
+            while (true)
+            {
+                std::size_t quote = row.find('"', position);
+                if (quote == std::string_view::npos)
+                {
+                    return "Anfuehrungszeichen wird nicht geschlossen";
+                }
+                field.append(row.substr(position, quote - position));
+                position = quote + 1;
+                if (position == row.size() || row[position] != '"')
+                {
+                    break;
+                }
+                field += '"';
+                ++position;
+            }
+            if (position < row.size() && row[position] != delimiter)
+            {
+                return "Zeichen nach schliessendem Anfuehrungszeichen";
+            }
+        }
+        else
+        {
+            std::size_t end = std::min(row.find(delimiter, position), row.size());
+            field.assign(row.substr(position, end - position));
+            position = end;
+        }
+        if (position == row.size())
+        {
+            break;
+        }
+        ++position;
+    }
+    if (count != fieldCount)
+    {
+        return "Falsche Anzahl Felder, erwartet werden Autor, Titel, Verlag, ISSN, Anzahl, Datum und Preis";
+    }
+    return nullptr;
+}
+
+std::size_t FeedImporter::parseRange(const char *data, std::size_t begin, std::size_t end, char delimiter,
+                                     std::vector<FeedRow> &rows, std::vector<Magazine> &magazines)
+{
+    std::string fields[fieldCount];
+    std::size_t line = 0;
+    for (std::size_t position = begin; position < end; ++line)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(data + position, '\n', end - position));
+        std::size_t lineEnd = newline ? newline - data : end;
+        std::string_view row(data + position, lineEnd - position);
+        position = newline ? lineEnd + 1 : end;
+        // Feeds exported on Windows end their lines with \r\n
+        if (!row.empty() && row.back() == '\r')
+        {
+            row.remove_suffix(1);
+        }
+        if (row.empty())
+        {
+            continue;
+        }
+
+        int stock;
+        double price;
+        std::uint32_t packed;
+        ISSNStatus issnStatus;
+        const char *problem = splitFields(row, delimiter, fields);
+        if (!problem)
+        {
+            if (!Utils::containsValidChars(fields[0]) || !Utils::containsValidChars(fields[1]) || !Utils::containsValidChars(fields[2]))
+            {
+                problem = "Autor, Titel oder Verlag enthaelt ungueltige Zeichen";
+            }
+            else if ((issnStatus = Utils::parseISSN(fields[3], packed)) == ISSNStatus::Malformed)
+            {
+                problem = "Ungueltige ISSN";
+            }
+            else if (issnStatus == ISSNStatus::WrongCheckDigit)
+            {
+                // Unlike the catalogue, feeds are new data, so a typo in the ISSN is caught here
+                problem = "Pruefziffer der ISSN stimmt nicht";
+            }
+            else if (!Utils::parseNumber(fields[4], stock) || stock < 0 || stock > MagazineStore::maxCopies)
+            {
+                problem = "Ungueltige Anzahl im Lager";
+            }
+            else if (!Utils::isValidDate(fields[5]))
+            {
+                problem = "Ungueltiges Erscheinungsdatum";
+            }
+            else
+            {
+                // Feeds from German spreadsheets write prices with a decimal comma
+                std::replace(fields[6].begin(), fields[6].end(), ',', '.');
+                if (!Utils::parseNumber(fields[6], price) || price < 0.0)
+                {
+                    problem = "Ungueltiger Preis";
+                }
+            }
+        }
+        rows.push_back({line, row, problem});
+        if (!problem)
+        {
+            magazines.emplace_back(fields[0], fields[1], fields[2], fields[3], stock, fields[5], price);
+        }
+    }
+    return line;
+}
+
+bool FeedImporter::import(Libary &libary, const std::string &feedFile, const std::string &reportFile, ImportSummary &summary)
+{
+    summary = ImportSummary();
+    MappedFile file;
+    if (!file.open(feedFile))
+    {
+        return false;
+    }
+    std::ofstream report(reportFile);
+    if (!report)
+    {
+        return false;
+    }
+    report << "Zeile\tGrund\tDatensatz\n";
+    const char *data = file.data();
+    std::size_t size = file.size();
+
+    // The first row decides the delimiter and may hold the column headings
+    std::size_t position = 0;
+    std::size_t lineBase = 0;
+    char delimiter = '\t';
+    if (size > 0)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(data, '\n', size));
+        std::string_view first(data, newline ? newline - data : size);
+        if (first.find('\t') == std::string_view::npos)
+        {
+            delimiter = std::count(first.begin(), first.end(), ';') > std::count(first.begin(), first.end(), ',') ? ';' : ',';
+        }
+        if (!first.empty() && first.back() == '\r')
+        {
+            first.remove_suffix(1);
+        }
+        std::string fields[fieldCount];
+        if (!splitFields(first, delimiter, fields) && fields[3].size() == 4 &&
+            std::equal(fields[3].begin(), fields[3].end(), "ISSN", [](char a, char b)
+                       { return std::toupper(static_cast<unsigned char>(a)) == b; }))
+        {
+            position = newline ? newline - data + 1 : size;
+            lineBase = 1;
+        }
+    }
+
+    std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::vector<FeedRow>> rows(threadCount);
+    std::vector<std::vector<Magazine>> magazines(threadCount);
+    std::vector<std::size_t> lines(threadCount);
+    while (position < size)
+    {
+        // The next round: up to one range per thread, each ending at a line break
+        std::vector<std::size_t> bounds{position};
+        while (bounds.size() <= threadCount && bounds.back() < size)
+        {
+            std::size_t next = bounds.back() + rangeSize;
+            const char *newline = next < size ? static_cast<const char *>(std::memchr(data + next, '\n', size - next)) : nullptr;
+            bounds.push_back(newline ? newline - data + 1 : size);
+        }
+        std::size_t ranges = bounds.size() - 1;
+
+        std::vector<std::thread> threads;
+        for (std::size_t r = 1; r < ranges; ++r)
+        {
+            threads.emplace_back([&, r]()
+                                 { lines[r] = parseRange(data, bounds[r], bounds[r + 1], delimiter, rows[r], magazines[r]); });
+        }
+        lines[0] = parseRange(data, bounds[0], bounds[1], delimiter, rows[0], magazines[0]);
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        // Merge in file order, so the outcome does not depend on the number of threads
+        for (std::size_t r = 0; r < ranges; ++r)
+        {
+            std::vector<MergeOutcome> outcomes = libary.mergeMagazines(magazines[r]);
+            std::size_t next = 0;
+            for (const FeedRow &row : rows[r])
+            {
+                const char *problem = row.problem;
+                if (!problem)
+                {
+                    MergeOutcome outcome = outcomes[next++];
+                    if (outcome == MergeOutcome::Added)
+                    {
+                        ++summary.added;
+                        continue;
+                    }
+                    if (outcome == MergeOutcome::StockIncreased)
+                    {
+                        ++summary.increased;
+                        continue;
+                    }
+                    problem = outcome == MergeOutcome::StockExceeded ? "Anzahl im Lager zu gross" : "Der Preis muss zwischen 0 und 40000000 Euro liegen";
+                }
+                ++summary.rejected;
+                report << lineBase + row.line + 1 << '\t' << problem << '\t' << row.text << '\n';
+            }
+            lineBase += lines[r];
+            rows[r].clear();
+            magazines[r].clear();
+        }
+        position = bounds.back();
+    }
+    report.close();
+    return !report.fail();
+}
@@ -0,0 +1,96 @@
+/**
+ * @file feedimporter.hpp
+ * @brief File containing the declaration of the FeedImporter class.
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "magazine.hpp"
+#include "libary.hpp"
+
+#ifndef FEEDIMPORTER_HPP
+#define FEEDIMPORTER_HPP
+
+/**
+ * @struct ImportSummary
+ * @brief Counts what an import did with the rows of a feed.
+ */
+struct ImportSummary
+{
+    std::size_t added = 0;  ///< The number of rows that added a new magazine.
+    std::size_t increased = 0;  ///< The number of rows that increased the stock of an existing magazine.
+    std::size_t rejected = 0;  ///< The number of rows that were written to the report instead.
+};
+
+/**
+ * @struct FeedRow
+ * @brief The outcome of parsing a single row of a feed.
+ */
+struct FeedRow
+{
+    std::size_t line;  ///< The line number of the row within its range, starting at 0.
+    std::string_view text;  ///< The row as it appears in the feed, without line break.
+    const char *problem;  ///< A description of why the row was rejected, nullptr if it holds a valid magazine.
+};
+
+/**
+ * @class FeedImporter
+ * @brief Imports the CSV or TSV feeds of publishers into a Libary.
+ *
+ * @details Every row of a feed describes one magazine with the fields author, title, publisher, ISSN, stock,
+ * publication date and price, in the order of the database file. The fields are separated by tabs, semicolons or
+ * commas, whichever the first row uses, and may be enclosed in double quotes to contain the separator; a quote
+ * inside a quoted field is written twice. Prices may use a decimal comma, and ISSNs must have the right check
+ * character. A first row whose ISSN field reads "ISSN" is taken as column headings and skipped.
+ *
+ * The feed is mapped into memory and processed in rounds: a few megabytes per thread are parsed and validated in
+ * parallel, then the valid rows are merged with Libary::mergeMagazines() in file order, so the result is the same as
+ * adding the rows one by one, no matter how many threads were used. Rows that are invalid or cannot be merged are
+ * written to a tab separated report with their line number and the reason, and the import goes on with the next row.
+ */
+class FeedImporter
+{
+private:
+    static const std::size_t fieldCount = 7;  ///< The number of fields of a row.
+
+    /**
+     * @brief Splits a row into its fields.
+     *
+     * @param row The row without line break.
+     * @param delimiter The character that separates the fields.
+     * @param fields Receives the fields with quotes removed.
+     * @return nullptr if the row has exactly fieldCount fields, a description of the problem otherwise.
+     */
+    static const char *splitFields(std::string_view row, char delimiter, std::string (&fields)[fieldCount]);
+
+    /**
+     * @brief Parses and validates all rows of a byte range.
+     *
+     * @param data The contents of the whole feed.
+     * @param begin The start of the range, which must be the start of a line.
+     * @param end The end of the range, which must be the end of a line or of the feed.
+     * @param delimiter The character that separates the fields.
+     * @param rows Receives every non-empty row in file order.
+     * @param magazines Receives the magazine of every valid row in file order.
+     * @return The number of lines in the range.
+     */
+    static std::size_t parseRange(const char *data, std::size_t begin, std::size_t end, char delimiter,
+                                  std::vector<FeedRow> &rows, std::vector<Magazine> &magazines);
+
+public:
+    /**
+     * @brief Imports a feed into a library.
+     *
+     * New ISSNs are added, the stock of existing ISSNs is increased by the stock given in the feed.
+     * @param libary The library to import into.
+     * @param feedFile The name of the feed file.
+     * @param reportFile The name of the report file, which is overwritten and lists every rejected row.
+     * @param summary Receives the number of added, increased and rejected rows.
+     * @return true if the feed was imported, false if it cannot be read or the report cannot be written.
+     */
+    static bool import(Libary &libary, const std::string &feedFile, const std::string &reportFile, ImportSummary &summary);
+};
+
+#endif // FEEDIMPORTER_HPP
@@ -3,14 +3,21 @@
  * @brief File containing the implementation of the Handler class.
  */
 #include "handlers.hpp"
+#include "metrics.hpp"
 #include "utils.hpp"
+#include <cstdio>
 #include <iostream>
 #include <cctype>
 #include <limits>
 
 Libary libary;
 
-std::string Handler::getInputWithValidation(const std::string& prompt, bool (*validationFunc)(const std::string&)) {
+/**
+ * @brief The number of magazines printed before asking whether to go on.
+ */
+static const std::size_t pageSize = 20;
+
+std::string Handler::getInputWithValidation(const std::string& prompt, bool (*validationFunc)(std::string_view)) {
     std::string input;
     do {
         std::cout << prompt;
@@ -61,41 +68,97 @@ void Handler::handleAddMagazine() {
     std::string title = getInputWithValidation("Titel eingeben (keine Umlaute oder Sonderzeicehn): ", Utils::containsValidChars);
     std::string publisher = getInputWithValidation("Verlag eingeben (keine Umlaute oder Sonderzeicehn): ", Utils::containsValidChars);
     std::string issn = getInputWithValidation("ISSN eingeben: ", Utils::isValidISSN);
+    // Only existing catalogues may keep a wrong check character, a newly entered ISSN must be right
+    std::uint32_t packedISSN;
+    while (Utils::parseISSN(issn, packedISSN) == ISSNStatus::WrongCheckDigit) {
+        std::cout << "Die Pruefziffer der ISSN stimmt nicht. Bitte pruefen Sie die Eingabe.\n";
+        issn = getInputWithValidation("ISSN eingeben: ", Utils::isValidISSN);
+    }
     int stock = getNumericInputWithValidation("Anzahl im Lager eingeben: ");
+    while (stock < 0 || stock > MagazineStore::maxCopies) {
+        std::cout << "Die Anzahl muss zwischen 0 und " << MagazineStore::maxCopies << " liegen.\n";
+        stock = getNumericInputWithValidation("Anzahl im Lager eingeben: ");
+    }
     std::string publicationDate = getInputWithValidation("Veroeffentlichungsdatum eingeben (DD.MM.YYYY): ", Utils::isValidDate);
     double price = getDoubleInputWithValidation("Preis eingeben (in Euro ohne Währungszeichen): ");
 
     if (libary.magazineExists(issn)) {
-        libary.increaseStock(issn, stock);
-        std::cout << "Ein Magazin mit der ISSN " << issn << " existiert bereits. Die Anzahl im Lager wird um " << stock << " erhöht.\n";
+        if (libary.increaseStock(issn, stock)) {
+            std::cout << "Ein Magazin mit der ISSN " << issn << " existiert bereits. Die Anzahl im Lager wird um " << stock << " erhöht.\n";
+            reportUnsavedChange();
+        } else {
+            std::cout << "Ein Magazin mit der ISSN " << issn << " existiert bereits. Die Anzahl im Lager kann nicht ueber " << MagazineStore::maxCopies << " erhoeht werden.\n";
+        }
         std::cout << "------------------------\n";
+    } else if (libary.addMagazine(Magazine(author, title, publisher, issn, stock, publicationDate, price))) {
+        reportUnsavedChange();
     } else {
-        libary.addMagazine(Magazine(author, title, publisher, issn, stock, publicationDate, price));
+        std::cout << "Das Magazin konnte nicht hinzugefuegt werden. Der Preis muss zwischen 0 und 40000000 Euro liegen.\n";
+        std::cout << "------------------------\n";
+    }
+}
+
+void Handler::reportUnsavedChange() {
+    // Retries the records that could not be written, so the warning stops once the disk works again
+    if (!libary.commitJournal()) {
+        std::cout << "Die Aenderung konnte nicht ins Journal geschrieben werden. Sie wird erst beim Beenden gespeichert.\n";
     }
 }
 
 void Handler::handleSearchByTitle() {
     std::string title = getInputWithValidation("Titel eingeben: ", Utils::containsValidChars);
-    std::vector<Magazine*> magazines = libary.searchByTitle(title);
+    std::vector<Magazine> magazines = libary.searchByTitle(title);
     if (!magazines.empty()) {
-        std::cout << "Magazin(e) gefunden: \n";
-        for (Magazine* magazine : magazines) {
-            std::cout << "Author: " << magazine->author << "\n";
-            std::cout << "Titel: " << magazine->title << "\n";
-            std::cout << "Verlag: " << magazine->publisher << "\n";
-            std::cout << "ISSN: " << magazine->issn << "\n";
-            std::cout << "Erscheinungsdatum: " << magazine->publicationDate << "\n";
-            std::cout << "Preis: " << magazine->price << " Euro\n";
-            std::cout << "Anzahl im Lager: " << magazine->stock << "\n";
-            std::cout << "Davon ausgeliehen: " << magazine->borrowedCopies << "\n";
-            std::cout << "------------------------\n";
-        }
+        printMagazines(magazines);
     } else {
         std::cout << "Magazin nicht gefunden\n";
+        std::vector<TitleSuggestion> suggestions = libary.suggestByTitle(title);
+        if (!suggestions.empty()) {
+            std::cout << "Meinten Sie: \n";
+            for (const TitleSuggestion& suggestion : suggestions) {
+                std::cout << "  " << suggestion.magazine.title << " (ISSN: " << suggestion.magazine.issn
+                          << ", Abweichung: " << suggestion.distance << ")\n";
+            }
+        }
+        std::cout << "------------------------\n";
+    }
+}
+
+void Handler::printMagazines(const std::vector<Magazine> &magazines) {
+    if (magazines.empty()) {
+        std::cout << "Kein Magazin gefunden\n";
         std::cout << "------------------------\n";
+        return;
+    }
+    output = std::to_string(magazines.size()) + " Magazin(e) gefunden: \n";
+    std::size_t shown = 0;
+    while (true) {
+        shown += formatter.appendPage(output, magazines, shown, pageSize);
+        std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+        output.clear();
+        if (shown == magazines.size()) {
+            break;
+        }
+        std::string answer;
+        std::cout << "Noch " << magazines.size() - shown << " Magazin(e). Weitere anzeigen? (J/N): ";
+        if (!std::getline(std::cin, answer) || (answer != "J" && answer != "j")) {
+            break;
+        }
     }
 }
 
+void Handler::handleSearchByDate() {
+    std::string from = getInputWithValidation("Erschienen ab (DD.MM.YYYY): ", Utils::isValidDate);
+    std::string to = getInputWithValidation("Erschienen bis einschliesslich (DD.MM.YYYY): ", Utils::isValidDate);
+    printMagazines(libary.searchByDate(from, to));
+}
+
+void Handler::handleSearchByPrice() {
+    double minimum = getDoubleInputWithValidation("Preis ab (in Euro ohne Waehrungszeichen): ");
+    double maximum = getDoubleInputWithValidation("Preis bis einschliesslich (in Euro ohne Waehrungszeichen): ");
+    printMagazines(libary.searchByPrice(minimum, maximum));
+}
+
 void Handler::handleSearchByISSN()
 {
     std::string issn;
@@ -112,20 +175,13 @@ void Handler::handleSearchByISSN()
             std::cout << "Ungueltiges ISSN Format. ISSN sollte ein 8-Zahliger Code im Format XXXX-XXXX sein.\n";
         }
     } while (true);
-    Magazine *magazine = libary.searchByISSN(issn);
+    std::optional<Magazine> magazine = libary.searchByISSN(issn);
     if (magazine)
     {
-        std::cout << "Magazin gefunden: "
-                  << "\n";
-        std::cout << "Autor: " << magazine->author << "\n";
-        std::cout << "Titel: " << magazine->title << "\n";
-        std::cout << "Verlag: " << magazine->publisher << "\n";
-        std::cout << "ISSN: " << magazine->issn << "\n";
-        std::cout << "Erscheinungsdatum: " << magazine->publicationDate << "\n";
-        std::cout << "Preis: " << magazine->price << " Euro\n";
-        std::cout << "Anzahl im Lager: " << magazine->stock << "\n";
-        std::cout << "Davon ausgeliehen: " << magazine->borrowedCopies << "\n";
-        std::cout << "------------------------\n";
+        output = "Magazin gefunden: \n";
+        formatter.append(output, *magazine);
+        std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+        output.clear();
     }
     else
     {
@@ -150,10 +206,11 @@ void Handler::handleBorrowMagazine()
             std::cout << "Ungueltiges ISSN Format. ISSN sollte ein 8-Zahliger Code im Format XXXX-XXXX sein.\n";
         }
     } while (true);
-    Magazine *magazine = libary.searchByISSN(issn);
+    std::optional<Magazine> magazine = libary.searchByISSN(issn);
     if (magazine) {
         if (libary.borrowMagazine(*magazine)) {
             std::cout << "Magazin wurde ausgeliehen\n";
+            reportUnsavedChange();
             std::cout << "------------------------\n";
         } else {
             std::cout << "Keine Exemplare zum Ausleihen vorhanden.\n";
@@ -181,10 +238,11 @@ void Handler::handleReturnMagazine()
             std::cout << "Ungueltiges ISSN Format. ISSN sollte ein 8-Zahliger Code im Format XXXX-XXXX sein.\n";
         }
     } while (true);
-    Magazine *magazine = libary.searchByISSN(issn);
+    std::optional<Magazine> magazine = libary.searchByISSN(issn);
     if (magazine) {
         if (libary.returnMagazine(*magazine)) {
             std::cout << "Magazin wurde zurueckgegeben\n";
+            reportUnsavedChange();
             std::cout << "------------------------\n";
         } else {
             std::cout << "Keine ausgeliehenen Exemplare zum Zurueckgeben vorhanden.\n";
@@ -196,8 +254,43 @@ void Handler::handleReturnMagazine()
     }
 }
 
-void Handler::handleExit()
+void Handler::handleShowStatistics()
+{
+    if (!Metrics::enabled())
+    {
+        std::cout << "Die Statistik ist in dieser Version nicht einkompiliert.\n";
+        std::cout << "------------------------\n";
+        return;
+    }
+    // Latencies in microseconds, from the timed calls only
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-16s %10s %10s %10s %10s %10s %10s %10s\n", "Operation", "Aufrufe", "gemessen", "Mittel", "p50", "p90", "p99", "Max");
+    output = line;
+    for (const OperationStats &operation : Metrics::collect())
+    {
+        double mean = operation.timed ? static_cast<double>(operation.totalNanoseconds) / operation.timed : 0.0;
+        std::snprintf(line, sizeof(line), "%-16s %10llu %10llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", operation.name,
+                      static_cast<unsigned long long>(operation.count), static_cast<unsigned long long>(operation.timed), mean / 1000.0,
+                      operation.percentile(0.5) / 1000.0, operation.percentile(0.9) / 1000.0, operation.percentile(0.99) / 1000.0,
+                      operation.maxNanoseconds / 1000.0);
+        output += line;
+    }
+    output += "Latenzen in Mikrosekunden\n------------------------\n";
+    std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+    output.clear();
+}
+
+int Handler::handleExit()
 {
-    libary.saveToFile("magazine.txt");
-    exit(0);                           // Exit the program
+    if (libary.compact("magazine.txt")) {
+        std::cout << "Das Programm wurde beendet und die Datenbank gespeichert.\n";
+        return 0;
+    }
+    // Without a journal the failed save was the only copy of the changes
+    if (libary.isJournaling() && libary.commitJournal()) {
+        std::cout << "Die Datenbank konnte nicht gespeichert werden. Die Aenderungen stehen im Journal und werden beim naechsten Start wiederhergestellt.\n";
+    } else {
+        std::cout << "Die Datenbank konnte nicht gespeichert werden. Die Aenderungen dieser Sitzung sind verloren.\n";
+    }
+    return 1;
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #define HANDLERS_HPP
 
 #include "libary.hpp"
+#include "resultformatter.hpp"
 #include "utils.hpp"
 
 /**
@@ -28,6 +29,29 @@ private:
      */
     Libary &libary;
 
+    /**
+     * @brief Renders the magazines of search results for the terminal.
+     */
+    ResultFormatter formatter;
+
+    /**
+     * @brief The text of a page of results, kept between searches and written to std::cout at once.
+     */
+    std::string output;
+
+    /**
+     * @brief Prints the details of every magazine of a search result, or that nothing was found.
+     *
+     * Large results are printed a page at a time, asking before every further page.
+     * @param magazines The magazines found.
+     */
+    void printMagazines(const std::vector<Magazine> &magazines);
+
+    /**
+     * @brief Tells the user if a change could not be written to the journal, see Libary::commitJournal().
+     */
+    void reportUnsavedChange();
+
 public:
     /**
      * @brief Constructor that takes a reference to a Library object.
@@ -48,7 +72,7 @@ public:
      * @param validationFunc The function to use to validate the input.
      * @return The valid input from the user.
      */
-    std::string getInputWithValidation(const std::string &prompt, bool (*validationFunc)(const std::string &));
+    std::string getInputWithValidation(const std::string &prompt, bool (*validationFunc)(std::string_view));
 
     /**
      * @brief Get numeric input from the user with validation.
@@ -81,9 +105,10 @@ public:
     /**
      * @brief Handles the search of a magazine by title in the library.
      *
-     * This function prompts the user to enter a title, and then searches the library for a magazine with that title.
-     * If a magazine is found, its details are printed to the console. If multiple magazines are found,
-     * the details of all matching magazines are printed.
+     * This function prompts the user to enter a title, and then searches the library for magazines whose title
+     * contains all entered words, where each word may also be abbreviated. If a magazine is found, its details are printed to the console. If multiple magazines are found,
+     * the details of all matching magazines are printed. If nothing is found, similar titles are suggested
+     * in case the title was misspelled.
      *
      */
     void handleSearchByTitle();
@@ -97,6 +122,22 @@ public:
      */
     void handleSearchByISSN();
 
+    /**
+     * @brief Handles the search of magazines by publication date.
+     *
+     * This function prompts the user to enter the first and the last day of a period, and then prints the details of all
+     * magazines published in that period, oldest first.
+     */
+    void handleSearchByDate();
+
+    /**
+     * @brief Handles the search of magazines by price.
+     *
+     * This function prompts the user to enter the lowest and the highest price, and then prints the details of all
+     * magazines in that price range, cheapest first.
+     */
+    void handleSearchByPrice();
+
     /**
      * @brief Handles the borrowing of a magazine.
      *
@@ -115,13 +156,24 @@ public:
      */
     void handleReturnMagazine();
 
+    /**
+     * @brief Handles the display of the operation statistics.
+     *
+     * This function prints for every instrumented library operation how often it was called and how long the timed
+     * calls took, see Metrics.
+     */
+    void handleShowStatistics();
+
     /**
      * @brief Handles the exit operation from the library system.
      *
-     * This function saves the current state of the library to a file and then exits the program.
+     * This function saves the current state of the library to a file, which also empties the journal, and tells the
+     * user whether that worked and, if not, whether the changes are still in the journal. The caller then ends the
+     * program, so that everything it owns is shut down in order.
      *
+     * @return The exit status of the program, 0 if the library was saved.
      */
-    void handleExit();
+    int handleExit();
 };
 
 #endif // HANDLERS_HPP
\ No newline at end of file
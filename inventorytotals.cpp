@@ -0,0 +1,96 @@
+/**
+ * @file inventorytotals.cpp
+ * @brief File containing the implementation of the InventoryTotals class.
+ */
+
+#include "inventorytotals.hpp"
+#include <algorithm>
+
+void InventoryTotals::apply(Counters &counters, std::int64_t magazines, std::int64_t stock, std::int64_t borrowed, std::int64_t valueCents)
+{
+    // Borrowing and returning only touch the borrowed copies, so the other counters are left alone
+    if (magazines != 0)
+    {
+        counters.magazines.fetch_add(magazines, std::memory_order_relaxed);
+    }
+    if (stock != 0)
+    {
+        counters.stock.fetch_add(stock, std::memory_order_relaxed);
+        counters.valueCents.fetch_add(valueCents, std::memory_order_relaxed);
+    }
+    if (borrowed != 0)
+    {
+        counters.borrowed.fetch_add(borrowed, std::memory_order_relaxed);
+    }
+}
+
+InventoryFigures InventoryTotals::read(const Counters &counters)
+{
+    InventoryFigures figures;
+    figures.magazines = counters.magazines.load(std::memory_order_relaxed);
+    figures.stock = counters.stock.load(std::memory_order_relaxed);
+    figures.borrowed = counters.borrowed.load(std::memory_order_relaxed);
+    figures.valueCents = counters.valueCents.load(std::memory_order_relaxed);
+    return figures;
+}
+
+void InventoryTotals::add(std::uint32_t publisher, int stock, int borrowed, std::uint32_t priceCents)
+{
+    while (publishers.size() <= publisher)
+    {
+        publishers.emplace_back();
+    }
+    std::int64_t value = static_cast<std::int64_t>(stock) * priceCents;
+    apply(overall, 1, stock, borrowed, value);
+    apply(publishers[publisher], 1, stock, borrowed, value);
+}
+
+void InventoryTotals::change(std::uint32_t publisher, int stockChange, int borrowedChange, std::uint32_t priceCents)
+{
+    std::int64_t value = static_cast<std::int64_t>(stockChange) * priceCents;
+    apply(overall, 0, stockChange, borrowedChange, value);
+    apply(publishers[publisher], 0, stockChange, borrowedChange, value);
+}
+
+InventoryFigures InventoryTotals::publisher(std::uint32_t publisher) const
+{
+    return publisher < publishers.size() ? read(publishers[publisher]) : InventoryFigures();
+}
+
+void InventoryTotals::recompute(const MagazineStore &store)
+{
+    clear();
+    for (std::uint32_t row = 0; row < store.size(); ++row)
+    {
+        int stock, borrowed;
+        store.copiesOf(row, stock, borrowed);
+        add(store.publisherId(row), stock, borrowed, store.priceCents(row));
+    }
+}
+
+bool InventoryTotals::matches(const InventoryTotals &other) const
+{
+    if (total() != other.total())
+    {
+        return false;
+    }
+    // Publishers without magazines may be missing at the end of either deque
+    std::size_t count = std::max(publishers.size(), other.publishers.size());
+    for (std::size_t id = 0; id < count; ++id)
+    {
+        if (publisher(static_cast<std::uint32_t>(id)) != other.publisher(static_cast<std::uint32_t>(id)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void InventoryTotals::clear()
+{
+    publishers.clear();
+    overall.magazines.store(0, std::memory_order_relaxed);
+    overall.stock.store(0, std::memory_order_relaxed);
+    overall.borrowed.store(0, std::memory_order_relaxed);
+    overall.valueCents.store(0, std::memory_order_relaxed);
+}
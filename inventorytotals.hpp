@@ -0,0 +1,128 @@
+/**
+ * @file inventorytotals.hpp
+ * @brief File containing the declaration of the InventoryTotals class.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include "magazinestore.hpp"
+
+#ifndef INVENTORYTOTALS_HPP
+#define INVENTORYTOTALS_HPP
+
+/**
+ * @struct InventoryFigures
+ * @brief The totals of a group of magazines at one point in time.
+ */
+struct InventoryFigures
+{
+    std::int64_t magazines = 0;  ///< The number of magazines.
+    std::int64_t stock = 0;  ///< The copies in stock, including the borrowed ones.
+    std::int64_t borrowed = 0;  ///< The copies on loan.
+    std::int64_t valueCents = 0;  ///< The sum of stock times price over all magazines, in cents.
+
+    bool operator==(const InventoryFigures &other) const
+    {
+        return magazines == other.magazines && stock == other.stock && borrowed == other.borrowed && valueCents == other.valueCents;
+    }
+    bool operator!=(const InventoryFigures &other) const { return !(*this == other); }
+};
+
+/**
+ * @class InventoryTotals
+ * @brief Totals of the copies and the inventory value, overall and per publisher, kept up to date with every change.
+ *
+ * @details Every change of a magazine's copies is passed on as a difference, so the totals cost O(1) per change and
+ * can be read at any time without scanning the store. The value is summed in whole cents, so the totals equal a full
+ * recomputation exactly instead of drifting by rounding errors. The counters are atomic and changed with relaxed
+ * additions, so changes from threads that share the library's reader lock can run at the same time. A reader that
+ * runs alongside such changes may see some of them and not others; under the exclusive lock the totals are exact.
+ *
+ * The counters of the publishers are indexed by the interned id of the publisher. They live in a deque, which never
+ * moves its elements, and are only added by add(), which must not run at the same time as any other method.
+ */
+class InventoryTotals
+{
+private:
+    /**
+     * @struct Counters
+     * @brief The counters of one group, on a cache line of its own so that busy publishers do not slow each other down.
+     */
+    struct alignas(64) Counters
+    {
+        std::atomic<std::int64_t> magazines{0};  ///< The number of magazines.
+        std::atomic<std::int64_t> stock{0};  ///< The copies in stock.
+        std::atomic<std::int64_t> borrowed{0};  ///< The copies on loan.
+        std::atomic<std::int64_t> valueCents{0};  ///< The inventory value in cents.
+    };
+
+    Counters overall;  ///< The counters over all magazines.
+    std::deque<Counters> publishers;  ///< The counters of every publisher, indexed by its interned id.
+
+    /**
+     * @brief Adds differences to the counters of a group.
+     */
+    static void apply(Counters &counters, std::int64_t magazines, std::int64_t stock, std::int64_t borrowed, std::int64_t valueCents);
+
+    /**
+     * @brief Reads the counters of a group.
+     */
+    static InventoryFigures read(const Counters &counters);
+
+public:
+    /**
+     * @brief Counts a new magazine. Must not run at the same time as any other method.
+     *
+     * @param publisher The interned id of the publisher.
+     * @param stock The copies in stock.
+     * @param borrowed The copies on loan.
+     * @param priceCents The price in cents.
+     */
+    void add(std::uint32_t publisher, int stock, int borrowed, std::uint32_t priceCents);
+
+    /**
+     * @brief Counts a change of the copies of a magazine that was counted with add() before.
+     *
+     * @param publisher The interned id of the publisher.
+     * @param stockChange The difference of the copies in stock.
+     * @param borrowedChange The difference of the copies on loan.
+     * @param priceCents The price in cents.
+     */
+    void change(std::uint32_t publisher, int stockChange, int borrowedChange, std::uint32_t priceCents);
+
+    /**
+     * @brief Returns the totals over all magazines.
+     * @return The totals.
+     */
+    InventoryFigures total() const { return read(overall); }
+
+    /**
+     * @brief Returns the totals of a publisher.
+     * @param publisher The interned id of the publisher.
+     * @return The totals, all zero if no magazine has this publisher.
+     */
+    InventoryFigures publisher(std::uint32_t publisher) const;
+
+    /**
+     * @brief Replaces all totals by a full recomputation from the records of a store.
+     *
+     * Must not run at the same time as any other method or any change of the store.
+     * @param store The store to count.
+     */
+    void recompute(const MagazineStore &store);
+
+    /**
+     * @brief Compares all totals, overall and of every publisher.
+     * @param other The totals to compare with.
+     * @return true if all totals are equal, false otherwise.
+     */
+    bool matches(const InventoryTotals &other) const;
+
+    /**
+     * @brief Resets all totals to zero.
+     */
+    void clear();
+};
+
+#endif // INVENTORYTOTALS_HPP
@@ -0,0 +1,132 @@
+/**
+ * @file issnindex.cpp
+ * @brief File containing the implementation of the IssnIndex class.
+ */
+
+#include "issnindex.hpp"
+#include <new>
+
+const IssnIndex::Slot *IssnIndex::lookup(const Table &table, std::uint32_t issn)
+{
+    if (!table.slots)
+    {
+        return nullptr;
+    }
+    for (std::size_t i = home(issn, table.mask);; i = (i + 1) & table.mask)
+    {
+        const Slot &slot = table.slots[i];
+        if (slot.key == issn + 1)
+        {
+            return &slot;
+        }
+        if (slot.key == 0)
+        {
+            return nullptr;
+        }
+    }
+}
+
+void IssnIndex::place(Table &table, std::uint32_t key, std::uint32_t row)
+{
+    std::size_t i = home(key - 1, table.mask);
+    while (table.slots[i].key != 0)
+    {
+        i = (i + 1) & table.mask;
+    }
+    table.slots[i] = {key, row};
+    ++table.count;
+}
+
+void IssnIndex::grow(std::size_t slots)
+{
+    migrate(previous.mask + 1);
+    Slot *memory = static_cast<Slot *>(std::calloc(slots, sizeof(Slot)));
+    if (!memory)
+    {
+        throw std::bad_alloc();
+    }
+    previous = std::move(current);
+    migrated = 0;
+    current.slots.reset(memory);
+    current.mask = slots - 1;
+    current.count = 0;
+    if (previous.count == 0)
+    {
+        previous = Table();
+    }
+}
+
+void IssnIndex::migrate(std::size_t slots)
+{
+    if (!previous.slots)
+    {
+        return;
+    }
+    // Moved slots stay in the old table, so the probe sequences of the entries behind them keep working
+    for (; slots > 0 && migrated <= previous.mask; --slots, ++migrated)
+    {
+        const Slot &slot = previous.slots[migrated];
+        if (slot.key != 0)
+        {
+            place(current, slot.key, slot.row);
+            --previous.count;
+        }
+    }
+    if (migrated > previous.mask)
+    {
+        previous = Table();
+    }
+}
+
+bool IssnIndex::find(std::uint32_t issn, std::uint32_t &row) const
+{
+    // Entries are looked up in the new table first, since moved entries are in both
+    const Slot *slot = lookup(current, issn);
+    if (!slot)
+    {
+        slot = lookup(previous, issn);
+    }
+    if (!slot)
+    {
+        return false;
+    }
+    row = slot->row;
+    return true;
+}
+
+std::uint32_t IssnIndex::insert(std::uint32_t issn, std::uint32_t row)
+{
+    std::uint32_t existing;
+    if (find(issn, existing))
+    {
+        return existing;
+    }
+    migrate(migrationStep);
+    // The table is kept at most half full, so probe sequences stay short
+    if ((size() + 1) * 2 > (current.slots ? current.mask + 1 : 0))
+    {
+        grow(current.slots ? (current.mask + 1) * 2 : 16);
+    }
+    place(current, issn + 1, row);
+    return row;
+}
+
+void IssnIndex::reserve(std::size_t count)
+{
+    std::size_t slots = 16;
+    while (slots < count * 2)
+    {
+        slots *= 2;
+    }
+    if (slots > (current.slots ? current.mask + 1 : 0))
+    {
+        grow(slots);
+    }
+}
+
+void IssnIndex::clear()
+{
+    current = Table();
+    previous = Table();
+    migrated = 0;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file issnindex.hpp
+ * @brief File containing the declaration of the IssnIndex class.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#ifndef ISSNINDEX_HPP
+#define ISSNINDEX_HPP
+
+/**
+ * @class IssnIndex
+ * @brief A hash table from the packed ISSN to the row of a magazine, which grows without stalling.
+ *
+ * @details The table uses open addressing with linear probing over slots of 8 bytes. When it gets half full, a table
+ * of twice the size is allocated, but the entries are not rehashed all at once like std::unordered_map does: every
+ * following insert moves a few slots of the old table over, and lookups search both tables until the old one is
+ * empty. New tables are allocated zeroed with calloc(), which large allocations get from fresh pages of the operating
+ * system without touching them. So no insert costs more than a small constant, however large the index has grown.
+ */
+class IssnIndex
+{
+private:
+    /**
+     * @struct Slot
+     * @brief An entry of a table. All zero means empty, so new tables can be allocated zeroed.
+     */
+    struct Slot
+    {
+        std::uint32_t key;  ///< The packed ISSN plus one, 0 for an empty slot.
+        std::uint32_t row;  ///< The row of the magazine.
+    };
+
+    /**
+     * @struct Table
+     * @brief A table of slots whose size is a power of two.
+     */
+    struct Table
+    {
+        std::unique_ptr<Slot[], void (*)(void *)> slots{nullptr, std::free};  ///< The slots, allocated with calloc().
+        std::size_t mask = 0;  ///< The number of slots minus one, 0 if there are no slots.
+        std::size_t count = 0;  ///< The number of used slots.
+    };
+
+    static const std::size_t migrationStep = 8;  ///< The number of old slots every insert moves to the new table.
+
+    Table current;  ///< The table new entries go to.
+    Table previous;  ///< The table that is being moved into current, without slots if there is none.
+    std::size_t migrated = 0;  ///< The number of slots of previous that were already moved.
+
+    /**
+     * @brief Returns the first slot to probe for a packed ISSN in a table of the given mask.
+     */
+    static std::size_t home(std::uint32_t issn, std::size_t mask) { return static_cast<std::size_t>((issn * 0x9E3779B97F4A7C15ull) >> 32) & mask; }
+
+    /**
+     * @brief Looks up a packed ISSN in one table.
+     * @return The slot of the ISSN, or nullptr if it is not in the table.
+     */
+    static const Slot *lookup(const Table &table, std::uint32_t issn);
+
+    /**
+     * @brief Puts an entry that is not in the table yet into its first free slot.
+     */
+    static void place(Table &table, std::uint32_t key, std::uint32_t row);
+
+    /**
+     * @brief Starts moving all entries into a new table of the given number of slots.
+     *
+     * Moves the rest of an unfinished earlier move first.
+     * @param slots The number of slots, a power of two.
+     */
+    void grow(std::size_t slots);
+
+    /**
+     * @brief Moves up to a number of slots of the previous table into the current one.
+     * @param slots The number of slots to move.
+     */
+    void migrate(std::size_t slots);
+
+public:
+    /**
+     * @brief Looks up the row of a magazine.
+     *
+     * @param issn The packed ISSN, see Utils::packISSN().
+     * @param row Receives the row of the magazine if found.
+     * @return true if the ISSN was found, false otherwise.
+     */
+    bool find(std::uint32_t issn, std::uint32_t &row) const;
+
+    /**
+     * @brief Checks whether a packed ISSN is in the index.
+     * @param issn The packed ISSN.
+     * @return true if the ISSN was found, false otherwise.
+     */
+    bool contains(std::uint32_t issn) const
+    {
+        std::uint32_t row;
+        return find(issn, row);
+    }
+
+    /**
+     * @brief Adds a magazine unless its ISSN is in the index already.
+     *
+     * @param issn The packed ISSN.
+     * @param row The row of the magazine.
+     * @return The row the index holds for the ISSN, which is row if the magazine was added.
+     */
+    std::uint32_t insert(std::uint32_t issn, std::uint32_t row);
+
+    /**
+     * @brief Makes room for a number of magazines in total, so that they can be added without growing again.
+     * @param count The expected number of magazines.
+     */
+    void reserve(std::size_t count);
+
+    /**
+     * @brief Returns the number of magazines in the index.
+     * @return The number of magazines.
+     */
+    std::size_t size() const { return current.count + previous.count; }
+
+    /**
+     * @brief Removes all magazines and frees the tables.
+     */
+    void clear();
+};
+
+#endif // ISSNINDEX_HPP
@@ -0,0 +1,480 @@
+/**
+ * @file journal.cpp
+ * @brief File containing the implementation of the Journal class.
+ */
+
+#include "journal.hpp"
+#include "mappedfile.hpp"
+#include "utils.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define journalOpen _open
+#define journalWrite _write
+#define journalClose _close
+#define journalSync _commit
+#define journalTruncate _chsize_s
+#define JOURNAL_FLAGS _O_BINARY
+#else
+#include <unistd.h>
+#define journalOpen ::open
+#define journalWrite ::write
+#define journalClose ::close
+#define journalSync ::fsync
+#define journalTruncate ::ftruncate
+#define JOURNAL_FLAGS 0
+#endif
+
+/**
+ * @brief The magic bytes at the start of every journal.
+ */
+static const char journalMagic[8] = {'M', 'A', 'G', 'J', 'R', 'N', 'L', '\0'};
+
+/**
+ * @brief The version of the journal format.
+ */
+static const std::uint32_t journalVersion = 1;
+
+/**
+ * @brief The size of the journal header: magic bytes, version, reserved word and base fingerprint.
+ */
+static const std::size_t headerSize = 24;
+
+/**
+ * @brief The size of the operation byte and payload length in front of every record.
+ */
+static const std::size_t recordHeaderSize = 5;
+
+/**
+ * @brief Appends the bytes of a fixed width value to a buffer.
+ */
+template <typename T>
+static void put(std::string &buffer, T value)
+{
+    buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+/**
+ * @brief Appends a string with its length to a buffer.
+ */
+static void putString(std::string &buffer, const std::string &text)
+{
+    put<std::uint32_t>(buffer, static_cast<std::uint32_t>(text.size()));
+    buffer += text;
+}
+
+/**
+ * @brief Reads a fixed width value from a buffer.
+ *
+ * @return false if the buffer ends before the value.
+ */
+template <typename T>
+static bool get(const char *&position, const char *end, T &value)
+{
+    if (static_cast<std::size_t>(end - position) < sizeof(T))
+    {
+        return false;
+    }
+    std::memcpy(&value, position, sizeof(T));
+    position += sizeof(T);
+    return true;
+}
+
+/**
+ * @brief Reads a string with its length from a buffer.
+ *
+ * @return false if the buffer ends before the string.
+ */
+static bool getString(const char *&position, const char *end, std::string &text)
+{
+    std::uint32_t length;
+    if (!get(position, end, length) || static_cast<std::size_t>(end - position) < length)
+    {
+        return false;
+    }
+    text.assign(position, length);
+    position += length;
+    return true;
+}
+
+/**
+ * @brief Writes a whole buffer to a file descriptor.
+ *
+ * @return true if everything was written, false otherwise.
+ */
+static bool writeAll(int fd, const char *data, std::size_t size)
+{
+    while (size > 0)
+    {
+        auto written = journalWrite(fd, data, static_cast<unsigned>(size));
+        if (written <= 0)
+        {
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Decodes the payload of a record.
+ *
+ * @param entries Receives the decoded operations, several for a CopyBatch record.
+ * @return false if the payload is malformed.
+ */
+static bool decode(JournalOperation operation, const char *position, const char *end, std::vector<JournalEntry> &entries)
+{
+    if (operation == JournalOperation::CopyBatch)
+    {
+        // A batch is replayed completely or not at all, so its entries are only kept if all of them decode
+        std::size_t first = entries.size();
+        std::uint32_t count;
+        bool valid = get(position, end, count);
+        for (std::uint32_t i = 0; valid && i < count; ++i)
+        {
+            std::uint8_t change;
+            std::uint32_t issn;
+            std::int32_t amount;
+            valid = get(position, end, change) && get(position, end, issn) && get(position, end, amount) &&
+                    (change == static_cast<std::uint8_t>(JournalOperation::Borrow) || change == static_cast<std::uint8_t>(JournalOperation::Return) ||
+                     change == static_cast<std::uint8_t>(JournalOperation::IncreaseStock));
+            if (valid)
+            {
+                entries.push_back({static_cast<JournalOperation>(change), Utils::unpackISSN(issn), amount, std::nullopt});
+            }
+        }
+        if (!valid || position != end)
+        {
+            entries.resize(first);
+            return false;
+        }
+        return true;
+    }
+
+    std::uint32_t issn;
+    if (!get(position, end, issn))
+    {
+        return false;
+    }
+    JournalEntry entry;
+    entry.operation = operation;
+    entry.issn = Utils::unpackISSN(issn);
+    entry.amount = 0;
+    switch (operation)
+    {
+    case JournalOperation::Borrow:
+    case JournalOperation::Return:
+        if (position != end)
+        {
+            return false;
+        }
+        break;
+    case JournalOperation::IncreaseStock:
+        if (!get(position, end, entry.amount) || position != end)
+        {
+            return false;
+        }
+        break;
+    case JournalOperation::Add:
+    {
+        std::int32_t days, stock, borrowedCopies;
+        double price;
+        std::string author, title, publisher;
+        if (!get(position, end, days) || !get(position, end, stock) || !get(position, end, borrowedCopies) ||
+            !get(position, end, price) || !getString(position, end, author) || !getString(position, end, title) ||
+            !getString(position, end, publisher) || position != end)
+        {
+            return false;
+        }
+        entry.magazine.emplace(author, title, publisher, entry.issn, stock, Utils::daysToDate(days), price);
+        entry.magazine->borrowedCopies = borrowedCopies;
+        break;
+    }
+    default:
+        return false;
+    }
+    entries.push_back(std::move(entry));
+    return true;
+}
+
+Journal::~Journal()
+{
+    close();
+}
+
+bool Journal::create(const std::string &name, std::uint64_t base, const std::string &records)
+{
+    std::string header(journalMagic, sizeof(journalMagic));
+    put<std::uint32_t>(header, journalVersion);
+    put<std::uint32_t>(header, 0);
+    put<std::uint64_t>(header, base);
+
+    int file = journalOpen(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | JOURNAL_FLAGS, 0644);
+    if (file < 0)
+    {
+        return false;
+    }
+    bool written = writeAll(file, header.data(), header.size()) && writeAll(file, records.data(), records.size()) &&
+                   journalSync(file) == 0;
+    journalClose(file);
+    return written;
+}
+
+std::size_t Journal::read(const std::string &name, std::uint64_t base, std::vector<JournalEntry> &entries)
+{
+    MappedFile existing;
+    if (!existing.open(name) || existing.size() < headerSize || std::memcmp(existing.data(), journalMagic, sizeof(journalMagic)) != 0)
+    {
+        return 0;
+    }
+    const char *data = existing.data();
+    std::uint32_t version;
+    std::uint64_t journalBase;
+    std::memcpy(&version, data + 8, sizeof(version));
+    std::memcpy(&journalBase, data + 16, sizeof(journalBase));
+    if (version != journalVersion || journalBase != base)
+    {
+        return 0;
+    }
+    std::size_t validSize = headerSize;
+    while (existing.size() - validSize >= recordHeaderSize)
+    {
+        const char *record = data + validSize;
+        std::uint32_t payloadSize;
+        std::memcpy(&payloadSize, record + 1, sizeof(payloadSize));
+        std::size_t recordSize = recordHeaderSize + static_cast<std::size_t>(payloadSize) + sizeof(std::uint64_t);
+        if (existing.size() - validSize < recordSize)
+        {
+            break;
+        }
+        std::uint64_t storedChecksum;
+        std::memcpy(&storedChecksum, record + recordSize - sizeof(storedChecksum), sizeof(storedChecksum));
+        if (storedChecksum != Utils::checksum(record, recordHeaderSize + payloadSize) ||
+            !decode(static_cast<JournalOperation>(record[0]), record + recordHeaderSize, record + recordHeaderSize + payloadSize, entries))
+        {
+            break;
+        }
+        validSize += recordSize;
+    }
+    return validSize;
+}
+
+bool Journal::open(const std::string &name, std::uint64_t base, std::size_t groupSize, std::vector<JournalEntry> &entries)
+{
+    close();
+    filename = name;
+    groupCommitSize = groupSize > 0 ? groupSize : 1;
+
+    // Read all complete records of a journal that belongs to the loaded database file. If the program stopped
+    // between installing a compacted database file and its journal, the new journal is still waiting next to the old one.
+    std::size_t validSize = read(name, base, entries);
+    if (validSize == 0)
+    {
+        entries.clear();
+        validSize = read(name + ".tmp", base, entries);
+        if (validSize > 0 && std::rename((name + ".tmp").c_str(), name.c_str()) != 0)
+        {
+            return false;
+        }
+    }
+
+    if (validSize == 0 && !create(name, base))
+    {
+        return false;
+    }
+    fd = journalOpen(name.c_str(), O_WRONLY | O_APPEND | JOURNAL_FLAGS);
+    if (fd < 0)
+    {
+        return false;
+    }
+    // Drop a partly written record, so new records follow the last complete one
+    if (validSize > 0 && journalTruncate(fd, static_cast<long>(validSize)) != 0)
+    {
+        close();
+        return false;
+    }
+    fileSize = validSize > 0 ? validSize : headerSize;
+    return true;
+}
+
+bool Journal::append(JournalOperation operation, const std::string &payload, std::size_t operations)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t start = pending.size();
+    pending += static_cast<char>(operation);
+    put<std::uint32_t>(pending, static_cast<std::uint32_t>(payload.size()));
+    pending += payload;
+    put<std::uint64_t>(pending, Utils::checksum(pending.data() + start, pending.size() - start));
+    if (rotating)
+    {
+        carried.append(pending, start, std::string::npos);
+    }
+    pendingOperations += operations;
+    if (pendingOperations >= groupCommitSize && !deferred)
+    {
+        return flush();
+    }
+    return true;
+}
+
+bool Journal::logAdd(const Magazine &magazine)
+{
+    std::string payload;
+    put<std::uint32_t>(payload, Utils::packISSN(magazine.issn));
+    put<std::int32_t>(payload, Utils::dateToDays(magazine.publicationDate));
+    put<std::int32_t>(payload, magazine.stock);
+    put<std::int32_t>(payload, magazine.borrowedCopies);
+    put<double>(payload, magazine.price);
+    putString(payload, magazine.author);
+    putString(payload, magazine.title);
+    putString(payload, magazine.publisher);
+    return append(JournalOperation::Add, payload);
+}
+
+bool Journal::logBorrow(const std::string &issn)
+{
+    std::string payload;
+    put<std::uint32_t>(payload, Utils::packISSN(issn));
+    return append(JournalOperation::Borrow, payload);
+}
+
+bool Journal::logReturn(const std::string &issn)
+{
+    std::string payload;
+    put<std::uint32_t>(payload, Utils::packISSN(issn));
+    return append(JournalOperation::Return, payload);
+}
+
+bool Journal::logIncreaseStock(const std::string &issn, int amount)
+{
+    std::string payload;
+    put<std::uint32_t>(payload, Utils::packISSN(issn));
+    put<std::int32_t>(payload, amount);
+    return append(JournalOperation::IncreaseStock, payload);
+}
+
+bool Journal::logCopyBatch(const std::vector<JournalEntry> &changes)
+{
+    std::string payload;
+    put<std::uint32_t>(payload, static_cast<std::uint32_t>(changes.size()));
+    for (const JournalEntry &change : changes)
+    {
+        put<std::uint8_t>(payload, static_cast<std::uint8_t>(change.operation));
+        put<std::uint32_t>(payload, Utils::packISSN(change.issn));
+        put<std::int32_t>(payload, change.amount);
+    }
+    return append(JournalOperation::CopyBatch, payload, changes.size());
+}
+
+bool Journal::commit()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return flush();
+}
+
+void Journal::deferCommits()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    deferred = true;
+}
+
+bool Journal::resumeCommits()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    deferred = false;
+    return flush();
+}
+
+bool Journal::flush()
+{
+    if (fd < 0 || pending.empty())
+    {
+        return fd >= 0;
+    }
+    if (!writeAll(fd, pending.data(), pending.size()) || journalSync(fd) != 0)
+    {
+        // Later records must not follow a torn one, since reading stops at the first bad checksum
+        if (journalTruncate(fd, static_cast<long>(fileSize)) != 0)
+        {
+            journalClose(fd);
+            fd = -1;
+        }
+        return false;
+    }
+    fileSize += pending.size();
+    pending.clear();
+    pendingOperations = 0;
+    return true;
+}
+
+void Journal::beginRotation()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    rotating = true;
+    carried.clear();
+}
+
+bool Journal::finishRotation(std::uint64_t base, const std::function<bool()> &installDatabase)
+{
+    // Holding the mutex keeps every operation out of the window between the two renames
+    std::lock_guard<std::mutex> lock(mutex);
+    rotating = false;
+    std::string temporary = filename + ".tmp";
+    bool created = create(temporary, base, carried);
+    std::size_t temporarySize = headerSize + carried.size();
+    carried.clear();
+    if (!created || !installDatabase())
+    {
+        return false;
+    }
+
+    // Pending operations are either part of the new database file or were carried over
+    pending.clear();
+    pendingOperations = 0;
+    if (fd >= 0)
+    {
+        journalClose(fd);
+        fd = -1;
+    }
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+    {
+        return false;
+    }
+    fd = journalOpen(filename.c_str(), O_WRONLY | O_APPEND | JOURNAL_FLAGS);
+    fileSize = temporarySize;
+    return fd >= 0;
+}
+
+void Journal::cancelRotation()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    rotating = false;
+    carried.clear();
+}
+
+void Journal::close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0)
+    {
+        flush();
+        journalClose(fd);
+        fd = -1;
+    }
+}
+
+bool Journal::syncFile(const std::string &name)
+{
+    int file = journalOpen(name.c_str(), O_RDONLY | JOURNAL_FLAGS);
+    if (file < 0)
+    {
+        return false;
+    }
+    bool synced = journalSync(file) == 0;
+    journalClose(file);
+    return synced;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file journal.hpp
+ * @brief File containing the declaration of the Journal class.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "magazine.hpp"
+
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+/**
+ * @brief The operations recorded in the journal.
+ */
+enum class JournalOperation : std::uint8_t
+{
+    Add = 1,  ///< A new magazine was added.
+    Borrow = 2,  ///< A copy of a magazine was borrowed.
+    Return = 3,  ///< A copy of a magazine was returned.
+    IncreaseStock = 4,  ///< The stock of a magazine was increased.
+    CopyBatch = 5  ///< Several borrows, returns and stock increases that were applied together, read back as separate entries.
+};
+
+/**
+ * @struct JournalEntry
+ * @brief An operation read back from the journal.
+ */
+struct JournalEntry
+{
+    JournalOperation operation;  ///< The recorded operation.
+    std::string issn;  ///< The ISSN of the magazine the operation applies to.
+    int amount;  ///< The amount the stock was increased by, only used by IncreaseStock.
+    std::optional<Magazine> magazine;  ///< The added magazine, only set for Add.
+};
+
+/**
+ * @class Journal
+ * @brief An append-only write-ahead log of all changes to the library.
+ *
+ * @details Every change is appended as a small binary record, so persisting an operation costs the same no matter
+ * how large the catalogue is. Records are collected in memory and written and flushed to disk together once the
+ * configured group commit size is reached; a size of 1 makes every operation durable before it returns.
+ *
+ * The journal header stores a fingerprint of the database file it was started on. When the library is compacted,
+ * a new database file and a new journal are written first and then renamed into place, the database file first.
+ * If the program stops between the two renames, the old journal no longer matches the database file and is ignored
+ * instead of being applied twice, and the new journal, still named like the journal followed by .tmp, is used instead.
+ * Each record carries a checksum, so a record that was only partly written is detected and dropped.
+ *
+ * Operations may be recorded from several threads at once. Records are appended in the order the calls acquire
+ * the journal, which is not necessarily the order in which the changes were applied, see MagazineStore::adjustCopies().
+ */
+class Journal
+{
+private:
+    std::string filename;  ///< The name of the journal file.
+    int fd = -1;  ///< The descriptor of the open journal file, -1 if closed.
+    std::size_t groupCommitSize = 1;  ///< The number of operations collected before they are written.
+    std::size_t pendingOperations = 0;  ///< The number of operations waiting in pending.
+    std::size_t fileSize = 0;  ///< The size of the journal file up to the last record that is on disk.
+    std::string pending;  ///< Encoded operations that have not been written yet.
+    bool deferred = false;  ///< Whether the group commit size is ignored until resumeCommits().
+    bool rotating = false;  ///< Whether operations are also collected in carried, see beginRotation().
+    std::string carried;  ///< Encoded operations recorded since beginRotation().
+    std::mutex mutex;  ///< Serializes appending and writing.
+
+    /**
+     * @brief Encodes a record and adds it to the pending operations.
+     *
+     * @param operation The recorded operation.
+     * @param payload The encoded arguments of the operation.
+     * @param operations The number of operations the record stands for, counted towards the group commit size.
+     * @return false if the pending operations were due to be written and writing failed, true otherwise.
+     */
+    bool append(JournalOperation operation, const std::string &payload, std::size_t operations = 1);
+
+    /**
+     * @brief Writes all pending operations and flushes them to disk. The caller must hold the mutex.
+     *
+     * If writing or flushing fails, the file is cut back to its size before, so no partly written record is
+     * followed by later ones, and the operations stay pending for the next attempt.
+     * @return true if all operations are on disk, false if writing failed.
+     */
+    bool flush();
+
+    /**
+     * @brief Creates a journal file.
+     *
+     * @param name The name of the file to create.
+     * @param base The fingerprint of the database file the journal belongs to.
+     * @param records Encoded operations to write after the header.
+     * @return true if the file was written and flushed to disk, false otherwise.
+     */
+    static bool create(const std::string &name, std::uint64_t base, const std::string &records = std::string());
+
+    /**
+     * @brief Reads the complete records of a journal file.
+     *
+     * @param name The name of the journal file.
+     * @param base The fingerprint of the loaded database file.
+     * @param entries Receives the recorded operations.
+     * @return The size of the header and all complete records, 0 if the file is missing or belongs to a different
+     * database file.
+     */
+    static std::size_t read(const std::string &name, std::uint64_t base, std::vector<JournalEntry> &entries);
+
+public:
+    Journal() = default;
+    Journal(const Journal &) = delete;
+    Journal &operator=(const Journal &) = delete;
+
+    /**
+     * @brief Writes all pending operations and closes the journal.
+     */
+    ~Journal();
+
+    /**
+     * @brief Opens a journal and reads the operations recorded since the database file was written.
+     *
+     * If the file does not exist or belongs to a different database file, a new empty journal is started.
+     * A partly written record at the end of the file is removed.
+     * @param name The name of the journal file.
+     * @param base The fingerprint of the loaded database file, see Libary::loadFromFile().
+     * @param groupSize The number of operations to collect before writing them to disk, at least 1.
+     * @param entries Receives the recorded operations in the order they happened.
+     * @return true if the journal is ready for appending, false if the file cannot be written.
+     */
+    bool open(const std::string &name, std::uint64_t base, std::size_t groupSize, std::vector<JournalEntry> &entries);
+
+    /**
+     * @brief Checks whether the journal is open.
+     * @return true if operations are being recorded, false otherwise.
+     */
+    bool isOpen() const { return fd >= 0; }
+
+    /**
+     * @brief Records that a magazine was added.
+     * @param magazine The added magazine.
+     * @return false if the operations were due to be written and writing failed. They then stay pending and are
+     * written by the next commit().
+     */
+    bool logAdd(const Magazine &magazine);
+
+    /**
+     * @brief Records that a copy of a magazine was borrowed.
+     * @param issn The ISSN of the magazine.
+     * @return false if the operations were due to be written and writing failed. They then stay pending and are
+     * written by the next commit().
+     */
+    bool logBorrow(const std::string &issn);
+
+    /**
+     * @brief Records that a copy of a magazine was returned.
+     * @param issn The ISSN of the magazine.
+     * @return false if the operations were due to be written and writing failed. They then stay pending and are
+     * written by the next commit().
+     */
+    bool logReturn(const std::string &issn);
+
+    /**
+     * @brief Records that the stock of a magazine was increased.
+     * @param issn The ISSN of the magazine.
+     * @param amount The amount the stock was increased by.
+     * @return false if the operations were due to be written and writing failed. They then stay pending and are
+     * written by the next commit().
+     */
+    bool logIncreaseStock(const std::string &issn, int amount);
+
+    /**
+     * @brief Records several borrows, returns and stock increases that were applied together, see Libary::changeCopies().
+     *
+     * They are written as a single record with a single checksum, so after a crash either all of them are replayed
+     * or none.
+     * @param changes The changes, each a Borrow, Return or IncreaseStock entry without magazine.
+     * @return false if the operations were due to be written and writing failed. They then stay pending and are
+     * written by the next commit().
+     */
+    bool logCopyBatch(const std::vector<JournalEntry> &changes);
+
+    /**
+     * @brief Writes all pending operations and flushes them to disk.
+     * @return true if all operations are on disk, false if writing failed.
+     */
+    bool commit();
+
+    /**
+     * @brief Collects all following operations in memory until resumeCommits(), however many there are.
+     *
+     * Lets a bulk change such as Libary::mergeMagazines() write its operations with a single flush.
+     */
+    void deferCommits();
+
+    /**
+     * @brief Returns to the configured group commit size and writes all pending operations.
+     * @return true if all operations are on disk, false if writing failed.
+     */
+    bool resumeCommits();
+
+    /**
+     * @brief Starts carrying all following operations over into the journal of a new database file.
+     *
+     * Call this at the instant the state for the new database file is taken, see Libary::compact(). Operations
+     * recorded afterwards are still appended to the current journal, and are also kept for the new one.
+     */
+    void beginRotation();
+
+    /**
+     * @brief Replaces the journal with one for a new database file that holds the operations since beginRotation().
+     *
+     * The new journal is written and flushed next to the current one, then the new database file is installed,
+     * then the new journal is renamed into place. No operation is recorded in between, so none is lost.
+     * @param base The fingerprint of the new database file.
+     * @param installDatabase Renames the new database file into place and returns whether that worked.
+     * @return true if the new database file and journal are in place and open, false otherwise. If the database
+     * file was not installed, the current journal stays in use.
+     */
+    bool finishRotation(std::uint64_t base, const std::function<bool()> &installDatabase);
+
+    /**
+     * @brief Stops carrying operations over after the new database file could not be written.
+     */
+    void cancelRotation();
+
+    /**
+     * @brief Writes all pending operations and closes the journal. Does nothing if the journal is not open.
+     */
+    void close();
+
+    /**
+     * @brief Flushes a file to disk.
+     * @param name The name of the file.
+     * @return true if the file is on disk, false otherwise.
+     */
+    static bool syncFile(const std::string &name);
+};
+
+#endif // JOURNAL_HPP
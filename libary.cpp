@@ -6,68 +6,561 @@
 #include "libary.hpp"
 #include "handlers.hpp"
 #include "utils.hpp"
+#include "mappedfile.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 
-void Libary::addMagazine(const Magazine &magazine)
+/**
+ * @brief The number of magazines mergeMagazines() merges while holding the lock exclusively.
+ */
+static const std::size_t mergeGroupSize = 4096;
+
+bool Libary::findRow(const std::string &issn, std::uint32_t &row) const
+{
+    std::uint32_t packed;
+    if (Utils::parseISSN(issn, packed) == ISSNStatus::Malformed)
+    {
+        return false;
+    }
+    return issnIndex.find(packed, row);
+}
+
+void Libary::indexRow(std::uint32_t row)
+{
+    issnIndex.insert(store.issn(row), row);
+    indexFields(row);
+}
+
+void Libary::indexFields(std::uint32_t row)
+{
+    int stock, borrowed;
+    store.copiesOf(row, stock, borrowed);
+    inventory.add(store.publisherId(row), stock, borrowed, store.priceCents(row));
+    ranking.add(stock, borrowed);
+    if (!loading)
+    {
+        titleIndex.add(row, store.title(row));
+        if (trigramsIndexed)
+        {
+            trigramIndex.add(row, store.title(row));
+        }
+        dateIndex.add(RangeIndex::sortable(store.date(row)), row);
+        priceIndex.add(store.priceCents(row), row);
+    }
+}
+
+void Libary::indexAll(bool rows)
+{
+    auto indexTitles = [this]()
+    {
+        titleIndex.assign(store.size(), [this](std::uint32_t row)
+                          { return store.title(row); });
+    };
+    // The title index only reads the store and shares nothing with the other indexes, so it is built alongside them
+    std::thread titles;
+    if (std::thread::hardware_concurrency() > 1)
+    {
+        titles = std::thread(indexTitles);
+    }
+    else
+    {
+        indexTitles();
+    }
+    if (rows)
+    {
+        issnIndex.reserve(store.size());
+        for (std::uint32_t row = 0; row < store.size(); ++row)
+        {
+            indexRow(row);
+        }
+    }
+    dateIndex.assign(store.size(), [this](std::uint32_t row)
+                     { return RangeIndex::sortable(store.date(row)); });
+    priceIndex.assign(store.size(), [this](std::uint32_t row)
+                      { return store.priceCents(row); });
+    if (titles.joinable())
+    {
+        titles.join();
+    }
+}
+
+std::vector<Magazine> Libary::magazinesOf(const std::vector<std::uint32_t> &rows) const
+{
+    std::vector<Magazine> magazines;
+    magazines.reserve(rows.size());
+    for (std::uint32_t row : rows)
+    {
+        magazines.push_back(store.get(row));
+    }
+    return magazines;
+}
+
+bool Libary::insertRecord(const MagazineRecord &record)
+{
+    if (issnIndex.contains(record.issn))
+    {
+        return false;
+    }
+    indexRow(store.append(record));
+    return true;
+}
+
+bool Libary::insertMagazine(const Magazine &magazine)
+{
+    if (!Utils::isValidISSN(magazine.issn) || !MagazineStore::fits(magazine) || issnIndex.contains(Utils::packISSN(magazine.issn)))
+    {
+        return false;
+    }
+    indexRow(store.append(magazine));
+    if (journaling)
+    {
+        journal.logAdd(magazine);
+    }
+    return true;
+}
+
+bool Libary::addMagazine(const Magazine &magazine)
 {
-    magazines.push_back(magazine);
+    OperationTimer timer(Operation::AddMagazine);
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return insertMagazine(magazine);
 }
 
 bool Libary::magazineExists(const std::string &issn)
 {
-    for (const Magazine &magazine : magazines)
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::uint32_t row;
+    return findRow(issn, row);
+}
+
+bool Libary::increaseStock(const std::string &issn, int increaseAmount)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::uint32_t row;
+    if (!findRow(issn, row) || !store.increaseStock(row, increaseAmount))
     {
-        if (magazine.issn == issn)
+        return false;
+    }
+    inventory.change(store.publisherId(row), increaseAmount, 0, store.priceCents(row));
+    ranking.markChanged(row);
+    if (journaling)
+    {
+        journal.logIncreaseStock(issn, increaseAmount);
+    }
+    return true;
+}
+
+std::vector<MergeOutcome> Libary::mergeMagazines(const std::vector<Magazine> &magazines)
+{
+    std::vector<MergeOutcome> outcomes;
+    outcomes.reserve(magazines.size());
+    for (std::size_t first = 0; first < magazines.size(); first += mergeGroupSize)
+    {
+        std::size_t last = std::min(magazines.size(), first + mergeGroupSize);
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (first == 0)
+        {
+            // Growing the index once is cheaper than rehashing it several times along the way
+            issnIndex.reserve(issnIndex.size() + magazines.size());
+        }
+        if (journaling)
+        {
+            journal.deferCommits();
+        }
+        for (std::size_t i = first; i < last; ++i)
+        {
+            const Magazine &magazine = magazines[i];
+            if (!Utils::isValidISSN(magazine.issn) || !MagazineStore::fits(magazine))
+            {
+                outcomes.push_back(MergeOutcome::Invalid);
+                continue;
+            }
+            // The row is only known after appending, but the store always appends at its end
+            std::uint32_t row = issnIndex.insert(Utils::packISSN(magazine.issn), store.size());
+            if (row == store.size())
+            {
+                indexFields(store.append(magazine));
+                if (journaling)
+                {
+                    journal.logAdd(magazine);
+                }
+                outcomes.push_back(MergeOutcome::Added);
+            }
+            else if (store.increaseStock(row, magazine.stock))
+            {
+                inventory.change(store.publisherId(row), magazine.stock, 0, store.priceCents(row));
+                ranking.markChanged(row);
+                if (journaling)
+                {
+                    journal.logIncreaseStock(magazine.issn, magazine.stock);
+                }
+                outcomes.push_back(MergeOutcome::StockIncreased);
+            }
+            else
+            {
+                outcomes.push_back(MergeOutcome::StockExceeded);
+            }
+        }
+        if (journaling)
         {
-            return true;
+            journal.resumeCommits();
         }
     }
-    return false;
+    return outcomes;
 }
 
-void Libary::increaseStock(const std::string &issn, int increaseAmount)
+std::vector<CopyResult> Libary::changeCopies(const std::vector<CopyChange> &changes)
 {
-    for (Magazine &magazine : magazines)
+    // The changes of one magazine: their range in order, and its copies before and after them
+    struct Group
     {
-        if (magazine.issn == issn)
+        std::size_t first, last;
+        std::uint32_t row;
+        int stockBefore, borrowedBefore, stock, borrowedCopies;
+    };
+
+    std::vector<CopyResult> results(changes.size());
+    // Sorting by ISSN and then position groups the changes of a magazine and keeps their order
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> order;
+    order.reserve(changes.size());
+    bool possible = true;
+    for (std::uint32_t i = 0; i < changes.size(); ++i)
+    {
+        std::uint32_t packed;
+        if (Utils::parseISSN(changes[i].issn, packed) == ISSNStatus::Malformed)
+        {
+            possible = false;
+        }
+        else
+        {
+            order.emplace_back(packed, i);
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<Group> groups;
+    for (std::size_t first = 0; first < order.size();)
+    {
+        std::size_t last = first + 1;
+        while (last < order.size() && order[last].first == order[first].first)
+        {
+            ++last;
+        }
+        Group group{first, last, 0, 0, 0, 0, 0};
+        first = last;
+        if (!issnIndex.find(order[group.first].first, group.row))
+        {
+            possible = false;
+            continue;
+        }
+        store.copiesOf(group.row, group.stockBefore, group.borrowedBefore);
+        group.stock = group.stockBefore;
+        group.borrowedCopies = group.borrowedBefore;
+        // A failed change leaves the copies as they are for the following changes of the magazine
+        for (std::size_t i = group.first; i < group.last; ++i)
         {
-            magazine.stock += increaseAmount;
-            break;
+            const CopyChange &change = changes[order[i].second];
+            CopyResult &result = results[order[i].second];
+            if (change.action == CopyAction::Borrow)
+            {
+                result.outcome = group.borrowedCopies < group.stock ? CopyOutcome::Applied : CopyOutcome::NoCopiesLeft;
+                group.borrowedCopies += result.outcome == CopyOutcome::Applied ? 1 : 0;
+            }
+            else if (change.action == CopyAction::Return)
+            {
+                result.outcome = group.borrowedCopies > 0 ? CopyOutcome::Applied : CopyOutcome::NothingBorrowed;
+                group.borrowedCopies -= result.outcome == CopyOutcome::Applied ? 1 : 0;
+            }
+            else
+            {
+                long long stock = static_cast<long long>(group.stock) + change.amount;
+                result.outcome = stock >= group.borrowedCopies && stock <= MagazineStore::maxCopies ? CopyOutcome::Applied : CopyOutcome::StockExceeded;
+                group.stock = result.outcome == CopyOutcome::Applied ? static_cast<int>(stock) : group.stock;
+            }
+            possible = possible && result.outcome == CopyOutcome::Applied;
+            result.stock = group.stock;
+            result.borrowedCopies = group.borrowedCopies;
         }
+        groups.push_back(group);
     }
+
+    if (!possible)
+    {
+        for (const Group &group : groups)
+        {
+            for (std::size_t i = group.first; i < group.last; ++i)
+            {
+                CopyResult &result = results[order[i].second];
+                result.outcome = result.outcome == CopyOutcome::Applied ? CopyOutcome::Discarded : result.outcome;
+                result.stock = group.stockBefore;
+                result.borrowedCopies = group.borrowedBefore;
+            }
+        }
+        return results;
+    }
+
+    // Nobody else holds the lock, so the net change of every magazine can be applied without checks
+    std::vector<JournalEntry> logged;
+    logged.reserve(journaling ? order.size() : 0);
+    for (const Group &group : groups)
+    {
+        int stockChange = group.stock - group.stockBefore;
+        int borrowedChange = group.borrowedCopies - group.borrowedBefore;
+        store.adjustCopies(group.row, stockChange, borrowedChange);
+        inventory.change(store.publisherId(group.row), stockChange, borrowedChange, store.priceCents(group.row));
+        ranking.markChanged(group.row);
+        for (std::size_t i = group.first; journaling && i < group.last; ++i)
+        {
+            const CopyChange &change = changes[order[i].second];
+            JournalOperation operation = change.action == CopyAction::Borrow ? JournalOperation::Borrow
+                                         : change.action == CopyAction::Return ? JournalOperation::Return
+                                                                               : JournalOperation::IncreaseStock;
+            logged.push_back({operation, change.issn, change.action == CopyAction::IncreaseStock ? change.amount : 0, std::nullopt});
+        }
+    }
+    if (journaling && !logged.empty())
+    {
+        journal.logCopyBatch(logged);
+    }
+    return results;
 }
 
-std::vector<Magazine *> Libary::searchByTitle(const std::string &title)
+std::vector<Magazine> Libary::searchByTitle(const std::string &title)
 {
-    std::vector<Magazine *> matchingMagazines;
-    for (Magazine &magazine : magazines)
+    OperationTimer timer(Operation::SearchByTitle);
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::vector<Magazine> matchingMagazines;
+    for (std::uint32_t row : titleIndex.search(title))
     {
-        if (magazine.title == title)
+        matchingMagazines.push_back(store.get(row));
+    }
+    return matchingMagazines;
+}
+
+std::vector<TitleSuggestion> Libary::suggestByTitle(const std::string &title, std::size_t maxResults)
+{
+    std::string query = TrigramIndex::normalize(title);
+    // The normalized query is padded with a space on both sides
+    int letters = static_cast<int>(query.size()) - 2;
+    if (letters < 4)
+    {
+        return {};
+    }
+    int maxDistance = letters < 8 ? 1 : (letters < 16 ? 2 : 3);
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    {
+        // The shared lock keeps the titles from changing while the index is built, and once built it only changes
+        // with the lock held exclusively
+        std::lock_guard<std::mutex> guard(trigramMutex);
+        if (!trigramsIndexed)
         {
-            matchingMagazines.push_back(&magazine);
+            trigramIndex.assign(store.size(), [this](std::uint32_t row)
+                                { return store.title(row); });
+            trigramsIndexed = true;
+        }
+    }
+
+    struct Candidate
+    {
+        std::uint32_t row;
+        int distance;
+        std::size_t lengthDifference;
+    };
+    std::vector<Candidate> candidates;
+    for (std::uint32_t row : trigramIndex.candidates(title, maxDistance))
+    {
+        std::string_view candidateTitle = store.title(row);
+        int distance = TrigramIndex::boundedDistance(query, TrigramIndex::normalize(candidateTitle), maxDistance);
+        if (distance <= maxDistance)
+        {
+            std::size_t lengthDifference = candidateTitle.size() > title.size() ? candidateTitle.size() - title.size() : title.size() - candidateTitle.size();
+            candidates.push_back({row, distance, lengthDifference});
+        }
+    }
+
+    // Prefer fewer typos, then titles whose length is closest to the search
+    std::size_t count = std::min(maxResults, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](const Candidate &a, const Candidate &b)
+                      { return a.distance != b.distance ? a.distance < b.distance : a.lengthDifference < b.lengthDifference; });
+    std::vector<TitleSuggestion> suggestions;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        suggestions.push_back({store.get(candidates[i].row), candidates[i].distance});
+    }
+    return suggestions;
+}
+
+std::optional<Magazine> Libary::searchByISSN(const std::string &issn)
+{
+    OperationTimer timer(Operation::SearchByISSN);
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::uint32_t row;
+    if (!findRow(issn, row))
+    {
+        return std::nullopt;
+    }
+    return store.get(row);
+}
+
+std::optional<MagazineHandle> Libary::handleOf(const std::string &issn) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::uint32_t row;
+    if (!findRow(issn, row))
+    {
+        return std::nullopt;
+    }
+    return MagazineHandle{row, generation};
+}
+
+bool Libary::isValid(MagazineHandle handle) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return handle.generation == generation && handle.row < store.size();
+}
+
+std::optional<Magazine> Libary::get(MagazineHandle handle) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (handle.generation != generation || handle.row >= store.size())
+    {
+        return std::nullopt;
+    }
+    return store.get(handle.row);
+}
+
+std::vector<Magazine> Libary::listAvailable()
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::vector<Magazine> available;
+    for (std::uint32_t row : store.availableRows())
+    {
+        available.push_back(store.get(row));
+    }
+    return available;
+}
+
+std::vector<Magazine> Libary::mostBorrowed(std::size_t count)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return magazinesOf(ranking.mostBorrowed(store, count));
+}
+
+std::vector<Magazine> Libary::leastAvailable(int maximumAvailable, std::size_t limit)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return magazinesOf(ranking.leastAvailable(store, maximumAvailable, limit));
+}
+
+std::vector<Magazine> Libary::searchByAuthor(const std::string &author)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::vector<Magazine> matchingMagazines;
+    std::uint32_t id;
+    if (store.findName(author, id))
+    {
+        for (std::uint32_t row : store.rowsWithAuthor(id))
+        {
+            matchingMagazines.push_back(store.get(row));
         }
     }
     return matchingMagazines;
 }
 
-Magazine *Libary::searchByISSN(const std::string &issn)
+std::vector<Magazine> Libary::searchByPublisher(const std::string &publisher)
 {
-    for (Magazine &magazine : magazines)
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::vector<Magazine> matchingMagazines;
+    std::uint32_t id;
+    if (store.findName(publisher, id))
     {
-        if (magazine.issn == issn)
+        for (std::uint32_t row : store.rowsWithPublisher(id))
         {
-            return &magazine;
+            matchingMagazines.push_back(store.get(row));
         }
     }
-    return nullptr;
+    return matchingMagazines;
+}
+
+std::vector<Magazine> Libary::searchByDate(const std::string &from, const std::string &to)
+{
+    std::int32_t first, last;
+    if (!Utils::parseDate(from, first) || !Utils::parseDate(to, last))
+    {
+        return {};
+    }
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return magazinesOf(dateIndex.range(RangeIndex::sortable(first), RangeIndex::sortable(last)));
+}
+
+std::vector<Magazine> Libary::searchByPrice(double minimum, double maximum)
+{
+    if (!(maximum >= 0.0) || !(minimum <= maximum))
+    {
+        return {};
+    }
+    // Prices that cannot be stored are clamped, so open ranges like "under 5 Euro" can be given with extreme bounds
+    std::uint32_t low = minimum <= 0.0 ? 0 : MagazineStore::toCents(std::min(minimum, 40000000.0));
+    std::uint32_t high = MagazineStore::toCents(std::min(maximum, 40000000.0));
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return magazinesOf(priceIndex.range(low, high));
+}
+
+InventoryFigures Libary::inventoryTotals() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return inventory.total();
+}
+
+std::optional<InventoryFigures> Libary::publisherTotals(const std::string &publisher) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::uint32_t id;
+    if (!store.findName(publisher, id))
+    {
+        return std::nullopt;
+    }
+    InventoryFigures figures = inventory.publisher(id);
+    if (figures.magazines == 0)
+    {
+        return std::nullopt;
+    }
+    return figures;
+}
+
+bool Libary::verifyInventoryTotals() const
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    InventoryTotals recomputed;
+    recomputed.recompute(store);
+    return inventory.matches(recomputed);
+}
+
+std::size_t Libary::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return store.size();
 }
 
 bool Libary::borrowMagazine(Magazine &magazine)
 {
-    if (magazine.stock > magazine.borrowedCopies)
+    OperationTimer timer(Operation::BorrowMagazine);
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::uint32_t row;
+    int borrowedCopies;
+    if (findRow(magazine.issn, row) && store.borrow(row, borrowedCopies))
     {
-        magazine.borrowedCopies++;
+        inventory.change(store.publisherId(row), 0, 1, store.priceCents(row));
+        ranking.markChanged(row);
+        magazine.borrowedCopies = borrowedCopies;
+        if (journaling)
+        {
+            journal.logBorrow(magazine.issn);
+        }
         return true;
     }
     else
@@ -78,9 +571,19 @@ bool Libary::borrowMagazine(Magazine &magazine)
 
 bool Libary::returnMagazine(Magazine &magazine)
 {
-    if (magazine.borrowedCopies > 0)
+    OperationTimer timer(Operation::ReturnMagazine);
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::uint32_t row;
+    int borrowedCopies;
+    if (findRow(magazine.issn, row) && store.giveBack(row, borrowedCopies))
     {
-        magazine.borrowedCopies--;
+        inventory.change(store.publisherId(row), 0, -1, store.priceCents(row));
+        ranking.markChanged(row);
+        magazine.borrowedCopies = borrowedCopies;
+        if (journaling)
+        {
+            journal.logReturn(magazine.issn);
+        }
         return true;
     }
     else
@@ -91,53 +594,277 @@ bool Libary::returnMagazine(Magazine &magazine)
 
 void Libary::saveToFile(const std::string &filename)
 {
-    std::ofstream file(filename);
-    for (const Magazine &magazine : magazines)
+    saveToFile(filename, getFileFormat());
+}
+
+void Libary::saveToFile(const std::string &filename, FileFormat format)
+{
+    OperationTimer timer(Operation::SaveToFile);
+    view().saveToFile(filename, format);
+}
+
+LibaryView Libary::view()
+{
+    // Readers may keep a waiting exclusive lock out for as long as they keep coming, so it is only taken if it is free
+    std::unique_lock<std::shared_mutex> exclusive(mutex, std::try_to_lock);
+    if (exclusive.owns_lock())
     {
-        file << magazine.author << "\n"
-             << magazine.title << "\n"
-             << magazine.publisher << "\n"
-             << magazine.issn << "\n"
-             << magazine.stock << "\n"
-             << magazine.publicationDate << "\n"
-             << magazine.price << "\n"
-             << magazine.borrowedCopies << "\n"; // Save borrowedCopies
+        store.releaseRetired();
+        return LibaryView(store.snapshot());
     }
-    file.close();
+    std::shared_lock<std::shared_mutex> shared(mutex);
+    return LibaryView(store.snapshot());
+}
+
+void Libary::setFileFormat(FileFormat format)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    fileFormat = format;
+}
+
+FileFormat Libary::getFileFormat() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return fileFormat;
+}
+
+void Libary::clearMagazines()
+{
+    ++generation;
+    store.clear();
+    issnIndex.clear();
+    titleIndex.clear();
+    trigramIndex.clear();
+    trigramsIndexed = false;
+    dateIndex.clear();
+    priceIndex.clear();
+    inventory.clear();
+    ranking.clear();
 }
 
 bool Libary::loadFromFile(const std::string &filename)
 {
-    std::ifstream file(filename);
-    std::string author, title, publisher, issn, publicationDate;
-    int stock, borrowedCopies;
-    double price;
-    while (std::getline(file, author) &&
-           std::getline(file, title) &&
-           std::getline(file, publisher) &&
-           std::getline(file, issn) &&
-           file >> stock &&
-           file >> publicationDate &&
-           file >> price &&
-           file >> borrowedCopies)
-    {
-        if (Utils::containsValidChars(author) &&
-            Utils::containsValidChars(title) &&
-            Utils::containsValidChars(publisher) &&
-            Utils::isValidISSN(issn) &&
-            Utils::isValidDate(publicationDate) &&
-            stock >= 0 && price >= 0.00 && borrowedCopies >= 0)
-        {
-            // All fields are valid, add the magazine to the library
-            magazines.push_back(Magazine(author, title, publisher, issn, stock, publicationDate, price));
-            magazines.back().borrowedCopies = borrowedCopies; // Set borrowedCopies
-             file.close();
-            return true;
-        }
-        else
+    OperationTimer timer(Operation::LoadFromFile);
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    MappedFile file;
+    if (!file.open(filename))
+    {
+        databaseFingerprint = 0;
+        return false;
+    }
+    databaseFingerprint = Utils::checksum(file.data(), file.size());
+
+    if (BinarySnapshot::isSnapshot(file.data(), file.size()))
+    {
+        MagazineStore snapshot;
+        std::string error;
+        if (!BinarySnapshot::read(file.data(), file.size(), snapshot, error))
         {
+            loadErrors = {{0, error}};
             return false;
         }
+        clearMagazines();
+        store = std::move(snapshot);
+        loading = true;
+        indexAll(true);
+        loading = false;
+        loadErrors.clear();
+        fileFormat = FileFormat::Binary;
+        return store.size() > 0;
+    }
+
+    std::vector<LoadedRecord> records;
+    std::vector<LoadError> errors;
+    // The records point into the mapped file, so it stays open until they are stored
+    TextLoader::parse(file.data(), file.size(), records, errors);
+
+    clearMagazines();
+    store.reserve(records.size());
+    issnIndex.reserve(records.size());
+    loading = true;
+    for (const LoadedRecord &loaded : records)
+    {
+        if (!insertRecord(loaded.record))
+        {
+            errors.push_back({loaded.line, "ISSN ist bereits vergeben"});
+        }
+    }
+    loading = false;
+    file.close();
+    indexAll(false);
+    std::stable_sort(errors.begin(), errors.end(), [](const LoadError &a, const LoadError &b)
+                     { return a.line < b.line; });
+    loadErrors = std::move(errors);
+    fileFormat = FileFormat::Text;
+    return store.size() > 0;
+}
+
+std::vector<LoadError> Libary::getLoadErrors() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return loadErrors;
+}
+
+bool Libary::openJournal(const std::string &filename, std::size_t groupCommitSize)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::vector<JournalEntry> entries;
+    journaling = false;
+    if (!journal.open(filename, databaseFingerprint, groupCommitSize, entries))
+    {
+        return false;
+    }
+
+    // Replayed changes are already in the journal and must not be recorded again.
+    // Concurrent changes may have been journaled in a different order than they were applied, so copies are
+    // replayed without the checks that were already done when the change happened.
+    for (const JournalEntry &entry : entries)
+    {
+        std::uint32_t row;
+        if (entry.operation == JournalOperation::Add)
+        {
+            insertMagazine(*entry.magazine);
+        }
+        else if (findRow(entry.issn, row))
+        {
+            switch (entry.operation)
+            {
+            case JournalOperation::Borrow:
+                store.adjustCopies(row, 0, 1);
+                break;
+            case JournalOperation::Return:
+                store.adjustCopies(row, 0, -1);
+                break;
+            case JournalOperation::IncreaseStock:
+                store.adjustCopies(row, entry.amount, 0);
+                break;
+            default:
+                break;
+            }
+        }
     }
-    return false;
-}
\ No newline at end of file
+    if (!entries.empty())
+    {
+        // Replayed copies may pass through out of range counts, so the totals and the ranking are built from the result instead
+        inventory.recompute(store);
+        ranking.rebuild(store);
+    }
+    journaling = true;
+    return true;
+}
+
+bool Libary::commitJournal()
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return !journaling || journal.commit();
+}
+
+bool Libary::isJournaling() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return journaling;
+}
+
+Libary::~Libary()
+{
+    waitForCompaction();
+}
+
+bool Libary::freeze(std::shared_ptr<const MagazineStore> &frozen, FileFormat &format)
+{
+    // No change may happen between freezing the store and starting to carry the journal over
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    store.releaseRetired();
+    frozen = store.snapshot();
+    format = fileFormat;
+    if (journaling)
+    {
+        journal.beginRotation();
+    }
+    return journaling;
+}
+
+bool Libary::writeCompaction(const std::string &filename, std::shared_ptr<const MagazineStore> frozen, FileFormat format, bool journaled)
+{
+    std::string temporary = filename + ".tmp";
+    MappedFile written;
+    if (!LibaryView(std::move(frozen)).saveToFile(temporary, format) || !Journal::syncFile(temporary) || !written.open(temporary))
+    {
+        if (journaled)
+        {
+            journal.cancelRotation();
+        }
+        return false;
+    }
+    std::uint64_t fingerprint = Utils::checksum(written.data(), written.size());
+    written.close();
+
+    auto installDatabase = [&temporary, &filename]
+    { return std::rename(temporary.c_str(), filename.c_str()) == 0; };
+    bool installed = journaled ? journal.finishRotation(fingerprint, installDatabase) : installDatabase();
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (journaled && !journal.isOpen())
+    {
+        journaling = false;
+    }
+    if (installed || (journaled && !journaling))
+    {
+        databaseFingerprint = fingerprint;
+    }
+    return installed;
+}
+
+bool Libary::compact(const std::string &filename)
+{
+    // Saving the database file is the usual way of saving, so it is counted as such
+    OperationTimer timer(Operation::SaveToFile);
+    std::lock_guard<std::mutex> compactionLock(compactionMutex);
+    if (compactionThread.joinable())
+    {
+        compactionThread.join();
+    }
+    std::shared_ptr<const MagazineStore> frozen;
+    FileFormat format;
+    bool journaled = freeze(frozen, format);
+    return writeCompaction(filename, std::move(frozen), format, journaled);
+}
+
+bool Libary::compactInBackground(const std::string &filename)
+{
+    std::lock_guard<std::mutex> compactionLock(compactionMutex);
+    if (compacting)
+    {
+        return false;
+    }
+    if (compactionThread.joinable())
+    {
+        compactionThread.join();
+    }
+    // The state is frozen before returning, so it does not depend on when the thread gets to run
+    std::shared_ptr<const MagazineStore> frozen;
+    FileFormat format;
+    bool journaled = freeze(frozen, format);
+    compacting = true;
+    compactionThread = std::thread([this, filename, frozen, format, journaled]() mutable
+                                   {
+                                       // Other compactions join this thread under compactionMutex before they start
+                                       compactionSucceeded = writeCompaction(filename, std::move(frozen), format, journaled);
+                                       compacting = false;
+                                   });
+    return true;
+}
+
+bool Libary::isCompacting() const
+{
+    return compacting;
+}
+
+bool Libary::waitForCompaction()
+{
+    std::lock_guard<std::mutex> compactionLock(compactionMutex);
+    if (compactionThread.joinable())
+    {
+        compactionThread.join();
+    }
+    return compactionSucceeded;
+}
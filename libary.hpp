@@ -5,37 +5,352 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <optional>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 #include "magazine.hpp"
+#include "magazinestore.hpp"
+#include "libaryview.hpp"
+#include "titleindex.hpp"
+#include "trigramindex.hpp"
+#include "rangeindex.hpp"
+#include "issnindex.hpp"
+#include "inventorytotals.hpp"
+#include "copyranking.hpp"
+#include "textloader.hpp"
+#include "snapshot.hpp"
+#include "journal.hpp"
 #include "handlers.hpp"
 #include "utils.hpp"
 
 #ifndef LIBARY_HPP
 #define LIBARY_HPP
+
+/**
+ * @struct TitleSuggestion
+ * @brief A magazine whose title is similar to a misspelled search.
+ */
+struct TitleSuggestion
+{
+    Magazine magazine;  ///< The suggested magazine.
+    int distance;  ///< The number of typos between the search and the title, lower is better.
+};
+
+/**
+ * @struct MagazineHandle
+ * @brief A reference to a magazine of a Libary that stays valid while magazines are added, see Libary::handleOf().
+ *
+ * @details Magazines are never removed and their records never move, so the row alone identifies a magazine until
+ * the library is loaded again and the rows are reused for other magazines. The generation tells these apart.
+ */
+struct MagazineHandle
+{
+    std::uint32_t row;  ///< The row of the magazine in the store.
+    std::uint32_t generation;  ///< The generation of the store the row belongs to.
+};
+
+/**
+ * @brief The result of merging a magazine into the library, see Libary::mergeMagazines().
+ */
+enum class MergeOutcome
+{
+    Added,  ///< The ISSN was new and the magazine was added.
+    StockIncreased,  ///< The ISSN existed and its stock was increased by the stock of the magazine.
+    Invalid,  ///< The ISSN is invalid or the stock or price cannot be stored, nothing was changed.
+    StockExceeded  ///< The ISSN existed, but the increased stock would exceed MagazineStore::maxCopies.
+};
+
+/**
+ * @brief The kinds of change that Libary::changeCopies() applies.
+ */
+enum class CopyAction
+{
+    Borrow,  ///< Borrows a copy, like Libary::borrowMagazine().
+    Return,  ///< Returns a copy, like Libary::returnMagazine().
+    IncreaseStock  ///< Changes the stock by an amount, like Libary::increaseStock().
+};
+
+/**
+ * @struct CopyChange
+ * @brief One change of the copies of a magazine, see Libary::changeCopies().
+ */
+struct CopyChange
+{
+    CopyAction action;  ///< What to do.
+    std::string issn;  ///< The ISSN of the magazine.
+    int amount = 0;  ///< The number of copies to add to the stock, may be negative. Only used by IncreaseStock.
+};
+
+/**
+ * @brief The result of one change of a batch, see Libary::changeCopies().
+ */
+enum class CopyOutcome
+{
+    Applied,  ///< The change was applied, like all others of the batch.
+    Discarded,  ///< The change alone would have been possible, but another change of the batch was not, so none was applied.
+    NotFound,  ///< No magazine has this ISSN, or the ISSN is malformed.
+    NoCopiesLeft,  ///< A copy was to be borrowed, but all copies are borrowed.
+    NothingBorrowed,  ///< A copy was to be returned, but no copy is borrowed.
+    StockExceeded  ///< The stock would drop below the borrowed copies or exceed MagazineStore::maxCopies.
+};
+
+/**
+ * @struct CopyResult
+ * @brief The outcome of one change of a batch and the copies of its magazine, see Libary::changeCopies().
+ */
+struct CopyResult
+{
+    CopyOutcome outcome = CopyOutcome::NotFound;  ///< Whether the change was applied, or why not.
+    int stock = 0;  ///< The stock right after the change if applied, otherwise the current stock.
+    int borrowedCopies = 0;  ///< The borrowed copies right after the change if applied, otherwise the current ones.
+};
+
 /**
  * @class Libary
  * @brief Represents a library that stores magazines.
  *
  * @details This class provides methods to add and remove magazines, search for magazines by title or ISSN, borrow and return magazines, and save and load the library state from a file.
+ *
+ * All public methods may be called from several threads at once. Lookups, borrowing, returning and stock changes
+ * share a reader lock and change the copies of a magazine with a compare-and-swap, so they never wait for each
+ * other. The leaderboards of borrowed and available copies are brought up to date by their queries. Adding a
+ * magazine, loading and opening the journal take the lock exclusively. Compacting only takes it for a moment and
+ * view() only needs the reader lock. Long reads should go through view(), which holds no lock while it is read.
  */
 class Libary
 {
 private:
     /**
-     * @brief A list of all magazines in the library.
+     * @brief All magazines in the library.
+     *
+     * The magazines are stored in compact columns. Each magazine is identified by its row in the store,
+     * which is also used as id by all indexes.
+     */
+    MagazineStore store;
+
+    /**
+     * @brief Index from the packed ISSN to the row of the magazine in the store.
+     *
+     * The index is kept up to date by addMagazine() and loadFromFile(), so that lookups by ISSN
+     * do not have to scan the whole store. It grows step by step, so adding a magazine never rehashes all of them.
+     */
+    IssnIndex issnIndex;
+
+    /**
+     * @brief Inverted index over the words of all titles, using the row in the store as id.
+     */
+    TitleIndex titleIndex;
+
+    /**
+     * @brief Trigram index over all titles for typo tolerant search, using the row in the store as id.
+     *
+     * It is only needed for suggestions, so it is built by the first suggestByTitle() after the store was cleared
+     * instead of by loadFromFile(), and kept up to date from then on.
+     */
+    TrigramIndex trigramIndex;
+
+    /**
+     * @brief Whether trigramIndex holds all rows of the store. Changed under trigramMutex or with mutex held exclusively.
+     */
+    bool trigramsIndexed = false;
+
+    /**
+     * @brief Lets only one suggestByTitle() at a time build trigramIndex. Taken after mutex.
+     */
+    std::mutex trigramMutex;
+
+    /**
+     * @brief Ordered index over the publication dates, using the row in the store as id.
+     */
+    RangeIndex dateIndex;
+
+    /**
+     * @brief Ordered index over the prices in cents, using the row in the store as id.
+     */
+    RangeIndex priceIndex;
+
+    /**
+     * @brief The copies and the inventory value, overall and per publisher, updated with every change of the store.
+     */
+    InventoryTotals inventory;
+
+    /**
+     * @brief The rows ordered by borrowed and by available copies, updated with every change of the copies.
+     */
+    CopyRanking ranking;
+
+    /**
+     * @brief Counts how often the store was cleared. Handles of an earlier generation are stale.
+     */
+    std::uint32_t generation = 0;
+
+    /**
+     * @brief The records that were skipped by the last call to loadFromFile().
+     */
+    std::vector<LoadError> loadErrors;
+
+    /**
+     * @brief The format used by saveToFile() when no format is given.
+     */
+    FileFormat fileFormat = FileFormat::Text;
+
+    /**
+     * @brief The checksum of the last loaded or compacted database file, 0 if there was none.
+     *
+     * The journal uses it to recognize the database file it belongs to.
+     */
+    std::uint64_t databaseFingerprint = 0;
+
+    /**
+     * @brief The write-ahead journal that records every change once openJournal() was called.
+     */
+    Journal journal;
+
+    /**
+     * @brief Whether changes are recorded in the journal. Off while the journal is replayed.
+     */
+    bool journaling = false;
+
+    /**
+     * @brief Whether loadFromFile() is running, which builds the title, date and price indexes once at the end.
+     */
+    bool loading = false;
+
+    /**
+     * @brief Protects the store and the indexes against changes while they are read.
+     *
+     * Held shared by everything that only reads the structure or changes copies through MagazineStore's atomic
+     * counters, and exclusively by everything that appends rows or replaces the store.
+     */
+    mutable std::shared_mutex mutex;
+
+    /**
+     * @brief Allows only one compaction at a time. Taken before mutex.
+     */
+    std::mutex compactionMutex;
+
+    /**
+     * @brief The thread of the compaction started by compactInBackground(), not joinable if none was started.
+     */
+    std::thread compactionThread;
+
+    /**
+     * @brief Whether the compaction started by compactInBackground() is still running.
+     */
+    std::atomic<bool> compacting{false};
+
+    /**
+     * @brief The result of the last compaction started by compactInBackground().
+     */
+    std::atomic<bool> compactionSucceeded{true};
+
+    /**
+     * @brief Freezes the library state for a compaction. The caller must hold compactionMutex.
+     *
+     * Takes the lock exclusively for a moment and starts carrying the journal over. Unlike view() it cannot make do
+     * with the reader lock: a change applied before the freeze but journaled after it would be replayed twice.
+     * @param frozen Receives the frozen records.
+     * @param format Receives the format to write.
+     * @return Whether the journal is open and was started carrying over.
+     */
+    bool freeze(std::shared_ptr<const MagazineStore> &frozen, FileFormat &format);
+
+    /**
+     * @brief Writes frozen records as the new database file and journal. The caller must hold compactionMutex.
+     *
+     * Holds no lock while the file is written, and only the journal's own lock while the files are renamed.
+     * @param filename The name of the database file.
+     * @param frozen The frozen records, see freeze().
+     * @param format The format to write.
+     * @param journaled The result of freeze().
+     * @return true if the database file was replaced, false otherwise.
+     */
+    bool writeCompaction(const std::string &filename, std::shared_ptr<const MagazineStore> frozen, FileFormat format, bool journaled);
+
+    /**
+     * @brief Removes all magazines and clears all indexes.
+     */
+    void clearMagazines();
+
+    /**
+     * @brief Adds a row of the store to all indexes.
+     *
+     * @param row The row to index.
+     */
+    void indexRow(std::uint32_t row);
+
+    /**
+     * @brief Adds a row of the store to all indexes except the ISSN index, and counts it in the inventory totals.
+     *
+     * @param row The row to index.
+     */
+    void indexFields(std::uint32_t row);
+
+    /**
+     * @brief Rebuilds the title, date and price indexes from all rows of the store at once.
+     *
+     * The title index is built on a thread of its own if there is more than one core.
+     * @param rows Whether to also add every row to the other indexes with indexRow(), which the text loader does
+     * itself while it checks the ISSNs.
+     */
+    void indexAll(bool rows);
+
+    /**
+     * @brief Reads the magazines of some rows. The caller must hold the lock.
      *
-     * This list contains all magazines that are currently in the library's inventory.
-     * Each magazine in the list is represented by an instance of the Magazine class.
+     * @param rows The rows to read.
+     * @return The magazines in the order of the rows.
      */
-    std::vector<Magazine> magazines;
+    std::vector<Magazine> magazinesOf(const std::vector<std::uint32_t> &rows) const;
+
+    /**
+     * @brief Looks up a magazine through the ISSN index.
+     *
+     * @param issn The ISSN of the magazine to look up.
+     * @param row Receives the row of the magazine if found.
+     * @return true if the magazine was found, false otherwise.
+     */
+    bool findRow(const std::string &issn, std::uint32_t &row) const;
+
+    /**
+     * @brief Adds a magazine to the store and all indexes. The caller must hold the lock exclusively.
+     *
+     * @param magazine The magazine to add.
+     * @return true if the magazine was added, false otherwise, see addMagazine().
+     */
+    bool insertMagazine(const Magazine &magazine);
+
+    /**
+     * @brief Adds a record to the store and all indexes without recording it in the journal. The caller must hold the lock exclusively.
+     *
+     * @param record The record to add, whose numbers must already be known to fit.
+     * @return true if the record was added, false if its ISSN already exists.
+     */
+    bool insertRecord(const MagazineRecord &record);
 
 public:
+    Libary() = default;
+    Libary(const Libary &) = delete;
+    Libary &operator=(const Libary &) = delete;
+
+    /**
+     * @brief Waits for a compaction started by compactInBackground().
+     */
+    ~Libary();
+
     /**
      * @brief Adds a magazine to the library.
      *
      * The magazine will be added to the library if it is not already in the library.
      * @param magazine The magazine to add.
+     * @return true if the magazine was added, false if a magazine with the same ISSN already exists
+     * or its stock, borrowed copies or price cannot be stored (see MagazineStore::fits()).
      */
-    void addMagazine(const Magazine &magazine);
+    bool addMagazine(const Magazine &magazine);
 
     /**
      * @brief Check if a magazine exists in the library.
@@ -53,29 +368,190 @@ public:
      * If no magazine with the given ISSN exists in the library, the function does nothing.
      * @param issn The ISSN of the magazine to increase the stock of.
      * @param increaseAmount The amount to increase the stock by.
+     * @return true if the stock was increased, false if the magazine does not exist or the stock would exceed MagazineStore::maxCopies.
+     */
+    bool increaseStock(const std::string &issn, int increaseAmount);
+
+    /**
+     * @brief Adds many magazines at once, or increases the stock of those whose ISSN already exists.
+     *
+     * The magazines are merged in the given order, so a feed that lists an ISSN twice first adds it and then
+     * increases its stock, no matter how the feed was parsed. Each magazine costs a single probe of the ISSN index.
+     * The lock is taken exclusively for a few thousand magazines at a time, so borrowing can go on in between,
+     * and the journal is written once per such group instead of once per magazine.
+     * @param magazines The magazines to merge.
+     * @return The outcome for every magazine, in the same order.
+     */
+    std::vector<MergeOutcome> mergeMagazines(const std::vector<Magazine> &magazines);
+
+    /**
+     * @brief Borrows, returns and restocks many magazines at once, either all of them or none.
+     *
+     * The changes are grouped by ISSN, so each magazine is looked up once however often it occurs, and its changes
+     * are checked in the given order against its copies. Only if every change is possible are they applied, all
+     * while the lock is held exclusively, so no other thread ever sees some of them without the others. They are
+     * recorded in the journal as a single record, which is replayed completely or not at all.
+     * @param changes The changes to apply.
+     * @return The result of every change, in the same order. Either all are Applied, or none is and those that
+     * would have been possible are Discarded.
      */
-    void increaseStock(const std::string &issn, int increaseAmount);
+    std::vector<CopyResult> changeCopies(const std::vector<CopyChange> &changes);
 
     /**
      * @brief Search for magazines by title.
      *
-     * This function searches for magazines with a given title in the library.
-     * It returns a vector of pointers to the matching magazines. If no magazines with the given title are found,
+     * This function searches for magazines whose title matches the given words. The search ignores case and
+     * every word may be the beginning of a word in the title, so "spieg" finds "Der Spiegel".
+     * It returns a vector with copies of the matching magazines. If no magazines with the given title are found,
      * it returns an empty vector.
-     * @param title The title to search for.
-     * @return A vector of pointers to the matching magazines.
+     * @param title The title or the beginning of the title words to search for.
+     * @return A vector with the matching magazines.
+     */
+    std::vector<Magazine> searchByTitle(const std::string &title);
+
+    /**
+     * @brief Search for magazines with a title similar to a possibly misspelled search.
+     *
+     * This function is meant for "did you mean" suggestions when searchByTitle() finds nothing.
+     * A trigram index narrows the catalogue down to a few candidates, which are then ranked by the number of typos
+     * between the search and the best matching part of their title. Up to three typos are tolerated, fewer for short searches.
+     * The first call after loading builds the trigram index from all titles.
+     * @param title The possibly misspelled title to search for.
+     * @param maxResults The maximum number of suggestions to return.
+     * @return The suggestions, best match first. Empty if no title is similar enough.
      */
-    std::vector<Magazine *> searchByTitle(const std::string &title);
+    std::vector<TitleSuggestion> suggestByTitle(const std::string &title, std::size_t maxResults = 5);
 
     /**
      * @brief Searches for a magazine by ISSN.
      *
      * This function searches for a magazine with a given ISSN in the library.
-     * It returns a pointer to the magazine if found, nullptr otherwise.
+     * It returns a copy of the magazine if found, an empty optional otherwise.
      * @param issn The ISSN of the magazine to search for.
-     * @return A pointer to the magazine if found, nullptr otherwise.
+     * @return The magazine if found, an empty optional otherwise.
+     */
+    std::optional<Magazine> searchByISSN(const std::string &issn);
+
+    /**
+     * @brief Returns a handle to a magazine, which is cheaper to read again than looking up the ISSN.
+     *
+     * The handle stays valid while magazines are added, but becomes stale once the library is loaded again.
+     * @param issn The ISSN of the magazine.
+     * @return The handle if the magazine was found, an empty optional otherwise.
+     */
+    std::optional<MagazineHandle> handleOf(const std::string &issn) const;
+
+    /**
+     * @brief Checks whether a handle still refers to the magazine it was created for.
+     * @param handle The handle, see handleOf().
+     * @return true if the handle is valid, false if it is stale.
+     */
+    bool isValid(MagazineHandle handle) const;
+
+    /**
+     * @brief Reads a magazine through a handle.
+     * @param handle The handle, see handleOf().
+     * @return A copy of the magazine with its current copies, or an empty optional if the handle is stale.
+     */
+    std::optional<Magazine> get(MagazineHandle handle) const;
+
+    /**
+     * @brief Lists all magazines that have at least one copy available for borrowing.
+     *
+     * Only the stock and borrowed columns are scanned, the other fields are read for the matches only.
+     * @return The available magazines in the order they were added.
+     */
+    std::vector<Magazine> listAvailable();
+
+    /**
+     * @brief Lists the magazines with the most borrowed copies.
+     *
+     * The order is kept up to date with every borrow, return and stock change, so this costs about the same for
+     * any size of the catalogue, see CopyRanking.
+     * @param count The largest number of magazines to return.
+     * @return The magazines, most borrowed copies first. Magazines without borrowed copies are left out.
+     */
+    std::vector<Magazine> mostBorrowed(std::size_t count);
+
+    /**
+     * @brief Lists the magazines that have few or no copies left to borrow.
+     *
+     * Like mostBorrowed(), this does not scan the catalogue.
+     * @param maximumAvailable The largest number of copies available for borrowing, 0 for the magazines whose
+     * copies are all borrowed or that have no stock.
+     * @param limit The largest number of magazines to return, 0 for all.
+     * @return The magazines, fewest available copies first.
+     */
+    std::vector<Magazine> leastAvailable(int maximumAvailable, std::size_t limit = 0);
+
+    /**
+     * @brief Searches for all magazines of an author.
+     *
+     * Authors are interned, so the name is looked up once and the search compares 32 bit ids only.
+     * @param author The exact name of the author.
+     * @return The magazines of the author, empty if no magazine has this author.
+     */
+    std::vector<Magazine> searchByAuthor(const std::string &author);
+
+    /**
+     * @brief Searches for all magazines of a publisher.
+     *
+     * Publishers are interned, so the name is looked up once and the search compares 32 bit ids only.
+     * @param publisher The exact name of the publisher.
+     * @return The magazines of the publisher, empty if no magazine has this publisher.
+     */
+    std::vector<Magazine> searchByPublisher(const std::string &publisher);
+
+    /**
+     * @brief Searches for all magazines published in a period.
+     *
+     * Runs in O(log n + k) for k matches through an ordered index over the publication dates.
+     * @param from The first day of the period in the format DD.MM.YYYY.
+     * @param to The last day of the period in the format DD.MM.YYYY.
+     * @return The magazines published from the first to the last day, oldest first. Empty if a date is invalid.
      */
-    Magazine *searchByISSN(const std::string &issn);
+    std::vector<Magazine> searchByDate(const std::string &from, const std::string &to);
+
+    /**
+     * @brief Searches for all magazines in a price range.
+     *
+     * Runs in O(log n + k) for k matches through an ordered index over the prices.
+     * @param minimum The lowest price in Euro.
+     * @param maximum The highest price in Euro.
+     * @return The magazines that cost from minimum to maximum, rounded to cents, cheapest first.
+     */
+    std::vector<Magazine> searchByPrice(double minimum, double maximum);
+
+    /**
+     * @brief Returns the totals of the whole inventory.
+     *
+     * The totals are kept up to date by every change, so this takes O(1). While other threads borrow or return
+     * magazines, the totals may include some of their changes and not others.
+     * @return The number of magazines, the copies in stock and on loan, and the value of the stock in cents.
+     */
+    InventoryFigures inventoryTotals() const;
+
+    /**
+     * @brief Returns the totals of the inventory of a publisher.
+     *
+     * @param publisher The exact name of the publisher.
+     * @return The totals like inventoryTotals(), or an empty optional if no magazine has this publisher.
+     */
+    std::optional<InventoryFigures> publisherTotals(const std::string &publisher) const;
+
+    /**
+     * @brief Checks the inventory totals against a full recomputation from all magazines.
+     *
+     * Takes the lock exclusively while all magazines are counted, so the totals must match exactly.
+     * @return true if the totals overall and of every publisher match, false otherwise.
+     */
+    bool verifyInventoryTotals() const;
+
+    /**
+     * @brief Returns the number of magazines in the library.
+     * @return The number of magazines.
+     */
+    std::size_t size() const;
 
     /**
      * @brief Borrow a magazine from the library.
@@ -83,6 +559,7 @@ public:
      * This function attempts to borrow a magazine from the library.
      * If the magazine has copies available, it increases the number of borrowed copies by 1 and returns true.
      * If no copies are available, it returns false.
+     * The magazine is identified by its ISSN, and its borrowed copies are updated to the stored value.
      * @param magazine The magazine to borrow.
      * @return true if the magazine was successfully borrowed, false otherwise.
      */
@@ -94,6 +571,7 @@ public:
      * This function attempts to return a borrowed magazine to the library.
      * If the magazine has borrowed copies, it decreases the number of borrowed copies by 1 and returns true.
      * If no copies are borrowed, it returns false.
+     * The magazine is identified by its ISSN, and its borrowed copies are updated to the stored value.
      * @param magazine The magazine to return.
      * @return true if the magazine was successfully returned, false otherwise.
      */
@@ -104,19 +582,129 @@ public:
      *
      * This function saves the state of the library to a file. The file will contain the details of all magazines in the library.
      * If no file with the given name exists, it will be created. If a file with the given name already exists, it will be overwritten.
+     * The file is written in the format set with setFileFormat(), which is the format of the last loaded file by default.
      * @param filename The name of the file to save to.
      */
     void saveToFile(const std::string &filename);
 
+    /**
+     * @brief Saves the library state to a file in a given format.
+     *
+     * The file is written from a view(), so the library can be changed while it is written.
+     * @param filename The name of the file to save to.
+     * @param format The format to write.
+     */
+    void saveToFile(const std::string &filename, FileFormat format);
+
+    /**
+     * @brief Creates an immutable view of all magazines as they are right now.
+     *
+     * Takes the reader lock for a time proportional to the number of chunks of the store, and only waits for the
+     * copy changes under way, so it is not held up by a steady stream of lookups. If the lock is free, it is taken
+     * exclusively instead to free the pages left over from earlier views. Reading the view afterwards takes no lock,
+     * so reports and exports never block borrowing, returning or adding.
+     * @return The view.
+     */
+    LibaryView view();
+
+    /**
+     * @brief Sets the format used by saveToFile() when no format is given.
+     *
+     * @param format The format to use.
+     */
+    void setFileFormat(FileFormat format);
+
+    /**
+     * @brief Returns the format used by saveToFile() when no format is given.
+     *
+     * @return The format of the last loaded file, unless it was changed with setFileFormat().
+     */
+    FileFormat getFileFormat() const;
+
     /**
      * @brief Loads the library state from a file.
      *
      * This function loads the state of the library from a file. The file should contain the details of all magazines in the library.
+     * The format of the file is detected automatically. The file is mapped into memory and large text files are parsed and
+     * validated on several threads. Invalid records are skipped and can be inspected with getLoadErrors() afterwards,
+     * all valid records are loaded. Binary snapshots are only checked against their checksum, since they are written from
+     * validated data; a damaged snapshot is not loaded at all.
      * If the file does not exist, the function does nothing. The program will continue to run with the current library state.
      * @param filename The name of the file to load from.
+     * @return true if at least one magazine was loaded, false otherwise.
      * @post The library state will be replaced with the state loaded from the file.
      */
     bool loadFromFile(const std::string &filename);
+
+    /**
+     * @brief Returns the records that were skipped by the last call to loadFromFile().
+     *
+     * The list is copied under the lock, so a load running at the same time cannot change it while it is read.
+     * @return The line number and problem of every skipped record, in file order. Problems concerning the whole file have line number 0.
+     */
+    std::vector<LoadError> getLoadErrors() const;
+
+    /**
+     * @brief Starts recording every change in a write-ahead journal.
+     *
+     * The changes recorded in the journal since the loaded database file was written are applied first, so a library
+     * that was not saved before the program stopped is restored. Afterwards every addMagazine(), increaseStock(),
+     * borrowMagazine() and returnMagazine() is appended to the journal. Call this after loadFromFile(). A change whose
+     * record cannot be written still happens in memory; its record stays pending and commitJournal() reports it.
+     * @param filename The name of the journal file.
+     * @param groupCommitSize The number of changes that are collected before they are written to disk together.
+     * A value of 1 makes every change durable before the function returns.
+     * @return true if the journal was opened, false if it cannot be written.
+     */
+    bool openJournal(const std::string &filename, std::size_t groupCommitSize = 1);
+
+    /**
+     * @brief Writes the changes collected for the next group commit to the journal.
+     *
+     * Changes that could not be written before are written again.
+     * @return true if all changes are on disk or no journal is open, false if writing failed, also if it failed
+     * before and is still failing.
+     */
+    bool commitJournal();
+
+    /**
+     * @brief Returns whether changes are recorded in a journal, see openJournal().
+     * @return true if a journal is open, false otherwise.
+     */
+    bool isJournaling() const;
+
+    /**
+     * @brief Folds the journal into a new database file.
+     *
+     * The library state is frozen for a moment like with view(), written to a temporary file in the current format,
+     * which then atomically replaces the database file, and the journal is started anew with the changes made since
+     * the state was frozen. No lock of the library is held while the file is written, so all other operations go on.
+     * The database file is consistent with the journal at every point in time, even if the program stops during
+     * compaction. Waits for a compaction started by compactInBackground() first.
+     * @param filename The name of the database file.
+     * @return true if the database file was replaced, false if it could not be written.
+     */
+    bool compact(const std::string &filename);
+
+    /**
+     * @brief Starts compact() on a background thread and returns right away.
+     *
+     * @param filename The name of the database file.
+     * @return true if the compaction was started, false if another one is still running.
+     */
+    bool compactInBackground(const std::string &filename);
+
+    /**
+     * @brief Checks whether a compaction started by compactInBackground() is still running.
+     * @return true while the compaction runs, false otherwise.
+     */
+    bool isCompacting() const;
+
+    /**
+     * @brief Waits for a compaction started by compactInBackground() to finish.
+     * @return true if the last such compaction replaced the database file or none was started, false otherwise.
+     */
+    bool waitForCompaction();
 };
 
 #endif // LIBARY_HPP
\ No newline at end of file
@@ -0,0 +1,55 @@
+/**
+ * @file libaryview.cpp
+ * @brief File containing the implementation of the LibaryView class.
+ */
+
+#include "libaryview.hpp"
+#include "snapshot.hpp"
+#include "textloader.hpp"
+
+LibaryView::LibaryView(std::shared_ptr<const MagazineStore> store) : store(std::move(store))
+{
+}
+
+std::vector<Magazine> LibaryView::magazines(const std::vector<std::uint32_t> &rows) const
+{
+    std::vector<Magazine> result;
+    result.reserve(rows.size());
+    for (std::uint32_t row : rows)
+    {
+        result.push_back(store->get(row));
+    }
+    return result;
+}
+
+std::size_t LibaryView::size() const
+{
+    return store->size();
+}
+
+Magazine LibaryView::get(std::size_t index) const
+{
+    return store->get(static_cast<std::uint32_t>(index));
+}
+
+std::vector<Magazine> LibaryView::listAvailable() const
+{
+    return magazines(store->availableRows());
+}
+
+std::vector<Magazine> LibaryView::searchByAuthor(const std::string &author) const
+{
+    std::uint32_t id;
+    return store->findName(author, id) ? magazines(store->rowsWithAuthor(id)) : std::vector<Magazine>();
+}
+
+std::vector<Magazine> LibaryView::searchByPublisher(const std::string &publisher) const
+{
+    std::uint32_t id;
+    return store->findName(publisher, id) ? magazines(store->rowsWithPublisher(id)) : std::vector<Magazine>();
+}
+
+bool LibaryView::saveToFile(const std::string &filename, FileFormat format) const
+{
+    return format == FileFormat::Binary ? BinarySnapshot::write(filename, *store) : TextLoader::write(filename, *store);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file libaryview.hpp
+ * @brief File containing the declaration of the LibaryView class.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "magazine.hpp"
+#include "magazinestore.hpp"
+
+#ifndef LIBARYVIEW_HPP
+#define LIBARYVIEW_HPP
+
+/**
+ * @brief The formats in which the library state can be saved.
+ */
+enum class FileFormat
+{
+    Text,  ///< Eight lines of text per magazine, see TextLoader.
+    Binary  ///< A binary snapshot, see BinarySnapshot.
+};
+
+/**
+ * @class LibaryView
+ * @brief An immutable view of all magazines of a library at one instant.
+ *
+ * @details A view is created with Libary::view() and is meant for long reads such as reports and exports. It holds
+ * an immutable copy of the store (see MagazineStore::snapshot()), so it needs no lock at all: borrowing, returning
+ * and adding magazines go on at full speed while the view is read, and none of these changes show up in it. The
+ * memory of the view is shared with the library and freed when the last copy of the view is destroyed.
+ *
+ * Views can be copied cheaply and used from any thread.
+ */
+class LibaryView
+{
+private:
+    std::shared_ptr<const MagazineStore> store;  ///< The frozen records.
+
+    /**
+     * @brief Reads the magazines of some rows.
+     *
+     * @param rows The rows to read.
+     * @return The magazines in the order of the rows.
+     */
+    std::vector<Magazine> magazines(const std::vector<std::uint32_t> &rows) const;
+
+public:
+    /**
+     * @brief Creates a view of a frozen store.
+     * @param store The frozen records, see MagazineStore::snapshot().
+     */
+    explicit LibaryView(std::shared_ptr<const MagazineStore> store);
+
+    /**
+     * @brief Returns the number of magazines in the view.
+     * @return The number of magazines.
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Reads a magazine.
+     * @param index The position of the magazine, below size(). Magazines are kept in the order they were added.
+     * @return The magazine.
+     */
+    Magazine get(std::size_t index) const;
+
+    /**
+     * @brief Lists all magazines that had at least one copy available.
+     * @return The magazines in the order they were added.
+     */
+    std::vector<Magazine> listAvailable() const;
+
+    /**
+     * @brief Searches for all magazines of an author.
+     * @param author The exact name of the author.
+     * @return The magazines of the author in the order they were added.
+     */
+    std::vector<Magazine> searchByAuthor(const std::string &author) const;
+
+    /**
+     * @brief Searches for all magazines of a publisher.
+     * @param publisher The exact name of the publisher.
+     * @return The magazines of the publisher in the order they were added.
+     */
+    std::vector<Magazine> searchByPublisher(const std::string &publisher) const;
+
+    /**
+     * @brief Saves the magazines of the view to a file.
+     *
+     * @param filename The name of the file to write. An existing file is overwritten.
+     * @param format The format to write.
+     * @return true if the file was written completely, false otherwise.
+     */
+    bool saveToFile(const std::string &filename, FileFormat format) const;
+};
+
+#endif // LIBARYVIEW_HPP
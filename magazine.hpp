@@ -4,6 +4,7 @@
  */
 
 #include <string>
+#include <utility>
 
 #ifndef MAGAZINE_HPP
 #define MAGAZINE_HPP
@@ -12,6 +13,7 @@
  * @class Magazine
  * 
  * A class representing a magazine in a library. It contains information about the author, title, publisher, ISSN, stock, publication date, price, and how many magazines are borrowed.
+ * Magazines are passed into and out of the Libary as Magazine objects; the Libary itself keeps them in a compact MagazineStore.
  *
  * @brief A class representing a magazine in a library.
  */
@@ -39,6 +41,6 @@ public:
      * @param borrowedCopies The number of copies of the magazine that are currently borrowed.
      */
     Magazine(std::string author, std::string title, std::string publisher, std::string issn, int stock, std::string publicationDate, double price)
-    : author(author), title(title), publisher(publisher), issn(issn), stock(stock), publicationDate(publicationDate), price(price), borrowedCopies(0) {}
+    : author(std::move(author)), title(std::move(title)), publisher(std::move(publisher)), issn(std::move(issn)), stock(stock), publicationDate(std::move(publicationDate)), price(price), borrowedCopies(0) {}
 };
 #endif // MAGAZINE_HPP
\ No newline at end of file
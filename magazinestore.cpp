@@ -0,0 +1,216 @@
+/**
+ * @file magazinestore.cpp
+ * @brief File containing the implementation of the MagazineStore class.
+ */
+
+#include "magazinestore.hpp"
+#include "utils.hpp"
+#include <cmath>
+#include <string>
+
+std::uint32_t MagazineStore::toCents(double price)
+{
+    return static_cast<std::uint32_t>(std::llround(price * 100.0));
+}
+
+bool MagazineStore::fits(const Magazine &magazine)
+{
+    return fits(magazine.stock, magazine.borrowedCopies, magazine.price);
+}
+
+bool MagazineStore::fits(int stock, int borrowedCopies, double price)
+{
+    return stock >= 0 && stock <= maxCopies && borrowedCopies >= 0 && borrowedCopies <= maxCopies &&
+           price >= 0.0 && price < 40000000.0;
+}
+
+void MagazineStore::reserve(std::size_t count)
+{
+    issns.reserve(count);
+    dates.reserve(count);
+    prices.reserve(count);
+    copies.reserve(count);
+    authors.reserve(count);
+    titles.reserve(count);
+    publishers.reserve(count);
+}
+
+std::uint32_t MagazineStore::append(const Magazine &magazine)
+{
+    return append(MagazineRecord{magazine.author, magazine.title, magazine.publisher, Utils::packISSN(magazine.issn),
+                                 Utils::dateToDays(magazine.publicationDate), toCents(magazine.price), magazine.stock, magazine.borrowedCopies});
+}
+
+std::uint32_t MagazineStore::append(const MagazineRecord &record)
+{
+    std::uint32_t row = size();
+    issns.push_back(record.issn);
+    dates.push_back(record.date);
+    prices.push_back(record.priceCents);
+    copies.push_back(CopyCounter::pack(record.stock, record.borrowedCopies));
+    authors.push_back(names.intern(record.author));
+    titles.push_back(strings.append(record.title));
+    publishers.push_back(names.intern(record.publisher));
+    return row;
+}
+
+Magazine MagazineStore::get(std::uint32_t row) const
+{
+    int stock;
+    int borrowedCopies;
+    copiesOf(row, stock, borrowedCopies);
+    Magazine magazine(std::string(author(row)), std::string(title(row)), std::string(publisher(row)),
+                      Utils::unpackISSN(issns[row]), stock, Utils::daysToDate(dates[row]), prices[row] / 100.0);
+    magazine.borrowedCopies = borrowedCopies;
+    return magazine;
+}
+
+void MagazineStore::copiesOf(std::uint32_t row, int &stock, int &borrowedCopies) const
+{
+    std::uint32_t value = copies.load(row);
+    stock = CopyCounter::stock(value);
+    borrowedCopies = CopyCounter::borrowed(value);
+}
+
+bool MagazineStore::borrow(std::uint32_t row, int &borrowedCopies)
+{
+    CopyColumn::Writer writer = copies.writable(row);
+    std::atomic<std::uint32_t> &word = writer.word();
+    std::uint32_t value = word.load(std::memory_order_relaxed);
+    do
+    {
+        if (CopyCounter::borrowed(value) >= CopyCounter::stock(value))
+        {
+            borrowedCopies = CopyCounter::borrowed(value);
+            return false;
+        }
+    } while (!word.compare_exchange_weak(value, value + 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+    borrowedCopies = CopyCounter::borrowed(value) + 1;
+    return true;
+}
+
+bool MagazineStore::giveBack(std::uint32_t row, int &borrowedCopies)
+{
+    CopyColumn::Writer writer = copies.writable(row);
+    std::atomic<std::uint32_t> &word = writer.word();
+    std::uint32_t value = word.load(std::memory_order_relaxed);
+    do
+    {
+        if (CopyCounter::borrowed(value) == 0)
+        {
+            borrowedCopies = 0;
+            return false;
+        }
+    } while (!word.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed));
+    borrowedCopies = CopyCounter::borrowed(value) - 1;
+    return true;
+}
+
+bool MagazineStore::increaseStock(std::uint32_t row, int amount)
+{
+    // Larger amounts can never give a valid stock, and adding them to the stock could overflow
+    if (amount < -maxCopies || amount > maxCopies)
+    {
+        return false;
+    }
+    CopyColumn::Writer writer = copies.writable(row);
+    std::atomic<std::uint32_t> &word = writer.word();
+    std::uint32_t value = word.load(std::memory_order_relaxed);
+    std::uint32_t changed;
+    do
+    {
+        int stock = CopyCounter::stock(value) + amount;
+        if (stock < CopyCounter::borrowed(value) || stock > maxCopies)
+        {
+            return false;
+        }
+        changed = CopyCounter::pack(stock, CopyCounter::borrowed(value));
+    } while (!word.compare_exchange_weak(value, changed, std::memory_order_acq_rel, std::memory_order_relaxed));
+    return true;
+}
+
+void MagazineStore::adjustCopies(std::uint32_t row, int stockChange, int borrowedChange)
+{
+    // Unsigned arithmetic wraps around, so out of range intermediate counts cancel out again
+    std::uint32_t change = (static_cast<std::uint32_t>(stockChange) << 16) + static_cast<std::uint32_t>(borrowedChange);
+    copies.writable(row).word().fetch_add(change, std::memory_order_acq_rel);
+}
+
+std::vector<std::uint32_t> MagazineStore::availableRows() const
+{
+    std::vector<std::uint32_t> rows;
+    for (std::uint32_t row = 0; row < size(); ++row)
+    {
+        std::uint32_t value = copies.load(row);
+        if (CopyCounter::stock(value) > CopyCounter::borrowed(value))
+        {
+            rows.push_back(row);
+        }
+    }
+    return rows;
+}
+
+/**
+ * @brief Finds all rows whose id column holds a given id.
+ */
+static std::vector<std::uint32_t> rowsWithId(const ChunkedColumn<std::uint32_t> &column, std::uint32_t id)
+{
+    std::vector<std::uint32_t> rows;
+    for (std::uint32_t chunk = 0; chunk < column.chunkCount(); ++chunk)
+    {
+        const std::uint32_t *ids = column.chunk(chunk);
+        std::uint32_t first = chunk << ChunkedColumn<std::uint32_t>::chunkBits;
+        for (std::uint32_t i = 0; i < column.chunkLength(chunk); ++i)
+        {
+            if (ids[i] == id)
+            {
+                rows.push_back(first + i);
+            }
+        }
+    }
+    return rows;
+}
+
+std::vector<std::uint32_t> MagazineStore::rowsWithAuthor(std::uint32_t id) const
+{
+    return rowsWithId(authors, id);
+}
+
+std::vector<std::uint32_t> MagazineStore::rowsWithPublisher(std::uint32_t id) const
+{
+    return rowsWithId(publishers, id);
+}
+
+std::shared_ptr<const MagazineStore> MagazineStore::snapshot()
+{
+    std::shared_ptr<MagazineStore> copy = std::make_shared<MagazineStore>();
+    copy->issns = issns.frozenCopy();
+    copy->dates = dates.frozenCopy();
+    copy->prices = prices.frozenCopy();
+    copy->copies = copies.freeze();
+    copy->authors = authors.frozenCopy();
+    copy->titles = titles.frozenCopy();
+    copy->publishers = publishers.frozenCopy();
+    copy->strings = strings.frozenCopy();
+    copy->names = names.frozenCopy();
+    return copy;
+}
+
+std::size_t MagazineStore::memoryUsage() const
+{
+    return issns.memoryUsage() + dates.memoryUsage() + prices.memoryUsage() + copies.memoryUsage() +
+           authors.memoryUsage() + titles.memoryUsage() + publishers.memoryUsage() + strings.capacity() + names.memoryUsage();
+}
+
+void MagazineStore::clear()
+{
+    issns.clear();
+    dates.clear();
+    prices.clear();
+    copies.clear();
+    authors.clear();
+    titles.clear();
+    publishers.clear();
+    strings.clear();
+    names.clear();
+}
@@ -0,0 +1,268 @@
+/**
+ * @file magazinestore.hpp
+ * @brief File containing the declaration of the MagazineStore class.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "magazine.hpp"
+#include "chunkedcolumn.hpp"
+#include "copycolumn.hpp"
+#include "stringarena.hpp"
+#include "stringpool.hpp"
+
+#ifndef MAGAZINESTORE_HPP
+#define MAGAZINESTORE_HPP
+
+/**
+ * @struct MagazineRecord
+ * @brief The fields of a magazine in the form MagazineStore keeps them, with the strings only referenced.
+ *
+ * @details Records are appended without creating a Magazine, so a loader can hand over views into its input
+ * and the numbers it already parsed while validating, and nothing is allocated for the record on the way.
+ */
+struct MagazineRecord
+{
+    std::string_view author;  ///< The author.
+    std::string_view title;  ///< The title.
+    std::string_view publisher;  ///< The publisher.
+    std::uint32_t issn;  ///< The packed ISSN, see Utils::packISSN().
+    std::int32_t date;  ///< The publication date in days since 01.01.1970.
+    std::uint32_t priceCents;  ///< The price in cents.
+    int stock;  ///< The number of copies in stock.
+    int borrowedCopies;  ///< The number of borrowed copies.
+};
+
+/**
+ * @class MagazineStore
+ * @brief Compact column storage for the magazines of a library.
+ *
+ * @details Instead of one Magazine object per record, every field is kept in a column of its own and a record is
+ * identified by its row number. The ISSN is stored packed into 32 bits, the publication date as days since 01.01.1970,
+ * the price in cents and stock and borrowed copies as the two halves of a CopyCounter. Titles are stored in a shared
+ * StringArena. Authors and publishers repeat a lot, so they are interned in a StringPool and every record only holds
+ * their ids. A record takes 32 bytes plus its title, and scans over a single field, for example to find all magazines with
+ * copies available or of a certain publisher, only read that field's dense column.
+ *
+ * Rows are appended and never removed. Magazine objects are only created when a record is read with get().
+ *
+ * The store itself does not lock. Any number of threads may read it and call borrow(), giveBack(),
+ * increaseStock() and snapshot() at the same time, since these only change the atomic CopyCounter of a row or wait
+ * for the changes under way, see CopyColumn. Appending, clearing and releaseRetired() must not overlap with any
+ * other access, see Libary.
+ *
+ * All columns are stored in chunks that never move and are shared by reference counting. snapshot() uses this to
+ * create an immutable copy of the whole store in time proportional to the number of chunks: the copy shares every
+ * chunk, the copy-on-write pages of the CopyColumn keep its counters from changing, and rows appended later lie
+ * behind its end. The memory is freed once both the store and the last copy have let go of it.
+ */
+class MagazineStore
+{
+    friend class BinarySnapshot;
+
+private:
+    ChunkedColumn<std::uint32_t> issns;  ///< Packed ISSN per row, see Utils::packISSN().
+    ChunkedColumn<std::int32_t> dates;  ///< Publication date per row in days since 01.01.1970.
+    ChunkedColumn<std::uint32_t> prices;  ///< Price per row in cents.
+    CopyColumn copies;  ///< Number of copies in stock and borrowed per row.
+    ChunkedColumn<std::uint32_t> authors;  ///< Id of the author in names per row.
+    ChunkedColumn<StringRef> titles;  ///< Title per row.
+    ChunkedColumn<std::uint32_t> publishers;  ///< Id of the publisher in names per row.
+    StringArena strings;  ///< The characters of all titles.
+    StringPool names;  ///< The distinct authors and publishers.
+
+public:
+    /**
+     * @brief The largest number of copies of a magazine that can be stored.
+     */
+    static const int maxCopies = 65535;
+
+    /**
+     * @brief Converts a price in Euro into cents, rounding to the nearest cent.
+     * @param price The price in Euro.
+     * @return The price in cents.
+     */
+    static std::uint32_t toCents(double price);
+
+    /**
+     * @brief Checks whether the numbers of a magazine can be stored.
+     *
+     * @param magazine The magazine to check. The ISSN and date must already be valid.
+     * @return true if stock and borrowed copies are between 0 and maxCopies and the price is not negative
+     * and below 40 million Euro, false otherwise.
+     */
+    static bool fits(const Magazine &magazine);
+
+    /**
+     * @brief Checks whether the numbers of a magazine can be stored, see fits(const Magazine &).
+     *
+     * @param stock The number of copies in stock.
+     * @param borrowedCopies The number of borrowed copies.
+     * @param price The price in Euro.
+     * @return true if the numbers can be stored, false otherwise.
+     */
+    static bool fits(int stock, int borrowedCopies, double price);
+
+    /**
+     * @brief Returns the number of stored magazines.
+     * @return The number of rows.
+     */
+    std::uint32_t size() const { return issns.size(); }
+
+    /**
+     * @brief Reserves memory for a number of magazines.
+     * @param count The expected number of rows.
+     */
+    void reserve(std::size_t count);
+
+    /**
+     * @brief Appends a magazine.
+     *
+     * @param magazine The magazine to store. It must pass fits().
+     * @return The row of the new record.
+     */
+    std::uint32_t append(const Magazine &magazine);
+
+    /**
+     * @brief Appends a record whose fields were already converted, without allocating anything for it.
+     *
+     * @param record The record to store. Its strings are copied into the store.
+     * @return The row of the new record.
+     */
+    std::uint32_t append(const MagazineRecord &record);
+
+    /**
+     * @brief Reads a whole record.
+     *
+     * @param row The row of the record.
+     * @return A copy of the record as Magazine.
+     */
+    Magazine get(std::uint32_t row) const;
+
+    std::uint32_t issn(std::uint32_t row) const { return issns[row]; }  ///< @brief Returns the packed ISSN of a row.
+    std::int32_t date(std::uint32_t row) const { return dates[row]; }  ///< @brief Returns the publication date of a row in days since 01.01.1970.
+    std::uint32_t priceCents(std::uint32_t row) const { return prices[row]; }  ///< @brief Returns the price of a row in cents.
+    int stock(std::uint32_t row) const { return CopyCounter::stock(copies.load(row)); }  ///< @brief Returns the number of copies in stock of a row.
+    int borrowedCopies(std::uint32_t row) const { return CopyCounter::borrowed(copies.load(row)); }  ///< @brief Returns the number of borrowed copies of a row.
+    std::string_view author(std::uint32_t row) const { return names.view(authors[row]); }  ///< @brief Returns the author of a row.
+    std::string_view title(std::uint32_t row) const { return strings.view(titles[row]); }  ///< @brief Returns the title of a row.
+    std::string_view publisher(std::uint32_t row) const { return names.view(publishers[row]); }  ///< @brief Returns the publisher of a row.
+    std::uint32_t authorId(std::uint32_t row) const { return authors[row]; }  ///< @brief Returns the interned id of the author of a row.
+    std::uint32_t publisherId(std::uint32_t row) const { return publishers[row]; }  ///< @brief Returns the interned id of the publisher of a row.
+
+    /**
+     * @brief Looks up the interned id of an author or publisher.
+     *
+     * @param name The name to look up.
+     * @param id Receives the id if some magazine has this author or publisher.
+     * @return true if the name is known, false otherwise.
+     */
+    bool findName(std::string_view name, std::uint32_t &id) const { return names.find(name, id); }
+
+    /**
+     * @brief Returns the name of an interned id.
+     * @param id An id returned by authorId(), publisherId() or findName().
+     * @return The author or publisher.
+     */
+    std::string_view name(std::uint32_t id) const { return names.view(id); }
+
+    /**
+     * @brief Reads stock and borrowed copies of a row at the same instant.
+     *
+     * @param row The row of the magazine.
+     * @param stock Receives the number of copies in stock.
+     * @param borrowedCopies Receives the number of borrowed copies.
+     */
+    void copiesOf(std::uint32_t row, int &stock, int &borrowedCopies) const;
+
+    /**
+     * @brief Borrows a copy if one is available.
+     *
+     * @param row The row of the magazine.
+     * @param borrowedCopies Receives the number of borrowed copies right after this call.
+     * @return true if a copy was borrowed, false if all copies are borrowed.
+     */
+    bool borrow(std::uint32_t row, int &borrowedCopies);
+
+    /**
+     * @brief Returns a borrowed copy.
+     *
+     * @param row The row of the magazine.
+     * @param borrowedCopies Receives the number of borrowed copies right after this call.
+     * @return true if a copy was returned, false if no copies are borrowed.
+     */
+    bool giveBack(std::uint32_t row, int &borrowedCopies);
+
+    /**
+     * @brief Changes the number of copies in stock.
+     * @param row The row of the magazine.
+     * @param amount The number of copies to add, may be negative.
+     * @return true if the stock was changed, false if it would exceed maxCopies or drop below the borrowed copies.
+     */
+    bool increaseStock(std::uint32_t row, int amount);
+
+    /**
+     * @brief Adds to stock and borrowed copies without any checks.
+     *
+     * Used to replay journaled changes. Changes that were checked when they happened add up to valid counts in
+     * any order, even if intermediate counts would be out of range, so concurrent operations may be replayed
+     * in the order they were journaled rather than the order they were applied.
+     * @param row The row of the magazine.
+     * @param stockChange The number of copies to add to the stock, may be negative.
+     * @param borrowedChange The number of copies to add to the borrowed copies, may be negative.
+     */
+    void adjustCopies(std::uint32_t row, int stockChange, int borrowedChange);
+
+    /**
+     * @brief Finds all magazines that have at least one copy available for borrowing.
+     * @return The rows in ascending order.
+     */
+    std::vector<std::uint32_t> availableRows() const;
+
+    /**
+     * @brief Finds all magazines of an author.
+     * @param id The interned id of the author, see findName().
+     * @return The rows in ascending order.
+     */
+    std::vector<std::uint32_t> rowsWithAuthor(std::uint32_t id) const;
+
+    /**
+     * @brief Finds all magazines of a publisher.
+     * @param id The interned id of the publisher, see findName().
+     * @return The rows in ascending order.
+     */
+    std::vector<std::uint32_t> rowsWithPublisher(std::uint32_t id) const;
+
+    /**
+     * @brief Creates an immutable copy of all records.
+     *
+     * Takes time proportional to the number of chunks, not rows. May run while rows are read and their copies
+     * changed, but must not overlap with appending or clearing. Afterwards, the store and the copy may be used
+     * concurrently.
+     * @return The copy. Looking up names in it with findName() compares the names one by one.
+     */
+    std::shared_ptr<const MagazineStore> snapshot();
+
+    /**
+     * @brief Frees the pages of copies that were changed after a snapshot and are only kept for concurrent readers.
+     *
+     * Must not overlap with any other access.
+     */
+    void releaseRetired() { copies.releaseRetired(); }
+
+    /**
+     * @brief Returns the memory used by the records.
+     * @return The number of bytes reserved for all columns and strings.
+     */
+    std::size_t memoryUsage() const;
+
+    /**
+     * @brief Removes all records.
+     */
+    void clear();
+};
+
+#endif // MAGAZINESTORE_HPP
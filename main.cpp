@@ -11,25 +11,214 @@
 #include <iostream>
 #include <cctype>
 #include <limits>
+#include <memory>
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
 
 #include "libary.hpp"
 #include "handlers.hpp"
+#include "batchrunner.hpp"
+#include "server.hpp"
+#include "autocompactor.hpp"
+#include "metrics.hpp"
+#include "metricsdumper.hpp"
 #include "utils.hpp"
 
+/**
+ * @brief The number of operations collected in the journal before they are written in batch mode.
+ *
+ * Writing every operation separately would limit a batch to a few hundred operations per second. If the program
+ * stops during a batch, at most this many of the last operations are lost. All operations are written when the batch ends.
+ */
+static const std::size_t batchGroupCommitSize = 4096;
+
+/**
+ * @brief The port the server listens on if none is given.
+ */
+static const std::uint16_t defaultPort = 7070;
+
+/**
+ * @brief The number of seconds between two writes of the stats file if --stats-interval is not given.
+ */
+static const unsigned long defaultStatsInterval = 10;
+
+/**
+ * @brief The running server, so that the signal handler can stop it.
+ */
+static Server *runningServer = nullptr;
+
+/**
+ * @brief Stops the running server on SIGINT and SIGTERM.
+ * @param signal The number of the signal.
+ */
+static void stopServer(int)
+{
+    if (runningServer)
+    {
+        runningServer->stop();
+    }
+}
+
 /**
  * @brief The main function and entry point of the application.
  *
  * This function creates a Library and a Handler object, loads the magazines from a file,
  * and then enters a loop where it presents a menu to the user and handles their choice.
  * The loop continues until the user chooses to exit.
+ * With the option --binary the database is saved as binary snapshot instead of text on exit.
+ * With the option --batch [file] the commands are read from the file or from stdin instead of the menu, see BatchRunner.
+ * In batch mode the results are written to stdout, all other messages to stderr, and the exit status is 2 if any
+ * command failed.
+ * With the option --serve [port] the library is served over TCP instead, see Server, until SIGINT or SIGTERM
+ * arrives; the database file is then compacted.
+ * With the option --autosave minutes the database file is compacted in the background at that interval in every mode.
+ * With the option --stats-file file the operation stats are written to the file in the Prometheus text format every
+ * ten seconds, or at the interval given with --stats-interval seconds, see MetricsDumper.
  *
+ * @param argc The number of command line arguments.
+ * @param argv The command line arguments.
  * @return int The exit status of the application. 0 for success, non-zero for failure.
  */
-int main()
+int main(int argc, char *argv[])
 {
+    bool binary = false;
+    bool batch = false;
+    std::string batchFile;
+    bool serve = false;
+    unsigned long port = defaultPort;
+    unsigned long autosaveMinutes = 0;
+    std::string statsFile;
+    unsigned long statsSeconds = defaultStatsInterval;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        if (argument == "--binary")
+        {
+            binary = true;
+        }
+        else if (argument == "--batch")
+        {
+            batch = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                batchFile = argv[++i];
+            }
+        }
+        else if (argument == "--serve")
+        {
+            serve = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+            {
+                port = std::strtoul(argv[++i], nullptr, 10);
+            }
+        }
+        else if (argument == "--autosave" && i + 1 < argc)
+        {
+            autosaveMinutes = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--stats-file" && i + 1 < argc)
+        {
+            statsFile = argv[++i];
+        }
+        else if (argument == "--stats-interval" && i + 1 < argc)
+        {
+            statsSeconds = std::strtoul(argv[++i], nullptr, 10);
+        }
+    }
+    // In batch mode stdout only carries the results of the commands
+    std::ostream &messages = batch ? std::cerr : std::cout;
+    if (serve && (batch || port > 65535))
+    {
+        std::cerr << "Die Optionen --batch und --serve schliessen sich aus, und der Port muss zwischen 0 und 65535 liegen.\n";
+        return 1;
+    }
+    if (!statsFile.empty() && !Metrics::enabled())
+    {
+        std::cerr << "Die Statistik ist in dieser Version nicht einkompiliert, --stats-file wird ignoriert.\n";
+        statsFile.clear();
+    }
+    // Started first and stopped last, so the file also covers loading and the final save
+    std::unique_ptr<MetricsDumper> statsDumper;
+    if (!statsFile.empty())
+    {
+        statsDumper.reset(new MetricsDumper(statsFile, std::chrono::seconds(statsSeconds)));
+    }
+
     Libary libary;
     Handler handler(libary);
     bool fileLoaded = libary.loadFromFile("magazine.txt");
+    for (const LoadError &error : libary.getLoadErrors())
+    {
+        if (error.line == 0)
+        {
+            messages << "Die Magazindatenbank konnte nicht gelesen werden: " << error.message << "\n";
+        }
+        else
+        {
+            messages << "Datensatz in Zeile " << error.line << " wurde uebersprungen: " << error.message << "\n";
+        }
+    }
+    // The server commits the journal itself once per round of requests
+    if (!libary.openJournal("magazine.journal", batch || serve ? batchGroupCommitSize : 1))
+    {
+        messages << "Das Journal magazine.journal konnte nicht geoeffnet werden. Aenderungen werden erst beim Beenden gespeichert.\n";
+    }
+    if (binary)
+    {
+        libary.setFileFormat(FileFormat::Binary);
+    }
+    std::unique_ptr<AutoCompactor> autosave;
+    if (autosaveMinutes > 0)
+    {
+        autosave.reset(new AutoCompactor(libary, "magazine.txt", std::chrono::minutes(autosaveMinutes)));
+    }
+
+    if (batch)
+    {
+        std::ios::sync_with_stdio(false);
+        BatchRunner runner(libary, "magazine.txt", std::cout);
+        std::size_t failures;
+        if (batchFile.empty())
+        {
+            failures = runner.run(std::cin);
+        }
+        else
+        {
+            std::ifstream commands(batchFile);
+            if (!commands)
+            {
+                std::cerr << "Die Befehlsdatei " << batchFile << " konnte nicht geoeffnet werden.\n";
+                return 1;
+            }
+            failures = runner.run(commands);
+        }
+        return failures > 0 ? 2 : 0;
+    }
+
+    if (serve)
+    {
+        Server server(libary, "magazine.txt");
+        if (!server.listen("0.0.0.0", static_cast<std::uint16_t>(port)))
+        {
+            std::cerr << "Der Server konnte nicht auf Port " << port << " gestartet werden.\n";
+            return 1;
+        }
+        runningServer = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+        std::cout << "Der Server wartet auf Port " << server.port() << " mit " << workers << " Threads. Beenden mit Strg+C.\n";
+        server.run(workers);
+        runningServer = nullptr;
+        autosave.reset();
+        bool compacted = libary.compact("magazine.txt");
+        std::cout << (compacted ? "Der Server wurde beendet und die Datenbank gespeichert.\n"
+                                : "Der Server wurde beendet, die Datenbank konnte nicht gespeichert werden.\n");
+        return compacted ? 0 : 1;
+    }
 
     if (!fileLoaded)
     {
@@ -51,13 +240,16 @@ int main()
                   << "4. Magazin ausleihen\n"
                   << "5. Magazin zurueckgeben\n"
                   << "6. Beenden\n"
+                  << "7. Suche via Erscheinungsdatum\n"
+                  << "8. Suche via Preis\n"
+                  << "9. Statistik anzeigen\n"
                   << "Geben Sie Ihre Auswahl ein: ";
         int choice;
         if (!(std::cin >> choice))
         {
             std::cin.clear();                                                   // clear the error state
             std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n'); // ignore the rest of the line
-            std::cout << "Ungueltige Auswahl. Bitte geben Sie eine Nummer zwischen 1 und 6 ein.\n";
+            std::cout << "Ungueltige Auswahl. Bitte geben Sie eine Nummer zwischen 1 und 9 ein.\n";
             continue; // skip the rest of the loop
         }
         std::cin.ignore(); // ignore newline at the end of the input
@@ -79,11 +271,20 @@ int main()
             handler.handleReturnMagazine();
             break;
         case 6:
-            std::cout << "Das Programm wurde beendet und die Datenbank gespeichert.\n";
-            handler.handleExit();
+            // Returning runs the destructors, so the autosave stops first and the stats file covers the final save
+            autosave.reset();
+            return handler.handleExit();
+        case 7:
+            handler.handleSearchByDate();
+            break;
+        case 8:
+            handler.handleSearchByPrice();
+            break;
+        case 9:
+            handler.handleShowStatistics();
             break;
         default:
-            std::cout << "Ungueltige Auswahl. Bitte geben Sie eine Nummer zwischen 1 und 6 ein.\n";
+            std::cout << "Ungueltige Auswahl. Bitte geben Sie eine Nummer zwischen 1 und 9 ein.\n";
             break;
         }
     }
@@ -0,0 +1,83 @@
+/**
+ * @file mappedfile.cpp
+ * @brief File containing the implementation of the MappedFile class.
+ */
+
+#include "mappedfile.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPEDFILE_USE_MMAP
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string &filename)
+{
+    close();
+#ifdef MAPPEDFILE_USE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    mappedSize = static_cast<std::size_t>(info.st_size);
+    if (mappedSize > 0)
+    {
+        void *address = ::mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED)
+        {
+            ::close(fd);
+            mappedSize = 0;
+            return false;
+        }
+        // The file is read front to back
+        ::madvise(address, mappedSize, MADV_SEQUENTIAL);
+        mappedData = static_cast<const char *>(address);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    return true;
+#else
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    buffer = contents.str();
+    mappedData = buffer.data();
+    mappedSize = buffer.size();
+    return true;
+#endif
+}
+
+void MappedFile::close()
+{
+#ifdef MAPPEDFILE_USE_MMAP
+    if (mappedData)
+    {
+        ::munmap(const_cast<char *>(mappedData), mappedSize);
+    }
+#else
+    buffer.clear();
+#endif
+    mappedData = nullptr;
+    mappedSize = 0;
+}
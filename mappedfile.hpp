@@ -0,0 +1,64 @@
+/**
+ * @file mappedfile.hpp
+ * @brief File containing the declaration of the MappedFile class.
+ */
+
+#include <cstddef>
+#include <string>
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+/**
+ * @class MappedFile
+ * @brief Maps a file read-only into memory.
+ *
+ * @details On POSIX systems the file is mapped with mmap, so its pages are loaded by the operating system on demand
+ * and no copy into a separate buffer is needed. On other systems the file is read into memory instead.
+ * The mapping is released when the object is destroyed.
+ */
+class MappedFile
+{
+private:
+    const char *mappedData = nullptr;  ///< The start of the file contents, nullptr if no file is open.
+    std::size_t mappedSize = 0;  ///< The size of the file in bytes.
+    std::string buffer;  ///< Holds the file contents on systems without mmap.
+
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /**
+     * @brief Unmaps the file.
+     */
+    ~MappedFile();
+
+    /**
+     * @brief Maps a file into memory.
+     *
+     * A file that is already open is closed first.
+     * @param filename The name of the file to map.
+     * @return true if the file was opened, false if it does not exist or cannot be read.
+     */
+    bool open(const std::string &filename);
+
+    /**
+     * @brief Unmaps the file. Does nothing if no file is open.
+     */
+    void close();
+
+    /**
+     * @brief Returns the contents of the file.
+     * @return A pointer to the first byte of the file. May be nullptr for an empty file.
+     */
+    const char *data() const { return mappedData; }
+
+    /**
+     * @brief Returns the size of the file.
+     * @return The size of the file in bytes.
+     */
+    std::size_t size() const { return mappedSize; }
+};
+
+#endif // MAPPEDFILE_HPP
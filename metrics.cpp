@@ -0,0 +1,341 @@
+/**
+ * @file metrics.cpp
+ * @brief File containing the implementation of the Metrics class.
+ */
+
+#include "metrics.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief The names of the operations in the order of Operation.
+ */
+static const char *const operationNames[Metrics::operationCount] = {
+    "addMagazine", "searchByTitle", "searchByISSN", "borrowMagazine", "returnMagazine", "saveToFile", "loadFromFile"};
+
+/**
+ * @brief The upper limits of the histogram buckets in the dump file, with their label, from 1 microsecond to 10 seconds.
+ */
+static const struct
+{
+    const char *label;
+    std::uint64_t nanoseconds;
+} dumpBuckets[] = {
+    {"1e-06", 1000ULL}, {"2.5e-06", 2500ULL}, {"5e-06", 5000ULL},
+    {"1e-05", 10000ULL}, {"2.5e-05", 25000ULL}, {"5e-05", 50000ULL},
+    {"0.0001", 100000ULL}, {"0.00025", 250000ULL}, {"0.0005", 500000ULL},
+    {"0.001", 1000000ULL}, {"0.0025", 2500000ULL}, {"0.005", 5000000ULL},
+    {"0.01", 10000000ULL}, {"0.025", 25000000ULL}, {"0.05", 50000000ULL},
+    {"0.1", 100000000ULL}, {"0.25", 250000000ULL}, {"0.5", 500000000ULL},
+    {"1", 1000000000ULL}, {"2.5", 2500000000ULL}, {"5", 5000000000ULL},
+    {"10", 10000000000ULL}};
+
+bool Metrics::enabled()
+{
+#ifdef LIBARY_METRICS
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *Metrics::name(Operation operation)
+{
+    return operationNames[static_cast<std::size_t>(operation)];
+}
+
+std::size_t Metrics::bucketOf(std::uint64_t nanoseconds)
+{
+    if (nanoseconds < linearBuckets)
+    {
+        return static_cast<std::size_t>(nanoseconds);
+    }
+    // The highest set bit selects the power of two, the three bits below it the sub-bucket
+    unsigned exponent = 4;
+    while (exponent < 63 && (nanoseconds >> (exponent + 1)) != 0)
+    {
+        ++exponent;
+    }
+    std::size_t bucket = linearBuckets + (exponent - 4) * subBuckets + ((nanoseconds >> (exponent - 3)) & (subBuckets - 1));
+    return std::min(bucket, bucketCount - 1);
+}
+
+std::uint64_t Metrics::bucketLimit(std::size_t bucket)
+{
+    if (bucket < linearBuckets)
+    {
+        return bucket + 1;
+    }
+    std::size_t exponent = 4 + (bucket - linearBuckets) / subBuckets;
+    std::uint64_t subBucket = (bucket - linearBuckets) % subBuckets;
+    return (subBuckets + subBucket + 1) << (exponent - 3);
+}
+
+std::uint64_t OperationStats::percentile(double fraction) const
+{
+    std::uint64_t total = 0;
+    for (std::uint64_t calls : buckets)
+    {
+        total += calls;
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+    // The buckets are read while they change, so the rank is taken from their own sum instead of timed
+    std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(fraction * static_cast<double>(total) + 0.5));
+    std::uint64_t seen = 0;
+    for (std::size_t bucket = 0; bucket < buckets.size(); ++bucket)
+    {
+        seen += buckets[bucket];
+        if (seen >= rank)
+        {
+            return std::min(Metrics::bucketLimit(bucket) - 1, maxNanoseconds);
+        }
+    }
+    return maxNanoseconds;
+}
+
+#ifdef LIBARY_METRICS
+
+/**
+ * @brief Adds to a counter that only the owning thread writes, without a locked instruction.
+ */
+static void increase(std::atomic<std::uint64_t> &counter, std::uint64_t amount)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+/**
+ * @struct Shard
+ * @brief The counters and histograms one thread writes into.
+ *
+ * The counters are atomic only so collect() may read them while the owner writes; the owner is the only writer.
+ */
+struct alignas(64) Shard
+{
+    /**
+     * @brief The counters and the histogram of one operation.
+     */
+    struct Counters
+    {
+        std::atomic<std::uint64_t> count{0};  ///< The number of calls.
+        std::atomic<std::uint64_t> timed{0};  ///< The number of timed calls.
+        std::atomic<std::uint64_t> totalNanoseconds{0};  ///< The summed latency of the timed calls.
+        std::atomic<std::uint64_t> maxNanoseconds{0};  ///< The highest latency.
+        std::atomic<std::uint64_t> buckets[Metrics::bucketCount] = {};  ///< The timed calls per bucket.
+        std::uint32_t untilTimed = 1;  ///< The number of calls until the next timed one, only used by the owner.
+    };
+
+    Counters operations[Metrics::operationCount];  ///< The counters of every operation.
+};
+
+/**
+ * @struct ShardRegistry
+ * @brief All shards ever created, and those whose thread ended.
+ */
+struct ShardRegistry
+{
+    std::mutex mutex;  ///< Protects shards and released.
+    std::vector<std::unique_ptr<Shard>> shards;  ///< All shards, so their counts survive their threads.
+    std::vector<Shard *> released;  ///< The shards whose thread ended, handed to the next new thread.
+};
+
+/**
+ * @brief Returns the registry. It is never destroyed, so a thread that ends after main() can still release its shard.
+ */
+static ShardRegistry &registry()
+{
+    static ShardRegistry *instance = new ShardRegistry;
+    return *instance;
+}
+
+/**
+ * @brief The shard of the calling thread, nullptr until it first records something.
+ *
+ * A plain pointer needs no initialization check on every access, unlike the lease below.
+ */
+static thread_local Shard *threadShard = nullptr;
+
+/**
+ * @struct ShardLease
+ * @brief Hands the shard of a thread back to the registry when the thread ends.
+ */
+struct ShardLease
+{
+    Shard *shard = nullptr;  ///< The leased shard.
+
+    ~ShardLease()
+    {
+        if (shard)
+        {
+            ShardRegistry &shards = registry();
+            std::lock_guard<std::mutex> lock(shards.mutex);
+            shards.released.push_back(shard);
+            threadShard = nullptr;
+        }
+    }
+};
+
+/**
+ * @brief Leases a shard to the calling thread, reusing one of an ended thread if there is one.
+ */
+static Shard &leaseShard()
+{
+    static thread_local ShardLease lease;
+    ShardRegistry &shards = registry();
+    std::lock_guard<std::mutex> lock(shards.mutex);
+    if (shards.released.empty())
+    {
+        shards.shards.emplace_back(new Shard);
+        lease.shard = shards.shards.back().get();
+    }
+    else
+    {
+        lease.shard = shards.released.back();
+        shards.released.pop_back();
+    }
+    threadShard = lease.shard;
+    return *lease.shard;
+}
+
+/**
+ * @brief Returns the counters of an operation in the shard of the calling thread.
+ */
+static Shard::Counters &countersOf(Operation operation)
+{
+    Shard *shard = threadShard;
+    return (shard ? *shard : leaseShard()).operations[static_cast<std::size_t>(operation)];
+}
+
+bool Metrics::count(Operation operation)
+{
+    Shard::Counters &counters = countersOf(operation);
+    increase(counters.count, 1);
+    if (--counters.untilTimed != 0)
+    {
+        return false;
+    }
+    // Saving and loading take long enough that reading the clock costs nothing in comparison
+    counters.untilTimed = operation == Operation::SaveToFile || operation == Operation::LoadFromFile ? 1 : timingInterval;
+    return true;
+}
+
+void Metrics::record(Operation operation, std::uint64_t nanoseconds)
+{
+    Shard::Counters &counters = countersOf(operation);
+    increase(counters.timed, 1);
+    increase(counters.totalNanoseconds, nanoseconds);
+    increase(counters.buckets[bucketOf(nanoseconds)], 1);
+    if (nanoseconds > counters.maxNanoseconds.load(std::memory_order_relaxed))
+    {
+        counters.maxNanoseconds.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+
+std::vector<OperationStats> Metrics::collect()
+{
+    std::vector<OperationStats> stats(operationCount);
+    for (std::size_t i = 0; i < operationCount; ++i)
+    {
+        stats[i].name = operationNames[i];
+        stats[i].buckets.assign(bucketCount, 0);
+    }
+    ShardRegistry &shards = registry();
+    std::lock_guard<std::mutex> lock(shards.mutex);
+    for (const std::unique_ptr<Shard> &shard : shards.shards)
+    {
+        for (std::size_t i = 0; i < operationCount; ++i)
+        {
+            const Shard::Counters &counters = shard->operations[i];
+            OperationStats &operation = stats[i];
+            operation.count += counters.count.load(std::memory_order_relaxed);
+            operation.timed += counters.timed.load(std::memory_order_relaxed);
+            operation.totalNanoseconds += counters.totalNanoseconds.load(std::memory_order_relaxed);
+            operation.maxNanoseconds = std::max(operation.maxNanoseconds, counters.maxNanoseconds.load(std::memory_order_relaxed));
+            for (std::size_t bucket = 0; bucket < bucketCount; ++bucket)
+            {
+                operation.buckets[bucket] += counters.buckets[bucket].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return stats;
+}
+
+#else
+
+bool Metrics::count(Operation)
+{
+    return false;
+}
+
+void Metrics::record(Operation, std::uint64_t)
+{
+}
+
+std::vector<OperationStats> Metrics::collect()
+{
+    return {};
+}
+
+#endif // LIBARY_METRICS
+
+bool Metrics::dump(const std::string &filename)
+{
+    std::vector<OperationStats> stats = collect();
+    if (stats.empty())
+    {
+        return false;
+    }
+    std::string text = "# HELP libary_operations_total Calls of a library operation.\n"
+                       "# TYPE libary_operations_total counter\n";
+    char line[160];
+    for (const OperationStats &operation : stats)
+    {
+        std::snprintf(line, sizeof(line), "libary_operations_total{operation=\"%s\"} %" PRIu64 "\n", operation.name, operation.count);
+        text += line;
+    }
+    text += "# HELP libary_operation_duration_seconds Latency of the timed calls of a library operation.\n"
+            "# TYPE libary_operation_duration_seconds histogram\n";
+    for (const OperationStats &operation : stats)
+    {
+        // A bucket of the histogram is only counted below a limit if all of its latencies are, so the counts never overstate
+        std::size_t bucket = 0;
+        std::uint64_t below = 0;
+        for (const auto &limit : dumpBuckets)
+        {
+            while (bucket < bucketCount && bucketLimit(bucket) <= limit.nanoseconds + 1)
+            {
+                below += operation.buckets[bucket++];
+            }
+            std::snprintf(line, sizeof(line), "libary_operation_duration_seconds_bucket{operation=\"%s\",le=\"%s\"} %" PRIu64 "\n", operation.name, limit.label, below);
+            text += line;
+        }
+        while (bucket < bucketCount)
+        {
+            below += operation.buckets[bucket++];
+        }
+        std::snprintf(line, sizeof(line), "libary_operation_duration_seconds_bucket{operation=\"%s\",le=\"+Inf\"} %" PRIu64 "\n", operation.name, below);
+        text += line;
+        std::snprintf(line, sizeof(line), "libary_operation_duration_seconds_sum{operation=\"%s\"} %.9f\n", operation.name, static_cast<double>(operation.totalNanoseconds) / 1e9);
+        text += line;
+        std::snprintf(line, sizeof(line), "libary_operation_duration_seconds_count{operation=\"%s\"} %" PRIu64 "\n", operation.name, below);
+        text += line;
+    }
+
+    std::string temporary = filename + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.write(text.data(), static_cast<std::streamsize>(text.size())).flush())
+        {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    return std::rename(temporary.c_str(), filename.c_str()) == 0;
+}
@@ -0,0 +1,176 @@
+/**
+ * @file metrics.hpp
+ * @brief File containing the declaration of the Metrics class.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+// Compiling with -DLIBARY_NO_METRICS removes all counting and timing from the operations
+#ifndef LIBARY_NO_METRICS
+#define LIBARY_METRICS
+#endif
+
+/**
+ * @brief The operations of a Libary that are counted and timed.
+ */
+enum class Operation
+{
+    AddMagazine,  ///< Libary::addMagazine()
+    SearchByTitle,  ///< Libary::searchByTitle()
+    SearchByISSN,  ///< Libary::searchByISSN()
+    BorrowMagazine,  ///< Libary::borrowMagazine()
+    ReturnMagazine,  ///< Libary::returnMagazine()
+    SaveToFile,  ///< Libary::saveToFile() and Libary::compact()
+    LoadFromFile  ///< Libary::loadFromFile()
+};
+
+/**
+ * @struct OperationStats
+ * @brief The counters and the latency histogram of one operation, summed over all threads.
+ */
+struct OperationStats
+{
+    const char *name;  ///< The name of the operation, as in the method name.
+    std::uint64_t count = 0;  ///< The number of calls.
+    std::uint64_t timed = 0;  ///< The number of calls whose latency was measured.
+    std::uint64_t totalNanoseconds = 0;  ///< The summed latency of the measured calls.
+    std::uint64_t maxNanoseconds = 0;  ///< The highest latency measured.
+    std::vector<std::uint64_t> buckets;  ///< The number of measured calls per bucket, see Metrics::bucketLimit().
+
+    /**
+     * @brief Estimates a percentile of the latency.
+     * @param fraction The share of measured calls that were at least as fast, for example 0.99.
+     * @return The highest latency of the bucket the percentile lies in, at most maxNanoseconds, 0 if nothing was measured.
+     */
+    std::uint64_t percentile(double fraction) const;
+};
+
+/**
+ * @class Metrics
+ * @brief Counts the calls of the Libary operations and records their latencies in histograms.
+ *
+ * @details Every thread writes into a shard of its own, so recording never waits and never shares a cache line with
+ * another thread. A shard belongs to a thread until the thread ends and is then handed to the next new thread, so
+ * the counts of finished threads are kept. collect() sums all shards while they keep changing.
+ *
+ * Latencies go into log-linear buckets like those of an HDR histogram: exact below 16 ns, and above that eight
+ * buckets per power of two, so every value is known to within 12.5 %. Reading the clock twice costs more than the
+ * fastest operations themselves, so those are counted on every call but only every timingInterval-th call per thread
+ * is timed. The percentiles are estimated from these samples. Saving and loading are timed on every call.
+ *
+ * Compiling with LIBARY_NO_METRICS defined removes the recording from the operations entirely; collect() then
+ * returns nothing.
+ */
+class Metrics
+{
+public:
+    static const std::size_t operationCount = 7;  ///< The number of values of Operation.
+    static const std::size_t linearBuckets = 16;  ///< The number of buckets of a single nanosecond at the start.
+    static const std::size_t subBuckets = 8;  ///< The number of buckets per power of two above linearBuckets.
+    static const std::size_t bucketCount = linearBuckets + 37 * subBuckets;  ///< The number of buckets, up to about 36 minutes.
+    static const std::uint32_t timingInterval = 8;  ///< Only every this many calls of a fast operation are timed.
+
+    /**
+     * @brief Returns whether the operations are counted, which is decided when compiling.
+     * @return false if compiled with LIBARY_NO_METRICS, true otherwise.
+     */
+    static bool enabled();
+
+    /**
+     * @brief Returns the name of an operation.
+     * @param operation The operation.
+     * @return The name of the method.
+     */
+    static const char *name(Operation operation);
+
+    /**
+     * @brief Returns the bucket of a latency.
+     * @param nanoseconds The latency.
+     * @return The index of the bucket, below bucketCount.
+     */
+    static std::size_t bucketOf(std::uint64_t nanoseconds);
+
+    /**
+     * @brief Returns the smallest latency that no longer falls into a bucket.
+     * @param bucket The index of the bucket.
+     * @return The upper limit of the bucket in nanoseconds, exclusive.
+     */
+    static std::uint64_t bucketLimit(std::size_t bucket);
+
+    /**
+     * @brief Counts a call of an operation and decides whether it is timed.
+     * @param operation The operation.
+     * @return true if the call should be timed and passed to record(), false otherwise.
+     */
+    static bool count(Operation operation);
+
+    /**
+     * @brief Records the latency of a timed call.
+     * @param operation The operation.
+     * @param nanoseconds The latency.
+     */
+    static void record(Operation operation, std::uint64_t nanoseconds);
+
+    /**
+     * @brief Sums the counters and histograms of all threads.
+     * @return The stats of every operation in the order of Operation, empty if compiled with LIBARY_NO_METRICS.
+     */
+    static std::vector<OperationStats> collect();
+
+    /**
+     * @brief Writes all stats to a file in the Prometheus text format, for example for the textfile collector.
+     *
+     * The file is written under a temporary name and then renamed, so a scraper never reads half a file.
+     * @param filename The name of the file.
+     * @return true if the file was written, false otherwise.
+     */
+    static bool dump(const std::string &filename);
+};
+
+/**
+ * @class OperationTimer
+ * @brief Counts and times an operation from its construction to its destruction.
+ *
+ * Declared as the first local variable of an instrumented method. Empty if compiled with LIBARY_NO_METRICS.
+ */
+class OperationTimer
+{
+#ifdef LIBARY_METRICS
+private:
+    Operation operation;  ///< The operation.
+    bool timed;  ///< Whether this call is timed.
+    std::chrono::steady_clock::time_point start;  ///< When the call started, if timed.
+
+public:
+    explicit OperationTimer(Operation operation) : operation(operation), timed(Metrics::count(operation))
+    {
+        if (timed)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~OperationTimer()
+    {
+        if (timed)
+        {
+            Metrics::record(operation, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+        }
+    }
+#else
+public:
+    explicit OperationTimer(Operation) {}
+#endif
+
+    OperationTimer(const OperationTimer &) = delete;
+    OperationTimer &operator=(const OperationTimer &) = delete;
+};
+
+#endif // METRICS_HPP
@@ -0,0 +1,36 @@
+/**
+ * @file metricsdumper.cpp
+ * @brief File containing the implementation of the MetricsDumper class.
+ */
+
+#include "metricsdumper.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+
+MetricsDumper::MetricsDumper(const std::string &filename, std::chrono::seconds interval)
+    : filename(filename), interval(std::max(interval, std::chrono::seconds(1)))
+{
+    thread = std::thread(&MetricsDumper::run, this);
+}
+
+MetricsDumper::~MetricsDumper()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_one();
+    thread.join();
+    Metrics::dump(filename);
+}
+
+void MetricsDumper::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    do
+    {
+        // A failed dump is tried again at the next interval
+        Metrics::dump(filename);
+    } while (!wakeup.wait_for(lock, interval, [this]
+                              { return stopping; }));
+}
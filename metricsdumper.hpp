@@ -0,0 +1,54 @@
+/**
+ * @file metricsdumper.hpp
+ * @brief File containing the declaration of the MetricsDumper class.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#ifndef METRICSDUMPER_HPP
+#define METRICSDUMPER_HPP
+
+/**
+ * @class MetricsDumper
+ * @brief Writes the operation stats to a file at a fixed interval while the program runs, see Metrics::dump().
+ *
+ * @details The file is meant to be read by a scraper such as the textfile collector of the Prometheus node exporter.
+ * It is replaced as a whole every time, so it always holds the counts since the program started.
+ */
+class MetricsDumper
+{
+private:
+    std::string filename;  ///< The file the stats are written to.
+    std::chrono::seconds interval;  ///< The time between two dumps.
+    std::mutex mutex;  ///< Protects stopping.
+    std::condition_variable wakeup;  ///< Wakes the thread when stopping is set.
+    bool stopping = false;  ///< Whether the thread should end.
+    std::thread thread;  ///< Waits for the next dump and writes it.
+
+    /**
+     * @brief Writes the stats every interval until the dumper is destroyed.
+     */
+    void run();
+
+public:
+    /**
+     * @brief Starts writing the stats at a fixed interval. The first dump is written right away.
+     *
+     * @param filename The file the stats are written to.
+     * @param interval The time between two dumps, at least one second.
+     */
+    MetricsDumper(const std::string &filename, std::chrono::seconds interval);
+    MetricsDumper(const MetricsDumper &) = delete;
+    MetricsDumper &operator=(const MetricsDumper &) = delete;
+
+    /**
+     * @brief Stops the thread and writes the stats a last time.
+     */
+    ~MetricsDumper();
+};
+
+#endif // METRICSDUMPER_HPP
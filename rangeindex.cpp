@@ -0,0 +1,74 @@
+/**
+ * @file rangeindex.cpp
+ * @brief File containing the implementation of the RangeIndex class.
+ */
+
+#include "rangeindex.hpp"
+
+void RangeIndex::add(std::uint32_t key, std::uint32_t id)
+{
+    std::uint64_t value = entry(key, id);
+    if (blocks.empty())
+    {
+        blocks.emplace_back(1, value);
+        lasts.push_back(value);
+        ++entries;
+        return;
+    }
+    // The first block that ends at or after the entry, or the last block for an entry larger than all others
+    std::size_t b = static_cast<std::size_t>(std::lower_bound(lasts.begin(), lasts.end(), value) - lasts.begin());
+    b = std::min(b, blocks.size() - 1);
+    std::vector<std::uint64_t> &block = blocks[b];
+    block.insert(std::upper_bound(block.begin(), block.end(), value), value);
+    lasts[b] = block.back();
+    ++entries;
+
+    if (block.size() >= maxBlockSize)
+    {
+        std::vector<std::uint64_t> upper(block.begin() + static_cast<std::ptrdiff_t>(maxBlockSize / 2), block.end());
+        block.resize(maxBlockSize / 2);
+        lasts[b] = block.back();
+        lasts.insert(lasts.begin() + static_cast<std::ptrdiff_t>(b + 1), upper.back());
+        blocks.insert(blocks.begin() + static_cast<std::ptrdiff_t>(b + 1), std::move(upper));
+    }
+}
+
+std::vector<std::uint32_t> RangeIndex::range(std::uint32_t low, std::uint32_t high) const
+{
+    std::vector<std::uint32_t> ids;
+    if (low > high)
+    {
+        return ids;
+    }
+    std::uint64_t first = entry(low, 0);
+    std::uint64_t last = entry(high, UINT32_MAX);
+    std::size_t b = static_cast<std::size_t>(std::lower_bound(lasts.begin(), lasts.end(), first) - lasts.begin());
+    if (b == blocks.size())
+    {
+        return ids;
+    }
+    auto position = std::lower_bound(blocks[b].begin(), blocks[b].end(), first);
+    while (true)
+    {
+        const std::vector<std::uint64_t> &block = blocks[b];
+        // The range ends within the block if the block ends after it
+        auto end = lasts[b] > last ? std::upper_bound(position, block.end(), last) : block.end();
+        for (; position != end; ++position)
+        {
+            ids.push_back(static_cast<std::uint32_t>(*position));
+        }
+        if (end != block.end() || ++b == blocks.size())
+        {
+            break;
+        }
+        position = blocks[b].begin();
+    }
+    return ids;
+}
+
+void RangeIndex::clear()
+{
+    blocks.clear();
+    lasts.clear();
+    entries = 0;
+}
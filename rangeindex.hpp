@@ -0,0 +1,105 @@
+/**
+ * @file rangeindex.hpp
+ * @brief File containing the declaration of the RangeIndex class.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef RANGEINDEX_HPP
+#define RANGEINDEX_HPP
+
+/**
+ * @class RangeIndex
+ * @brief An ordered index from a numeric key to the ids of magazines, for range queries.
+ *
+ * @details Every entry packs the key into the upper and the id into the lower 32 bits of a 64 bit number, so
+ * entries sort by key and then by id and take 8 bytes each. The entries are kept in a B+ tree of two levels: sorted
+ * blocks of at most maxBlockSize entries, and a sorted array with the last entry of every block. Adding an entry
+ * binary searches the array and shifts at most one block, and a full block is split in two. A range query binary
+ * searches the array and the first block and then walks along the blocks, so it takes O(log n + k) for k matches.
+ * A whole library is indexed at once with assign(), which sorts all entries and cuts them into blocks.
+ *
+ * Keys that are not unsigned, such as dates before 1970, are mapped to unsigned keys of the same order with sortable().
+ */
+class RangeIndex
+{
+private:
+    static const std::size_t maxBlockSize = 512;  ///< The number of entries at which a block is split.
+
+    std::vector<std::vector<std::uint64_t>> blocks;  ///< The entries in ascending order, cut into non-empty blocks.
+    std::vector<std::uint64_t> lasts;  ///< The last entry of every block.
+    std::size_t entries = 0;  ///< The number of entries in all blocks.
+
+    /**
+     * @brief Packs a key and an id into an entry.
+     */
+    static std::uint64_t entry(std::uint32_t key, std::uint32_t id) { return static_cast<std::uint64_t>(key) << 32 | id; }
+
+public:
+    /**
+     * @brief Maps a signed key to an unsigned key of the same order.
+     * @param key The signed key.
+     * @return The unsigned key.
+     */
+    static std::uint32_t sortable(std::int32_t key) { return static_cast<std::uint32_t>(key) ^ 0x80000000u; }
+
+    /**
+     * @brief Adds an entry.
+     *
+     * @param key The key of the magazine.
+     * @param id The id of the magazine.
+     */
+    void add(std::uint32_t key, std::uint32_t id);
+
+    /**
+     * @brief Replaces all entries with one entry for every id from 0 to count - 1.
+     *
+     * Sorts all entries at once, which is much faster than adding them one by one when a whole library is loaded.
+     * @param count The number of ids.
+     * @param keyOf Returns the key of an id.
+     */
+    template <typename KeyOf>
+    void assign(std::uint32_t count, KeyOf keyOf)
+    {
+        std::vector<std::uint64_t> all(count);
+        for (std::uint32_t id = 0; id < count; ++id)
+        {
+            all[id] = entry(keyOf(id), id);
+        }
+        std::sort(all.begin(), all.end());
+        clear();
+        // Blocks start half full, so the next entries can be added without splitting right away
+        for (std::size_t first = 0; first < all.size(); first += maxBlockSize / 2)
+        {
+            std::size_t last = std::min(all.size(), first + maxBlockSize / 2);
+            blocks.emplace_back(all.begin() + static_cast<std::ptrdiff_t>(first), all.begin() + static_cast<std::ptrdiff_t>(last));
+            lasts.push_back(all[last - 1]);
+        }
+        entries = all.size();
+    }
+
+    /**
+     * @brief Finds all magazines whose key lies in a range.
+     *
+     * @param low The smallest key to find.
+     * @param high The largest key to find.
+     * @return The ids of all matches, ordered by key and then by id. Empty if low is greater than high.
+     */
+    std::vector<std::uint32_t> range(std::uint32_t low, std::uint32_t high) const;
+
+    /**
+     * @brief Returns the number of entries.
+     * @return The number of entries.
+     */
+    std::size_t size() const { return entries; }
+
+    /**
+     * @brief Removes all entries.
+     */
+    void clear();
+};
+
+#endif // RANGEINDEX_HPP
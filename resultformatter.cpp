@@ -0,0 +1,202 @@
+/**
+ * @file resultformatter.cpp
+ * @brief File containing the implementation of the ResultFormatter class.
+ */
+
+#include "resultformatter.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+/**
+ * @brief Appends an integer without going through a format string.
+ */
+static void appendNumber(std::string &output, int value)
+{
+    char digits[16];
+    output.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+}
+
+/**
+ * @brief Checks whether a price is a whole number of cents that can be written with integers.
+ * @param price The price in Euro.
+ * @param cents Receives the price in cents.
+ * @param limit The number of cents from which on the price has to go through snprintf.
+ */
+static bool wholeCents(double price, long long &cents, long long limit)
+{
+    cents = std::llround(price * 100.0);
+    return price >= 0.0 && cents < limit && std::fabs(price * 100.0 - static_cast<double>(cents)) < 1e-6;
+}
+
+/**
+ * @brief Appends a price like an ostream does by default, which is like printf with %g.
+ *
+ * Prices below 10000 Euro have at most six significant digits, so their cents can be written as integers,
+ * with trailing zeros of the cents left out. Larger prices are rare and go through snprintf.
+ */
+static void appendPrice(std::string &output, double price)
+{
+    long long cents;
+    if (!wholeCents(price, cents, 1000000))
+    {
+        char text[32];
+        std::snprintf(text, sizeof(text), "%g", price);
+        output += text;
+        return;
+    }
+    appendNumber(output, static_cast<int>(cents / 100));
+    int rest = static_cast<int>(cents % 100);
+    if (rest != 0)
+    {
+        output += '.';
+        output += static_cast<char>('0' + rest / 10);
+        if (rest % 10 != 0)
+        {
+            output += static_cast<char>('0' + rest % 10);
+        }
+    }
+}
+
+/**
+ * @brief Appends a price with exactly two decimals, like printf with %.2f.
+ */
+static void appendFixedPrice(std::string &output, double price)
+{
+    long long cents;
+    if (!wholeCents(price, cents, 4000000000LL))
+    {
+        char text[48];
+        std::snprintf(text, sizeof(text), "%.2f", price);
+        output += text;
+        return;
+    }
+    appendNumber(output, static_cast<int>(cents / 100));
+    int rest = static_cast<int>(cents % 100);
+    output += '.';
+    output += static_cast<char>('0' + rest / 10);
+    output += static_cast<char>('0' + rest % 10);
+}
+
+bool ResultFormatter::parseFormat(std::string_view name, ResultFormat &format)
+{
+    if (name == "text")
+    {
+        format = ResultFormat::Text;
+    }
+    else if (name == "tsv")
+    {
+        format = ResultFormat::Tsv;
+    }
+    else if (name == "json")
+    {
+        format = ResultFormat::Json;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+void ResultFormatter::appendJsonString(std::string &output, std::string_view text)
+{
+    output += '"';
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            output += '\\';
+            output += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+            output += escape;
+        }
+        else
+        {
+            output += c;
+        }
+    }
+    output += '"';
+}
+
+void ResultFormatter::append(std::string &output, const Magazine &magazine) const
+{
+    switch (format)
+    {
+    case ResultFormat::Tsv:
+        output += magazine.issn;
+        output += '\t';
+        output += magazine.title;
+        output += '\t';
+        output += magazine.author;
+        output += '\t';
+        output += magazine.publisher;
+        output += '\t';
+        output += magazine.publicationDate;
+        output += '\t';
+        appendFixedPrice(output, magazine.price);
+        output += '\t';
+        appendNumber(output, magazine.stock);
+        output += '\t';
+        appendNumber(output, magazine.borrowedCopies);
+        output += '\n';
+        break;
+    case ResultFormat::Json:
+        output += "{\"issn\":";
+        appendJsonString(output, magazine.issn);
+        output += ",\"title\":";
+        appendJsonString(output, magazine.title);
+        output += ",\"author\":";
+        appendJsonString(output, magazine.author);
+        output += ",\"publisher\":";
+        appendJsonString(output, magazine.publisher);
+        output += ",\"published\":";
+        appendJsonString(output, magazine.publicationDate);
+        output += ",\"price\":";
+        appendFixedPrice(output, magazine.price);
+        output += ",\"stock\":";
+        appendNumber(output, magazine.stock);
+        output += ",\"borrowed\":";
+        appendNumber(output, magazine.borrowedCopies);
+        output += "}\n";
+        break;
+    default:
+        output += "Autor: ";
+        output += magazine.author;
+        output += "\nTitel: ";
+        output += magazine.title;
+        output += "\nVerlag: ";
+        output += magazine.publisher;
+        output += "\nISSN: ";
+        output += magazine.issn;
+        output += "\nErscheinungsdatum: ";
+        output += magazine.publicationDate;
+        output += "\nPreis: ";
+        appendPrice(output, magazine.price);
+        output += " Euro\nAnzahl im Lager: ";
+        appendNumber(output, magazine.stock);
+        output += "\nDavon ausgeliehen: ";
+        appendNumber(output, magazine.borrowedCopies);
+        output += "\n------------------------\n";
+        break;
+    }
+}
+
+std::size_t ResultFormatter::appendPage(std::string &output, const std::vector<Magazine> &magazines, std::size_t offset, std::size_t limit) const
+{
+    if (offset >= magazines.size())
+    {
+        return 0;
+    }
+    std::size_t count = limit == 0 ? magazines.size() - offset : std::min(limit, magazines.size() - offset);
+    for (std::size_t i = offset; i < offset + count; ++i)
+    {
+        append(output, magazines[i]);
+    }
+    return count;
+}
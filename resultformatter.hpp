@@ -0,0 +1,83 @@
+/**
+ * @file resultformatter.hpp
+ * @brief File containing the declaration of the ResultFormatter class.
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "magazine.hpp"
+
+#ifndef RESULTFORMATTER_HPP
+#define RESULTFORMATTER_HPP
+
+/**
+ * @brief The ways ResultFormatter can render a magazine.
+ */
+enum class ResultFormat
+{
+    Text,  ///< One labelled line per field followed by a separator line, for people.
+    Tsv,  ///< One tab separated line: ISSN, title, author, publisher, date, price, stock, borrowed copies.
+    Json  ///< One JSON object per line with the same fields as Tsv.
+};
+
+/**
+ * @class ResultFormatter
+ * @brief Renders magazines of search results into a caller's buffer, shared by the menu, the batch runner and the server.
+ *
+ * @details Nothing is written to a stream: every magazine is appended to a std::string that the caller keeps
+ * between results and writes with a single call, which is much faster than formatting field by field through an
+ * ostream. Results can be rendered a page at a time with an offset and a limit, so a broad search neither floods
+ * a terminal nor has to be rendered as a whole.
+ */
+class ResultFormatter
+{
+private:
+    ResultFormat format;  ///< The format magazines are rendered in.
+
+    /**
+     * @brief Appends a string as JSON string literal, with quotes and escapes.
+     */
+    static void appendJsonString(std::string &output, std::string_view text);
+
+public:
+    /**
+     * @brief Constructs a formatter.
+     * @param format The format magazines are rendered in.
+     */
+    explicit ResultFormatter(ResultFormat format = ResultFormat::Text) : format(format) {}
+
+    /**
+     * @brief Parses the name of a format.
+     *
+     * @param name text, tsv or json.
+     * @param format Receives the format if the name is known.
+     * @return true if the name is known, false otherwise.
+     */
+    static bool parseFormat(std::string_view name, ResultFormat &format);
+
+    ResultFormat getFormat() const { return format; }  ///< @brief Returns the format magazines are rendered in.
+    void setFormat(ResultFormat newFormat) { format = newFormat; }  ///< @brief Sets the format magazines are rendered in.
+
+    /**
+     * @brief Appends a magazine.
+     *
+     * @param output Receives the magazine.
+     * @param magazine The magazine to render.
+     */
+    void append(std::string &output, const Magazine &magazine) const;
+
+    /**
+     * @brief Appends a page of magazines.
+     *
+     * @param output Receives the magazines.
+     * @param magazines All magazines of the result.
+     * @param offset The number of magazines to skip.
+     * @param limit The largest number of magazines to append, 0 for all after the offset.
+     * @return The number of magazines appended.
+     */
+    std::size_t appendPage(std::string &output, const std::vector<Magazine> &magazines, std::size_t offset, std::size_t limit) const;
+};
+
+#endif // RESULTFORMATTER_HPP
@@ -0,0 +1,381 @@
+/**
+ * @file server.cpp
+ * @brief File containing the implementation of the Server class.
+ */
+
+#include "server.hpp"
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define SERVER_USE_EPOLL
+#endif
+
+/**
+ * @brief The number of result bytes waiting for a connection after which no more of its commands are run.
+ */
+static const std::size_t maxBacklog = 1 << 20;
+
+/**
+ * @brief The length of a command line after which the connection is closed.
+ */
+static const std::size_t maxLineLength = 64 * 1024;
+
+/**
+ * @brief The number of events an event loop takes from epoll at once.
+ */
+static const int maxEvents = 256;
+
+Server::Server(Libary &libary, const std::string &databaseFile) : libary(libary), databaseFile(databaseFile)
+{
+}
+
+#ifdef SERVER_USE_EPOLL
+
+Server::~Server()
+{
+    if (listener >= 0)
+    {
+        ::close(listener);
+    }
+    if (wakeup >= 0)
+    {
+        ::close(wakeup);
+    }
+}
+
+bool Server::listen(const std::string &address, std::uint16_t port)
+{
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    sockaddr_in socketAddress{};
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(port);
+    if (::inet_pton(AF_INET, address.c_str(), &socketAddress.sin_addr) != 1)
+    {
+        return false;
+    }
+    listener = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0)
+    {
+        return false;
+    }
+    int one = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    wakeup = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (::bind(listener, reinterpret_cast<sockaddr *>(&socketAddress), sizeof(socketAddress)) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0 || wakeup < 0)
+    {
+        ::close(listener);
+        listener = -1;
+        return false;
+    }
+    return true;
+}
+
+std::uint16_t Server::port() const
+{
+    sockaddr_in socketAddress{};
+    socklen_t length = sizeof(socketAddress);
+    if (listener < 0 || ::getsockname(listener, reinterpret_cast<sockaddr *>(&socketAddress), &length) != 0)
+    {
+        return 0;
+    }
+    return ntohs(socketAddress.sin_port);
+}
+
+void Server::run(unsigned workers)
+{
+    if (listener < 0)
+    {
+        return;
+    }
+    running = true;
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < workers; ++i)
+    {
+        threads.emplace_back(&Server::eventLoop, this);
+    }
+    eventLoop();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    libary.commitJournal();
+}
+
+void Server::stop()
+{
+    running = false;
+    // The counter stays set, so every event loop sees it
+    std::uint64_t one = 1;
+    if (wakeup >= 0 && ::write(wakeup, &one, sizeof(one)) < 0)
+    {
+        // Nothing else can be done from a signal handler
+    }
+}
+
+void Server::acceptConnections(int poller, std::unordered_map<int, std::unique_ptr<Connection>> &connections)
+{
+    while (true)
+    {
+        int fd = ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0)
+        {
+            // Either no connection is left, another loop took it, or no descriptors are left
+            return;
+        }
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        std::unique_ptr<Connection> connection(new Connection);
+        connection->fd = fd;
+        connection->events = EPOLLIN;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = connection.get();
+        if (::epoll_ctl(poller, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            ::close(fd);
+            continue;
+        }
+        connections.emplace(fd, std::move(connection));
+    }
+}
+
+void Server::process(BatchRunner &runner, Connection &connection)
+{
+    std::size_t position = 0;
+    while (connection.output.size() - connection.sent < maxBacklog)
+    {
+        const char *start = connection.input.data() + position;
+        const char *newline = static_cast<const char *>(std::memchr(start, '\n', connection.input.size() - position));
+        if (!newline)
+        {
+            break;
+        }
+        runner.execute(std::string_view(start, newline - start), ++connection.lines, connection.output, connection.options);
+        position = newline - connection.input.data() + 1;
+    }
+    connection.input.erase(0, position);
+    if (connection.input.size() > maxLineLength && !std::memchr(connection.input.data(), '\n', connection.input.size()))
+    {
+        connection.output += "ERR " + std::to_string(connection.lines + 1) + " Zeile zu lang\n";
+        connection.input.clear();
+        connection.closing = true;
+    }
+}
+
+bool Server::send(Connection &connection)
+{
+    while (connection.sent < connection.output.size())
+    {
+        ssize_t written = ::send(connection.fd, connection.output.data() + connection.sent, connection.output.size() - connection.sent, MSG_NOSIGNAL);
+        if (written > 0)
+        {
+            connection.sent += static_cast<std::size_t>(written);
+        }
+        else if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            break;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (connection.sent == connection.output.size())
+    {
+        connection.output.clear();
+        connection.sent = 0;
+    }
+    else if (connection.sent >= maxBacklog)
+    {
+        connection.output.erase(0, connection.sent);
+        connection.sent = 0;
+    }
+    return true;
+}
+
+void Server::watch(int poller, Connection &connection)
+{
+    std::uint32_t events = 0;
+    if (!connection.closing && connection.output.size() - connection.sent < maxBacklog)
+    {
+        events |= EPOLLIN;
+    }
+    if (connection.sent < connection.output.size())
+    {
+        events |= EPOLLOUT;
+    }
+    if (events != connection.events)
+    {
+        epoll_event event{};
+        event.events = events;
+        event.data.ptr = &connection;
+        ::epoll_ctl(poller, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = events;
+    }
+}
+
+void Server::eventLoop()
+{
+    int poller = ::epoll_create1(EPOLL_CLOEXEC);
+    if (poller < 0)
+    {
+        return;
+    }
+    // The listening socket is marked with nullptr and the wakeup eventfd with the server itself
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    event.data.ptr = nullptr;
+    ::epoll_ctl(poller, EPOLL_CTL_ADD, listener, &event);
+    event.events = EPOLLIN;
+    event.data.ptr = this;
+    ::epoll_ctl(poller, EPOLL_CTL_ADD, wakeup, &event);
+
+    BatchRunner runner(libary, databaseFile, false);
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    std::vector<Connection *> pending;  // Connections with results to send in this round
+    std::vector<Connection *> ready;  // Connections whose remaining commands wait for their results to drain
+    epoll_event events[maxEvents];
+    char chunk[64 * 1024];
+    auto queue = [&pending](Connection *connection)
+    {
+        if (!connection->queued)
+        {
+            connection->queued = true;
+            pending.push_back(connection);
+        }
+    };
+
+    while (running)
+    {
+        int count = ::epoll_wait(poller, events, maxEvents, ready.empty() ? -1 : 0);
+        if (count < 0 && errno != EINTR)
+        {
+            break;
+        }
+        for (Connection *connection : ready)
+        {
+            process(runner, *connection);
+            queue(connection);
+        }
+        ready.clear();
+        for (int i = 0; i < count; ++i)
+        {
+            if (events[i].data.ptr == nullptr)
+            {
+                acceptConnections(poller, connections);
+                continue;
+            }
+            if (events[i].data.ptr == this)
+            {
+                continue;
+            }
+            Connection *connection = static_cast<Connection *>(events[i].data.ptr);
+            if (events[i].events & EPOLLIN)
+            {
+                ssize_t received = ::recv(connection->fd, chunk, sizeof(chunk), 0);
+                if (received > 0)
+                {
+                    connection->input.append(chunk, static_cast<std::size_t>(received));
+                }
+                else if (received == 0)
+                {
+                    // A last command without a line break is still run, like the last line of a batch file
+                    if (!connection->input.empty() && connection->input.back() != '\n')
+                    {
+                        connection->input += '\n';
+                    }
+                    connection->closing = true;
+                }
+                else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                {
+                    connection->broken = true;
+                }
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                connection->broken = true;
+            }
+            if (!connection->broken)
+            {
+                process(runner, *connection);
+            }
+            queue(connection);
+        }
+
+        // Results are only sent once the changes they report are in the journal. If it cannot be written, the
+        // connections of this round are closed instead, so no client is told of a change that is not on disk.
+        bool committed = pending.empty() || libary.commitJournal();
+        for (Connection *connection : pending)
+        {
+            connection->queued = false;
+            bool alive = committed && !connection->broken && send(*connection);
+            bool waiting = std::memchr(connection->input.data(), '\n', connection->input.size()) != nullptr;
+            if (!alive || (connection->closing && connection->output.empty() && !waiting))
+            {
+                int fd = connection->fd;
+                connections.erase(fd);
+                ::close(fd);
+                continue;
+            }
+            if (waiting && connection->output.size() - connection->sent < maxBacklog)
+            {
+                ready.push_back(connection);
+            }
+            watch(poller, *connection);
+        }
+        pending.clear();
+    }
+
+    for (auto &entry : connections)
+    {
+        ::close(entry.first);
+    }
+    ::close(poller);
+}
+
+#else
+
+Server::~Server()
+{
+}
+
+bool Server::listen(const std::string &, std::uint16_t)
+{
+    return false;
+}
+
+std::uint16_t Server::port() const
+{
+    return 0;
+}
+
+void Server::run(unsigned)
+{
+}
+
+void Server::stop()
+{
+}
+
+#endif
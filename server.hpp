@@ -0,0 +1,148 @@
+/**
+ * @file server.hpp
+ * @brief File containing the declaration of the Server class.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "libary.hpp"
+#include "batchrunner.hpp"
+
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+/**
+ * @class Server
+ * @brief Serves a Libary to many terminals over TCP.
+ *
+ * @details Clients send the same tab separated command lines as in batch mode and receive the same result lines,
+ * see BatchRunner. A client may send many commands without waiting for their results; the results come back in the
+ * order the commands were sent. A last command without a line break is run once the client stops sending. The
+ * commands save with a file name and import are not available over the network.
+ *
+ * Every worker thread runs its own epoll event loop. All loops wait on the same listening socket, and the kernel
+ * hands each new connection to one of them, which then serves it until it is closed. A loop first runs the commands
+ * of all connections that became readable, then commits the journal once for all of them, and only then sends the
+ * results, so a client never sees a change that is not on disk, while the cost of writing the journal is shared by
+ * everything that happened in one round. If the journal cannot be written, the connections of the round are closed
+ * without their results. A connection that does not read its results is no longer read from once a megabyte of
+ * results is waiting for it.
+ *
+ * The server needs epoll and is only available on Linux.
+ */
+class Server
+{
+private:
+    /**
+     * @struct Connection
+     * @brief The state of one client connection.
+     */
+    struct Connection
+    {
+        int fd = -1;  ///< The socket.
+        std::string input;  ///< Received bytes that do not form a complete command yet, or wait for the results to drain.
+        std::string output;  ///< Results that have not been sent yet, from position sent on.
+        std::size_t sent = 0;  ///< The number of bytes of output that were sent.
+        std::size_t lines = 0;  ///< The number of command lines received, used as line number in error results.
+        std::uint32_t events = 0;  ///< The events the loop currently waits for.
+        bool closing = false;  ///< Whether the client finished sending or the connection broke.
+        bool broken = false;  ///< Whether the connection broke and is closed without sending the remaining results.
+        bool queued = false;  ///< Whether the connection is in the list of connections to send to in this round.
+        ResultOptions options;  ///< The result format and page the client chose.
+    };
+
+    Libary &libary;  ///< The library the commands run against.
+    std::string databaseFile;  ///< The database file that save without a file name compacts.
+    int listener = -1;  ///< The listening socket, -1 if not listening.
+    int wakeup = -1;  ///< An eventfd that wakes all event loops when the server stops.
+    std::atomic<bool> running{false};  ///< Whether the event loops keep running.
+
+    /**
+     * @brief Runs one event loop until stop() is called.
+     */
+    void eventLoop();
+
+    /**
+     * @brief Accepts all pending connections.
+     *
+     * @param poller The epoll instance of the calling event loop.
+     * @param connections Receives the new connections.
+     */
+    void acceptConnections(int poller, std::unordered_map<int, std::unique_ptr<Connection>> &connections);
+
+    /**
+     * @brief Runs the complete commands received on a connection, as long as not too many results are waiting.
+     *
+     * @param runner The batch runner of the calling event loop.
+     * @param connection The connection.
+     */
+    static void process(BatchRunner &runner, Connection &connection);
+
+    /**
+     * @brief Sends as many waiting results as the socket takes without blocking.
+     *
+     * @param connection The connection.
+     * @return false if the connection broke, true otherwise.
+     */
+    static bool send(Connection &connection);
+
+    /**
+     * @brief Tells epoll which events of a connection the loop waits for.
+     *
+     * @param poller The epoll instance of the calling event loop.
+     * @param connection The connection.
+     */
+    static void watch(int poller, Connection &connection);
+
+public:
+    /**
+     * @brief Creates a server that is not listening yet.
+     *
+     * @param libary The library to serve.
+     * @param databaseFile The database file that save without a file name compacts.
+     */
+    Server(Libary &libary, const std::string &databaseFile);
+    Server(const Server &) = delete;
+    Server &operator=(const Server &) = delete;
+
+    /**
+     * @brief Closes the listening socket.
+     */
+    ~Server();
+
+    /**
+     * @brief Starts listening for connections.
+     *
+     * Also raises the limit of open files of the process as far as allowed, since every connection needs one.
+     * @param address The IPv4 address to listen on, 0.0.0.0 for all interfaces.
+     * @param port The port to listen on, 0 for any free port.
+     * @return true if the server is listening, false otherwise.
+     */
+    bool listen(const std::string &address, std::uint16_t port);
+
+    /**
+     * @brief Returns the port the server is listening on.
+     * @return The port, 0 if the server is not listening.
+     */
+    std::uint16_t port() const;
+
+    /**
+     * @brief Serves connections until stop() is called.
+     *
+     * All connections are closed and the journal is committed before the function returns.
+     * @param workers The number of event loops, each on its own thread, at least 1.
+     */
+    void run(unsigned workers);
+
+    /**
+     * @brief Makes run() return. May be called from any thread and from a signal handler.
+     */
+    void stop();
+};
+
+#endif // SERVER_HPP
@@ -0,0 +1,253 @@
+/**
+ * @file shardedlibary.cpp
+ * @brief File containing the implementation of the ShardedLibary class.
+ */
+
+#include "shardedlibary.hpp"
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include "utils.hpp"
+
+ShardedLibary::ShardedLibary(std::size_t shardCount, unsigned threadCount) : pool(threadCount)
+{
+    for (std::size_t i = 0; i < std::max<std::size_t>(1, shardCount); ++i)
+    {
+        shards.emplace_back(new Libary);
+    }
+}
+
+std::size_t ShardedLibary::shardOf(const std::string &issn) const
+{
+    std::uint32_t packed;
+    if (Utils::parseISSN(issn, packed) == ISSNStatus::Malformed)
+    {
+        return 0;
+    }
+    // Neighbouring ISSNs of one publisher differ only in the low bits, the multiplication spreads them over all shards
+    return static_cast<std::size_t>((packed * 0x9E3779B97F4A7C15ULL) >> 32) % shards.size();
+}
+
+std::string ShardedLibary::shardFile(const std::string &filename, std::size_t shard) const
+{
+    return filename + "." + std::to_string(shard) + "-" + std::to_string(shards.size());
+}
+
+std::vector<Magazine> ShardedLibary::join(std::vector<std::vector<Magazine>> results)
+{
+    std::size_t total = 0;
+    for (const std::vector<Magazine> &result : results)
+    {
+        total += result.size();
+    }
+    std::vector<Magazine> joined;
+    joined.reserve(total);
+    for (std::vector<Magazine> &result : results)
+    {
+        std::move(result.begin(), result.end(), std::back_inserter(joined));
+    }
+    return joined;
+}
+
+bool ShardedLibary::addMagazine(const Magazine &magazine)
+{
+    return shards[shardOf(magazine.issn)]->addMagazine(magazine);
+}
+
+bool ShardedLibary::magazineExists(const std::string &issn)
+{
+    return shards[shardOf(issn)]->magazineExists(issn);
+}
+
+bool ShardedLibary::increaseStock(const std::string &issn, int increaseAmount)
+{
+    return shards[shardOf(issn)]->increaseStock(issn, increaseAmount);
+}
+
+std::optional<Magazine> ShardedLibary::searchByISSN(const std::string &issn)
+{
+    return shards[shardOf(issn)]->searchByISSN(issn);
+}
+
+bool ShardedLibary::borrowMagazine(Magazine &magazine)
+{
+    return shards[shardOf(magazine.issn)]->borrowMagazine(magazine);
+}
+
+bool ShardedLibary::returnMagazine(Magazine &magazine)
+{
+    return shards[shardOf(magazine.issn)]->returnMagazine(magazine);
+}
+
+std::vector<MergeOutcome> ShardedLibary::mergeMagazines(const std::vector<Magazine> &magazines)
+{
+    // The magazines of every shard, and where each of them stands in the given order
+    std::vector<std::vector<Magazine>> parts(shards.size());
+    std::vector<std::vector<std::size_t>> positions(shards.size());
+    for (std::size_t i = 0; i < magazines.size(); ++i)
+    {
+        std::size_t shard = shardOf(magazines[i].issn);
+        parts[shard].push_back(magazines[i]);
+        positions[shard].push_back(i);
+    }
+    std::vector<MergeOutcome> outcomes(magazines.size(), MergeOutcome::Invalid);
+    pool.forEach(shards.size(), [&](std::size_t shard)
+                 {
+                     if (parts[shard].empty())
+                     {
+                         return;
+                     }
+                     std::vector<MergeOutcome> merged = shards[shard]->mergeMagazines(parts[shard]);
+                     for (std::size_t i = 0; i < merged.size(); ++i)
+                     {
+                         outcomes[positions[shard][i]] = merged[i];
+                     }
+                 });
+    return outcomes;
+}
+
+std::vector<Magazine> ShardedLibary::searchByTitle(const std::string &title)
+{
+    return gather([&](Libary &libary)
+                  { return libary.searchByTitle(title); });
+}
+
+std::vector<Magazine> ShardedLibary::searchByAuthor(const std::string &author)
+{
+    return gather([&](Libary &libary)
+                  { return libary.searchByAuthor(author); });
+}
+
+std::vector<Magazine> ShardedLibary::searchByPublisher(const std::string &publisher)
+{
+    return gather([&](Libary &libary)
+                  { return libary.searchByPublisher(publisher); });
+}
+
+std::vector<Magazine> ShardedLibary::listAvailable()
+{
+    return gather([](Libary &libary)
+                  { return libary.listAvailable(); });
+}
+
+std::vector<Magazine> ShardedLibary::searchByDate(const std::string &from, const std::string &to)
+{
+    std::vector<Magazine> magazines = gather([&](Libary &libary)
+                                             { return libary.searchByDate(from, to); });
+    // Every shard returns only valid dates, oldest first, so sorting by the day keeps the order within a day
+    std::stable_sort(magazines.begin(), magazines.end(), [](const Magazine &a, const Magazine &b)
+                     { return Utils::dateToDays(a.publicationDate) < Utils::dateToDays(b.publicationDate); });
+    return magazines;
+}
+
+std::vector<Magazine> ShardedLibary::searchByPrice(double minimum, double maximum)
+{
+    std::vector<Magazine> magazines = gather([&](Libary &libary)
+                                             { return libary.searchByPrice(minimum, maximum); });
+    std::stable_sort(magazines.begin(), magazines.end(), [](const Magazine &a, const Magazine &b)
+                     { return a.price < b.price; });
+    return magazines;
+}
+
+std::vector<Magazine> ShardedLibary::mostBorrowed(std::size_t count)
+{
+    // The overall leaders are among the leaders of their shard, so no shard has to return more than count
+    std::vector<Magazine> magazines = gather([&](Libary &libary)
+                                             { return libary.mostBorrowed(count); });
+    std::stable_sort(magazines.begin(), magazines.end(), [](const Magazine &a, const Magazine &b)
+                     { return a.borrowedCopies > b.borrowedCopies; });
+    if (magazines.size() > count)
+    {
+        magazines.erase(magazines.begin() + static_cast<std::ptrdiff_t>(count), magazines.end());
+    }
+    return magazines;
+}
+
+std::vector<Magazine> ShardedLibary::leastAvailable(int maximumAvailable, std::size_t limit)
+{
+    std::vector<Magazine> magazines = gather([&](Libary &libary)
+                                             { return libary.leastAvailable(maximumAvailable, limit); });
+    std::stable_sort(magazines.begin(), magazines.end(), [](const Magazine &a, const Magazine &b)
+                     { return a.stock - a.borrowedCopies < b.stock - b.borrowedCopies; });
+    if (limit > 0 && magazines.size() > limit)
+    {
+        magazines.erase(magazines.begin() + static_cast<std::ptrdiff_t>(limit), magazines.end());
+    }
+    return magazines;
+}
+
+InventoryFigures ShardedLibary::inventoryTotals()
+{
+    InventoryFigures totals;
+    for (const InventoryFigures &figures : scatter<InventoryFigures>([](Libary &libary)
+                                                                      { return libary.inventoryTotals(); }))
+    {
+        totals.magazines += figures.magazines;
+        totals.stock += figures.stock;
+        totals.borrowed += figures.borrowed;
+        totals.valueCents += figures.valueCents;
+    }
+    return totals;
+}
+
+std::size_t ShardedLibary::size()
+{
+    std::size_t total = 0;
+    for (std::size_t shard = 0; shard < shards.size(); ++shard)
+    {
+        total += shards[shard]->size();
+    }
+    return total;
+}
+
+bool ShardedLibary::loadFromFiles(const std::string &filename)
+{
+    std::atomic<bool> loaded{false};
+    pool.forEach(shards.size(), [&](std::size_t shard)
+                 {
+                     if (shards[shard]->loadFromFile(shardFile(filename, shard)))
+                     {
+                         loaded = true;
+                     }
+                 });
+    return loaded;
+}
+
+bool ShardedLibary::openJournals(const std::string &filename, std::size_t groupCommitSize)
+{
+    std::atomic<bool> opened{true};
+    pool.forEach(shards.size(), [&](std::size_t shard)
+                 {
+                     if (!shards[shard]->openJournal(shardFile(filename, shard), groupCommitSize))
+                     {
+                         opened = false;
+                     }
+                 });
+    return opened;
+}
+
+bool ShardedLibary::commitJournals()
+{
+    std::atomic<bool> committed{true};
+    pool.forEach(shards.size(), [&](std::size_t shard)
+                 {
+                     if (!shards[shard]->commitJournal())
+                     {
+                         committed = false;
+                     }
+                 });
+    return committed;
+}
+
+bool ShardedLibary::compact(const std::string &filename)
+{
+    std::atomic<bool> compacted{true};
+    pool.forEach(shards.size(), [&](std::size_t shard)
+                 {
+                     if (!shards[shard]->compact(shardFile(filename, shard)))
+                     {
+                         compacted = false;
+                     }
+                 });
+    return compacted;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file shardedlibary.hpp
+ * @brief File containing the declaration of the ShardedLibary class.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "libary.hpp"
+#include "threadpool.hpp"
+
+#ifndef SHARDEDLIBARY_HPP
+#define SHARDEDLIBARY_HPP
+
+/**
+ * @class ShardedLibary
+ * @brief A catalogue split by ISSN into several independent libraries, for machines with many cores.
+ *
+ * @details Every magazine belongs to exactly one shard, chosen by a hash of its ISSN. Each shard is a complete
+ * Libary with its own store, indexes, lock, database file and journal, so adding a magazine to one shard does not
+ * stop anybody from borrowing from another one. Operations on a single ISSN go to its shard only. Searches and
+ * aggregates run on all shards at once on a thread pool, and their results are merged: searches that are ordered
+ * by date, price or copies keep that order, the others return the magazines shard by shard.
+ *
+ * A change of copies with Libary::changeCopies() is only atomic within one library, so it is not offered here. The
+ * shards must always be loaded with the number of shards they were saved with; the file names contain the number
+ * of shards, so files of a different split are simply not found.
+ */
+class ShardedLibary
+{
+private:
+    std::vector<std::unique_ptr<Libary>> shards;  ///< The shards, each holding the magazines whose ISSN hashes to it.
+    ThreadPool pool;  ///< Runs the shards' part of searches and aggregates.
+
+    /**
+     * @brief Returns the shard an ISSN belongs to. Malformed ISSNs go to the first shard, which rejects them.
+     */
+    std::size_t shardOf(const std::string &issn) const;
+
+    /**
+     * @brief Returns the name of the file of a shard.
+     */
+    std::string shardFile(const std::string &filename, std::size_t shard) const;
+
+    /**
+     * @brief Runs a query on every shard in parallel.
+     *
+     * @param query Called with every shard.
+     * @return The result of every shard, in the order of the shards.
+     */
+    template <typename Result, typename Query>
+    std::vector<Result> scatter(Query query)
+    {
+        std::vector<Result> results(shards.size());
+        pool.forEach(shards.size(), [&](std::size_t shard)
+                     { results[shard] = query(*shards[shard]); });
+        return results;
+    }
+
+    /**
+     * @brief Runs a search on every shard in parallel and joins the results.
+     *
+     * @param search Called with every shard.
+     * @return The magazines found, those of the first shard first.
+     */
+    template <typename Search>
+    std::vector<Magazine> gather(Search search)
+    {
+        return join(scatter<std::vector<Magazine>>(search));
+    }
+
+    /**
+     * @brief Joins the results of all shards into one.
+     */
+    static std::vector<Magazine> join(std::vector<std::vector<Magazine>> results);
+
+public:
+    /**
+     * @brief Creates empty shards.
+     *
+     * @param shardCount The number of shards, at least 1.
+     * @param threadCount The number of threads that run searches besides the caller, by default one less than
+     * the number of cores.
+     */
+    explicit ShardedLibary(std::size_t shardCount, unsigned threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1);
+    ShardedLibary(const ShardedLibary &) = delete;
+    ShardedLibary &operator=(const ShardedLibary &) = delete;
+
+    std::size_t shardCount() const { return shards.size(); }  ///< @brief Returns the number of shards.
+
+    /**
+     * @brief Gives access to one shard, for example to run a BatchRunner against it.
+     * @param shard The index of the shard, below shardCount().
+     * @return The shard.
+     */
+    Libary &shard(std::size_t shard) { return *shards[shard]; }
+
+    bool addMagazine(const Magazine &magazine);  ///< @brief Adds a magazine to its shard, see Libary::addMagazine().
+    bool magazineExists(const std::string &issn);  ///< @brief Checks the shard of an ISSN, see Libary::magazineExists().
+    bool increaseStock(const std::string &issn, int increaseAmount);  ///< @brief Changes the stock in the shard of an ISSN, see Libary::increaseStock().
+    std::optional<Magazine> searchByISSN(const std::string &issn);  ///< @brief Looks up the shard of an ISSN, see Libary::searchByISSN().
+    bool borrowMagazine(Magazine &magazine);  ///< @brief Borrows from the shard of the magazine, see Libary::borrowMagazine().
+    bool returnMagazine(Magazine &magazine);  ///< @brief Returns to the shard of the magazine, see Libary::returnMagazine().
+
+    /**
+     * @brief Adds many magazines at once, or increases the stock of those whose ISSN already exists.
+     *
+     * The magazines are split by shard and every shard merges its part in parallel, see Libary::mergeMagazines().
+     * @param magazines The magazines to merge.
+     * @return The outcome for every magazine, in the same order.
+     */
+    std::vector<MergeOutcome> mergeMagazines(const std::vector<Magazine> &magazines);
+
+    /**
+     * @brief Searches all shards by title, see Libary::searchByTitle().
+     * @return The matching magazines, shard by shard.
+     */
+    std::vector<Magazine> searchByTitle(const std::string &title);
+
+    /**
+     * @brief Searches all shards by author, see Libary::searchByAuthor().
+     * @return The magazines of the author, shard by shard.
+     */
+    std::vector<Magazine> searchByAuthor(const std::string &author);
+
+    /**
+     * @brief Searches all shards by publisher, see Libary::searchByPublisher().
+     * @return The magazines of the publisher, shard by shard.
+     */
+    std::vector<Magazine> searchByPublisher(const std::string &publisher);
+
+    /**
+     * @brief Lists the available magazines of all shards, see Libary::listAvailable().
+     * @return The available magazines, shard by shard.
+     */
+    std::vector<Magazine> listAvailable();
+
+    /**
+     * @brief Searches all shards for magazines published in a period, see Libary::searchByDate().
+     * @return The magazines, oldest first.
+     */
+    std::vector<Magazine> searchByDate(const std::string &from, const std::string &to);
+
+    /**
+     * @brief Searches all shards for magazines in a price range, see Libary::searchByPrice().
+     * @return The magazines, cheapest first.
+     */
+    std::vector<Magazine> searchByPrice(double minimum, double maximum);
+
+    /**
+     * @brief Lists the magazines with the most borrowed copies over all shards, see Libary::mostBorrowed().
+     * @return The magazines, most borrowed copies first.
+     */
+    std::vector<Magazine> mostBorrowed(std::size_t count);
+
+    /**
+     * @brief Lists the magazines of all shards with few copies left, see Libary::leastAvailable().
+     * @return The magazines, fewest available copies first.
+     */
+    std::vector<Magazine> leastAvailable(int maximumAvailable, std::size_t limit = 0);
+
+    /**
+     * @brief Sums the inventory totals of all shards, see Libary::inventoryTotals().
+     * @return The totals over all magazines.
+     */
+    InventoryFigures inventoryTotals();
+
+    /**
+     * @brief Returns the number of magazines in all shards.
+     */
+    std::size_t size();
+
+    /**
+     * @brief Loads every shard from its own file, all at once.
+     *
+     * The file of a shard is named like the given file, followed by the index and the number of shards,
+     * for example magazine.txt.2-8.
+     * @param filename The name the shard files are derived from.
+     * @return true if at least one shard loaded magazines, false otherwise.
+     */
+    bool loadFromFiles(const std::string &filename);
+
+    /**
+     * @brief Opens the journal of every shard, see Libary::openJournal(). The names are derived like in loadFromFiles().
+     * @return true if all journals were opened, false otherwise.
+     */
+    bool openJournals(const std::string &filename, std::size_t groupCommitSize = 1);
+
+    /**
+     * @brief Writes the pending journal records of every shard, see Libary::commitJournal().
+     * @return true if all records are on disk, false otherwise.
+     */
+    bool commitJournals();
+
+    /**
+     * @brief Compacts the file and journal of every shard, all at once, see Libary::compact().
+     * @param filename The name the shard files are derived from, see loadFromFiles().
+     * @return true if every shard was compacted, false otherwise.
+     */
+    bool compact(const std::string &filename);
+};
+
+#endif // SHARDEDLIBARY_HPP
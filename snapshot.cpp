@@ -0,0 +1,266 @@
+/**
+ * @file snapshot.cpp
+ * @brief File containing the implementation of the BinarySnapshot class.
+ */
+
+#include "snapshot.hpp"
+#include "utils.hpp"
+#include <cstring>
+#include <fstream>
+
+/**
+ * @brief The magic bytes at the start of every snapshot.
+ */
+static const char snapshotMagic[8] = {'M', 'A', 'G', 'S', 'N', 'A', 'P', '\0'};
+
+/**
+ * @struct SnapshotHeader
+ * @brief The fixed size header at the start of every snapshot.
+ */
+struct SnapshotHeader
+{
+    char magic[8];  ///< Always snapshotMagic.
+    std::uint32_t version;  ///< The version of the format.
+    std::uint32_t nameCount;  ///< The number of distinct authors and publishers.
+    std::uint64_t recordCount;  ///< The number of magazines.
+    std::uint64_t checksum;  ///< The checksum of everything after the header.
+};
+
+/**
+ * @struct SnapshotLayout
+ * @brief The offsets of all sections of a snapshot, relative to the start of the file.
+ */
+struct SnapshotLayout
+{
+    std::size_t issns;  ///< uint32_t packed ISSN per record.
+    std::size_t dates;  ///< int32_t days since 01.01.1970 per record.
+    std::size_t prices;  ///< uint32_t price in cents per record.
+    std::size_t stocks;  ///< uint16_t stock per record.
+    std::size_t borrowed;  ///< uint16_t borrowed copies per record.
+    std::size_t authorIds;  ///< uint32_t author id per record.
+    std::size_t publisherIds;  ///< uint32_t publisher id per record.
+    std::size_t stringOffsets;  ///< uint64_t start of every string in the blob plus the end of the blob.
+    std::size_t stringCount;  ///< The number of strings in the blob, the titles followed by the names.
+    std::size_t strings;  ///< The blob with the strings.
+};
+
+/**
+ * @brief Rounds a size up to the next multiple of eight.
+ */
+static std::size_t align8(std::size_t size)
+{
+    return (size + 7) & ~std::size_t(7);
+}
+
+/**
+ * @brief Computes the section offsets for a given number of records and names.
+ */
+static SnapshotLayout layoutFor(std::size_t count, std::size_t nameCount)
+{
+    SnapshotLayout layout;
+    layout.issns = sizeof(SnapshotHeader);
+    layout.dates = align8(layout.issns + count * sizeof(std::uint32_t));
+    layout.prices = align8(layout.dates + count * sizeof(std::int32_t));
+    layout.stocks = align8(layout.prices + count * sizeof(std::uint32_t));
+    layout.borrowed = align8(layout.stocks + count * sizeof(std::uint16_t));
+    layout.authorIds = align8(layout.borrowed + count * sizeof(std::uint16_t));
+    layout.publisherIds = align8(layout.authorIds + count * sizeof(std::uint32_t));
+    layout.stringOffsets = align8(layout.publisherIds + count * sizeof(std::uint32_t));
+    layout.stringCount = count + nameCount;
+    layout.strings = layout.stringOffsets + (layout.stringCount + 1) * sizeof(std::uint64_t);
+    return layout;
+}
+
+/**
+ * @brief Copies a single value of a fixed width column into the snapshot buffer.
+ */
+template <typename T>
+static void writeColumn(std::string &buffer, std::size_t offset, std::size_t index, T value)
+{
+    std::memcpy(&buffer[offset + index * sizeof(T)], &value, sizeof(T));
+}
+
+/**
+ * @brief Reads a single value of a fixed width column.
+ */
+template <typename T>
+static T readColumn(const char *data, std::size_t offset, std::size_t index)
+{
+    T value;
+    std::memcpy(&value, data + offset + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Returns a string of the blob.
+ */
+static std::string_view readString(const char *data, const SnapshotLayout &layout, std::size_t index)
+{
+    std::uint64_t begin = readColumn<std::uint64_t>(data, layout.stringOffsets, index);
+    std::uint64_t end = readColumn<std::uint64_t>(data, layout.stringOffsets, index + 1);
+    return std::string_view(data + layout.strings + begin, static_cast<std::size_t>(end - begin));
+}
+
+/**
+ * @brief Copies a whole fixed width column of the store into the snapshot buffer, one chunk at a time.
+ */
+template <typename T>
+static void writeWholeColumn(std::string &buffer, std::size_t offset, const ChunkedColumn<T> &column)
+{
+    for (std::uint32_t chunk = 0; chunk < column.chunkCount(); ++chunk)
+    {
+        std::size_t position = offset + (static_cast<std::size_t>(chunk) << ChunkedColumn<T>::chunkBits) * sizeof(T);
+        std::memcpy(&buffer[position], column.chunk(chunk), column.chunkLength(chunk) * sizeof(T));
+    }
+}
+
+/**
+ * @brief Copies a whole fixed width column from the snapshot into a column of the store.
+ */
+template <typename T>
+static void readWholeColumn(const char *data, std::size_t offset, std::size_t count, ChunkedColumn<T> &column)
+{
+    column.clear();
+    column.append(data + offset, count);
+}
+
+bool BinarySnapshot::isSnapshot(const char *data, std::size_t size)
+{
+    return size >= sizeof(snapshotMagic) && std::memcmp(data, snapshotMagic, sizeof(snapshotMagic)) == 0;
+}
+
+bool BinarySnapshot::write(const std::string &filename, const MagazineStore &store)
+{
+    std::size_t count = store.size();
+    std::uint32_t nameCount = store.names.size();
+    SnapshotLayout layout = layoutFor(count, nameCount);
+    std::size_t blobSize = 0;
+    for (std::uint32_t row = 0; row < count; ++row)
+    {
+        blobSize += store.title(row).size();
+    }
+    for (std::uint32_t id = 0; id < nameCount; ++id)
+    {
+        blobSize += store.name(id).size();
+    }
+
+    // The numeric columns are copied as a whole, like they are stored in memory
+    std::string buffer(layout.strings + blobSize, '\0');
+    writeWholeColumn(buffer, layout.issns, store.issns);
+    writeWholeColumn(buffer, layout.dates, store.dates);
+    writeWholeColumn(buffer, layout.prices, store.prices);
+    writeWholeColumn(buffer, layout.authorIds, store.authors);
+    writeWholeColumn(buffer, layout.publisherIds, store.publishers);
+
+    // Stock and borrowed copies share an atomic word in memory but have columns of their own in the file
+    for (std::uint32_t row = 0; row < count; ++row)
+    {
+        int stock;
+        int borrowedCopies;
+        store.copiesOf(row, stock, borrowedCopies);
+        writeColumn<std::uint16_t>(buffer, layout.stocks, row, static_cast<std::uint16_t>(stock));
+        writeColumn<std::uint16_t>(buffer, layout.borrowed, row, static_cast<std::uint16_t>(borrowedCopies));
+    }
+
+    // Titles come first, then every name once in the order of its id
+    std::uint64_t stringOffset = 0;
+    std::size_t blobPosition = layout.strings;
+    for (std::size_t i = 0; i < layout.stringCount; ++i)
+    {
+        std::string_view text = i < count ? store.title(static_cast<std::uint32_t>(i)) : store.name(static_cast<std::uint32_t>(i - count));
+        writeColumn<std::uint64_t>(buffer, layout.stringOffsets, i, stringOffset);
+        std::memcpy(&buffer[blobPosition], text.data(), text.size());
+        blobPosition += text.size();
+        stringOffset += text.size();
+    }
+    writeColumn<std::uint64_t>(buffer, layout.stringOffsets, layout.stringCount, stringOffset);
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = version;
+    header.nameCount = nameCount;
+    header.recordCount = count;
+    header.checksum = Utils::checksum(buffer.data() + sizeof(header), buffer.size() - sizeof(header));
+    std::memcpy(&buffer[0], &header, sizeof(header));
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.close();
+    return !file.fail();
+}
+
+bool BinarySnapshot::read(const char *data, std::size_t size, MagazineStore &store, std::string &error)
+{
+    SnapshotHeader header;
+    if (!isSnapshot(data, size) || size < sizeof(header))
+    {
+        error = "Keine gueltige Snapshot-Datei";
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != version)
+    {
+        error = "Unbekannte Snapshot-Version " + std::to_string(header.version);
+        return false;
+    }
+
+    // A damaged record count must not lead to reads beyond the end of the file
+    std::size_t count = static_cast<std::size_t>(header.recordCount);
+    std::size_t nameCount = header.nameCount;
+    if (header.recordCount > size / 8 || nameCount > size / 8 || layoutFor(count, nameCount).strings > size)
+    {
+        error = "Snapshot ist unvollstaendig";
+        return false;
+    }
+    if (Utils::checksum(data + sizeof(header), size - sizeof(header)) != header.checksum)
+    {
+        error = "Pruefsumme des Snapshots stimmt nicht";
+        return false;
+    }
+
+    SnapshotLayout layout = layoutFor(count, nameCount);
+    std::size_t blobSize = size - layout.strings;
+    for (std::size_t i = 0; i < layout.stringCount; ++i)
+    {
+        std::uint64_t begin = readColumn<std::uint64_t>(data, layout.stringOffsets, i);
+        std::uint64_t end = readColumn<std::uint64_t>(data, layout.stringOffsets, i + 1);
+        if (begin > end || end > blobSize)
+        {
+            error = "Snapshot ist beschaedigt";
+            return false;
+        }
+    }
+
+    store.clear();
+    readWholeColumn(data, layout.issns, count, store.issns);
+    readWholeColumn(data, layout.dates, count, store.dates);
+    readWholeColumn(data, layout.prices, count, store.prices);
+    store.copies.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        store.copies.push_back(CopyCounter::pack(readColumn<std::uint16_t>(data, layout.stocks, i), readColumn<std::uint16_t>(data, layout.borrowed, i)));
+    }
+    for (std::size_t id = 0; id < nameCount; ++id)
+    {
+        // The names were written in the order of their ids, so interning them again hands out the same ids
+        if (store.names.intern(readString(data, layout, count + id)) != id)
+        {
+            error = "Snapshot ist beschaedigt";
+            store.clear();
+            return false;
+        }
+    }
+    readWholeColumn(data, layout.authorIds, count, store.authors);
+    readWholeColumn(data, layout.publisherIds, count, store.publishers);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        if (store.authors[i] >= nameCount || store.publishers[i] >= nameCount)
+        {
+            error = "Snapshot ist beschaedigt";
+            store.clear();
+            return false;
+        }
+        store.titles.push_back(store.strings.append(readString(data, layout, i)));
+    }
+    return true;
+}
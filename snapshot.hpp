@@ -0,0 +1,72 @@
+/**
+ * @file snapshot.hpp
+ * @brief File containing the declaration of the BinarySnapshot class.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "magazinestore.hpp"
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+/**
+ * @class BinarySnapshot
+ * @brief Reads and writes the binary database format.
+ *
+ * @details A snapshot starts with a 32 byte header: the magic bytes "MAGSNAP\0", the format version, the number of
+ * distinct names, the number of records and a checksum over everything after the header. It is followed by fixed
+ * width columns with one entry per record (packed ISSN, publication date in days since 01.01.1970, price, stock,
+ * borrowed copies, author id and publisher id), a column of string offsets and finally a blob with the title of every
+ * record followed by every distinct author and publisher. Every column starts at a
+ * multiple of eight bytes. All numbers are stored in the byte order of the machine, which is little endian on all
+ * supported platforms.
+ *
+ * The numeric columns have the same layout as the columns of MagazineStore, so most of them are written and read with
+ * a single copy each. Authors and publishers are stored once, in the order of their ids in the StringPool of the
+ * store. Only the current version is read; files of any other version are rejected.
+ *
+ * A snapshot is only ever written from a validated library, so reading it only checks the checksum and the
+ * structure and skips the field validation done for the text format.
+ */
+class BinarySnapshot
+{
+public:
+    /**
+     * @brief The version of the format written by write().
+     */
+    static const std::uint32_t version = 3;
+
+    /**
+     * @brief Checks whether a file starts like a binary snapshot.
+     *
+     * @param data The contents of the file.
+     * @param size The size of the file in bytes.
+     * @return true if the file starts with the snapshot magic bytes, false otherwise.
+     */
+    static bool isSnapshot(const char *data, std::size_t size);
+
+    /**
+     * @brief Writes magazines to a snapshot file.
+     *
+     * @param filename The name of the file to write. An existing file is overwritten.
+     * @param store The magazines to write.
+     * @return true if the file was written completely, false otherwise.
+     */
+    static bool write(const std::string &filename, const MagazineStore &store);
+
+    /**
+     * @brief Reads the magazines of a snapshot that has been read or mapped into memory.
+     *
+     * @param data The contents of the file.
+     * @param size The size of the file in bytes.
+     * @param store Receives the magazines in the order they were written. Its previous contents are removed.
+     * @param error Receives a description of the problem if the snapshot cannot be read.
+     * @return true if the snapshot was read, false if it is damaged or has an unknown version.
+     */
+    static bool read(const char *data, std::size_t size, MagazineStore &store, std::string &error);
+};
+
+#endif // SNAPSHOT_HPP
@@ -0,0 +1,63 @@
+/**
+ * @file stringarena.cpp
+ * @brief File containing the implementation of the StringArena class.
+ */
+
+#include "stringarena.hpp"
+#include <cstring>
+
+StringRef StringArena::append(std::string_view text)
+{
+    std::size_t offsetInBlock = used % blockSize;
+    std::size_t room = used == blocks.size() * blockSize ? 0 : blockSize - offsetInBlock;
+    char *destination;
+    if (room > 0 && text.size() <= room)
+    {
+        destination = blocks[used / blockSize].get() + offsetInBlock;
+    }
+    else
+    {
+        // Start a new block, since the string does not fit into the rest of the current one
+        used = blocks.size() * blockSize;
+        std::size_t spannedBlocks = text.size() > blockSize ? (text.size() + blockSize - 1) / blockSize : 1;
+        destination = new char[spannedBlocks * blockSize];
+        blocks.emplace_back(destination);
+        for (std::size_t i = 1; i < spannedBlocks; ++i)
+        {
+            blocks.emplace_back();
+        }
+    }
+
+    StringRef ref = {static_cast<std::uint32_t>(used), static_cast<std::uint32_t>(text.size())};
+    if (!text.empty())
+    {
+        std::memcpy(destination, text.data(), text.size());
+    }
+    used += text.size();
+    // The rest of a block of its own is not shared with other strings
+    if (text.size() > blockSize)
+    {
+        used = blocks.size() * blockSize;
+    }
+    return ref;
+}
+
+StringArena StringArena::frozenCopy() const
+{
+    StringArena copy;
+    copy.blocks = blocks;
+    // The copy never appends, but if it did, it must not write into the blocks it shares
+    copy.used = blocks.size() * blockSize;
+    return copy;
+}
+
+std::size_t StringArena::capacity() const
+{
+    return blocks.size() * blockSize;
+}
+
+void StringArena::clear()
+{
+    blocks.clear();
+    used = 0;
+}
@@ -0,0 +1,99 @@
+/**
+ * @file stringarena.hpp
+ * @brief File containing the declaration of the StringArena class.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#ifndef STRINGARENA_HPP
+#define STRINGARENA_HPP
+
+/**
+ * @struct StringRef
+ * @brief Refers to a string stored in a StringArena.
+ */
+struct StringRef
+{
+    std::uint32_t offset;  ///< The position of the first character in the arena.
+    std::uint32_t length;  ///< The number of characters.
+};
+
+/**
+ * @class StringArena
+ * @brief Stores many strings back to back in large blocks.
+ *
+ * @details Strings are appended to fixed size blocks instead of being allocated one by one, so there is no
+ * per-string heap allocation and no allocation overhead. A string is referred to by its position in the arena,
+ * which takes 8 bytes instead of the 32 bytes of a std::string. Blocks are never moved or freed until the arena is
+ * cleared, so a string stays at the same address for the lifetime of the arena. Strings cannot be removed.
+ * An arena holds up to 4 GiB of strings.
+ *
+ * Blocks are reference counted, so frozenCopy() can hand out a read-only copy that shares them and stays valid
+ * while the original keeps appending or is cleared.
+ */
+class StringArena
+{
+private:
+    /**
+     * @brief The size of a block in bytes. Strings that do not fit into a block get a block of their own.
+     */
+    static const std::size_t blockSize = 1 << 20;
+
+    /**
+     * @brief The blocks. A string longer than blockSize spans several positions, the ones after the first stay empty.
+     */
+    std::vector<std::shared_ptr<char[]>> blocks;
+
+    std::size_t used = 0;  ///< The position where the next string is stored.
+
+public:
+    StringArena() = default;
+    StringArena(const StringArena &) = delete;
+    StringArena &operator=(const StringArena &) = delete;
+    StringArena(StringArena &&) = default;
+    StringArena &operator=(StringArena &&) = default;
+
+    /**
+     * @brief Returns a copy of the arena that shares its blocks.
+     *
+     * The copy must only be read. Strings appended to the original afterwards are not part of the copy.
+     * @return The copy.
+     */
+    StringArena frozenCopy() const;
+
+    /**
+     * @brief Copies a string into the arena.
+     *
+     * @param text The string to store.
+     * @return The reference to the stored string.
+     */
+    StringRef append(std::string_view text);
+
+    /**
+     * @brief Returns a stored string.
+     *
+     * @param ref A reference returned by append().
+     * @return The stored string. It stays valid until the arena is cleared.
+     */
+    std::string_view view(StringRef ref) const
+    {
+        return std::string_view(blocks[ref.offset / blockSize].get() + ref.offset % blockSize, ref.length);
+    }
+
+    /**
+     * @brief Returns the number of bytes reserved for strings.
+     * @return The size of all blocks in bytes.
+     */
+    std::size_t capacity() const;
+
+    /**
+     * @brief Removes all strings and frees all blocks.
+     */
+    void clear();
+};
+
+#endif // STRINGARENA_HPP
@@ -0,0 +1,66 @@
+/**
+ * @file stringpool.cpp
+ * @brief File containing the implementation of the StringPool class.
+ */
+
+#include "stringpool.hpp"
+
+std::uint32_t StringPool::intern(std::string_view text)
+{
+    auto it = ids.find(text);
+    if (it != ids.end())
+    {
+        return it->second;
+    }
+    StringRef ref = characters.append(text);
+    std::uint32_t id = size();
+    strings.push_back(ref);
+    // The key must point into the pool, not into the caller's string
+    ids.emplace(characters.view(ref), id);
+    return id;
+}
+
+StringPool StringPool::frozenCopy() const
+{
+    StringPool copy;
+    copy.characters = characters.frozenCopy();
+    copy.strings = strings.frozenCopy();
+    return copy;
+}
+
+bool StringPool::find(std::string_view text, std::uint32_t &id) const
+{
+    // A frozen copy has no lookup table
+    if (ids.size() != strings.size())
+    {
+        for (std::uint32_t candidate = 0; candidate < size(); ++candidate)
+        {
+            if (view(candidate) == text)
+            {
+                id = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+    auto it = ids.find(text);
+    if (it == ids.end())
+    {
+        return false;
+    }
+    id = it->second;
+    return true;
+}
+
+std::size_t StringPool::memoryUsage() const
+{
+    return characters.capacity() + strings.memoryUsage() +
+           ids.bucket_count() * sizeof(void *) + ids.size() * (sizeof(std::string_view) + sizeof(std::uint32_t) + 2 * sizeof(void *));
+}
+
+void StringPool::clear()
+{
+    ids.clear();
+    strings.clear();
+    characters.clear();
+}
@@ -0,0 +1,92 @@
+/**
+ * @file stringpool.hpp
+ * @brief File containing the declaration of the StringPool class.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include "chunkedcolumn.hpp"
+#include "stringarena.hpp"
+
+#ifndef STRINGPOOL_HPP
+#define STRINGPOOL_HPP
+
+/**
+ * @class StringPool
+ * @brief Stores every distinct string only once and refers to it by a small number.
+ *
+ * @details Authors and publishers repeat across many magazines. Interning them stores each distinct name once
+ * and lets the records hold a 32 bit id instead, so comparing two names becomes comparing two integers.
+ * Ids are assigned in the order the strings are first seen, starting at 0, and are never reused.
+ *
+ * frozenCopy() returns a read-only copy that shares the strings with the pool. It leaves out the lookup table,
+ * so find() on a copy compares the strings one by one.
+ */
+class StringPool
+{
+private:
+    StringArena characters;  ///< The characters of all distinct strings.
+    ChunkedColumn<StringRef> strings;  ///< The string of every id.
+    std::unordered_map<std::string_view, std::uint32_t> ids;  ///< The id of every string, keyed by views into characters.
+
+public:
+    StringPool() = default;
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+    StringPool(StringPool &&) = default;
+    StringPool &operator=(StringPool &&) = default;
+
+    /**
+     * @brief Returns a copy of the pool that shares its strings.
+     *
+     * The copy must only be read. Strings interned into the original afterwards are not part of the copy.
+     * @return The copy.
+     */
+    StringPool frozenCopy() const;
+
+    /**
+     * @brief Returns the id of a string, adding the string if it is new.
+     *
+     * @param text The string to intern.
+     * @return The id of the string.
+     */
+    std::uint32_t intern(std::string_view text);
+
+    /**
+     * @brief Looks up the id of a string without adding it.
+     *
+     * @param text The string to look up.
+     * @param id Receives the id if the string is in the pool.
+     * @return true if the string is in the pool, false otherwise.
+     */
+    bool find(std::string_view text, std::uint32_t &id) const;
+
+    /**
+     * @brief Returns the string of an id.
+     *
+     * @param id An id returned by intern().
+     * @return The string. It stays valid until the pool is cleared.
+     */
+    std::string_view view(std::uint32_t id) const { return characters.view(strings[id]); }
+
+    /**
+     * @brief Returns the number of distinct strings.
+     * @return The number of ids handed out.
+     */
+    std::uint32_t size() const { return static_cast<std::uint32_t>(strings.size()); }
+
+    /**
+     * @brief Returns the memory used by the pool.
+     * @return The approximate number of bytes used for the strings and the lookup table.
+     */
+    std::size_t memoryUsage() const;
+
+    /**
+     * @brief Removes all strings.
+     */
+    void clear();
+};
+
+#endif // STRINGPOOL_HPP
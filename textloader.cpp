@@ -0,0 +1,226 @@
+/**
+ * @file textloader.cpp
+ * @brief File containing the implementation of the TextLoader class.
+ */
+
+#include "textloader.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+/**
+ * @brief The smallest number of bytes that is worth handing to a separate thread.
+ */
+static const std::size_t minChunkSize = 1 << 20;
+
+void TextLoader::parseBlock(const std::string_view *lines, const std::size_t *recordLines, std::size_t count,
+                            std::vector<LoadedRecord> &records, std::vector<LoadError> &errors)
+{
+    bool authorValid[blockSize], titleValid[blockSize], publisherValid[blockSize], dateValid[blockSize];
+    std::uint32_t issns[blockSize];
+    ISSNStatus issnStatus[blockSize];
+    std::int32_t days[blockSize];
+    Utils::validateChars(lines, count, 8, authorValid);
+    Utils::validateChars(lines + 1, count, 8, titleValid);
+    Utils::validateChars(lines + 2, count, 8, publisherValid);
+    Utils::validateISSNs(lines + 3, count, 8, issns, issnStatus);
+    Utils::validateDates(lines + 5, count, 8, days, dateValid);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::string_view *record = lines + 8 * i;
+        int stock, borrowedCopies;
+        double price;
+        const char *problem = nullptr;
+        if (!authorValid[i] || !titleValid[i] || !publisherValid[i])
+        {
+            problem = "Autor, Titel oder Verlag enthaelt ungueltige Zeichen";
+        }
+        // Catalogues may hold ISSNs from before check characters were checked, so only the format counts
+        else if (issnStatus[i] == ISSNStatus::Malformed)
+        {
+            problem = "Ungueltige ISSN";
+        }
+        else if (!Utils::parseNumber(record[4], stock) || stock < 0)
+        {
+            problem = "Ungueltige Anzahl im Lager";
+        }
+        else if (!dateValid[i])
+        {
+            problem = "Ungueltiges Erscheinungsdatum";
+        }
+        else if (!Utils::parseNumber(record[6], price) || price < 0.00)
+        {
+            problem = "Ungueltiger Preis";
+        }
+        else if (!Utils::parseNumber(record[7], borrowedCopies) || borrowedCopies < 0)
+        {
+            problem = "Ungueltige Anzahl ausgeliehener Exemplare";
+        }
+        else if (!MagazineStore::fits(stock, borrowedCopies, price))
+        {
+            problem = "Anzahl oder Preis ausserhalb des gueltigen Bereichs";
+        }
+
+        if (problem)
+        {
+            errors.push_back({recordLines[i], problem});
+            continue;
+        }
+        records.push_back({recordLines[i], {record[0], record[1], record[2], issns[i], days[i], MagazineStore::toCents(price), stock, borrowedCopies}});
+    }
+}
+
+void TextLoader::parseRange(const char *data, std::size_t size, std::size_t begin, std::size_t end, std::size_t firstLine,
+                            std::vector<LoadedRecord> &records, std::vector<LoadError> &errors)
+{
+    std::size_t position = begin;
+    std::size_t lineNumber = firstLine;
+
+    // Skip the remaining lines of a record that started in the previous range
+    while (lineNumber % 8 != 0 && position < end)
+    {
+        const char *newline = static_cast<const char *>(std::memchr(data + position, '\n', size - position));
+        position = newline ? newline - data + 1 : size;
+        ++lineNumber;
+    }
+
+    // The lines point into the file and are collected until a block is full
+    std::vector<std::string_view> lines(8 * blockSize);
+    std::size_t recordLines[blockSize];
+    std::size_t blockCount = 0;
+    while (position < end)
+    {
+        std::size_t recordLine = lineNumber + 1;
+        std::string_view *record = &lines[8 * blockCount];
+        int count = 0;
+        for (; count < 8 && position < size; ++count)
+        {
+            const char *newline = static_cast<const char *>(std::memchr(data + position, '\n', size - position));
+            std::size_t lineEnd = newline ? newline - data : size;
+            std::size_t next = newline ? lineEnd + 1 : size;
+            // Files written on Windows end their lines with \r\n
+            if (lineEnd > position && data[lineEnd - 1] == '\r')
+            {
+                --lineEnd;
+            }
+            record[count] = std::string_view(data + position, lineEnd - position);
+            position = next;
+            ++lineNumber;
+        }
+        if (count < 8)
+        {
+            parseBlock(lines.data(), recordLines, blockCount, records, errors);
+            blockCount = 0;
+            // Blank lines at the end of the file are no record
+            if (std::any_of(record, record + count, [](std::string_view text)
+                            { return !text.empty(); }))
+            {
+                errors.push_back({recordLine, "Unvollstaendiger Datensatz"});
+            }
+            break;
+        }
+        recordLines[blockCount++] = recordLine;
+        if (blockCount == blockSize)
+        {
+            parseBlock(lines.data(), recordLines, blockCount, records, errors);
+            blockCount = 0;
+        }
+    }
+    parseBlock(lines.data(), recordLines, blockCount, records, errors);
+}
+
+void TextLoader::parse(const char *data, std::size_t size, std::vector<LoadedRecord> &records, std::vector<LoadError> &errors)
+{
+    std::size_t threadCount = std::max<std::size_t>(1, std::min<std::size_t>(std::thread::hardware_concurrency(), size / minChunkSize));
+
+    // Split the file into ranges that start at the beginning of a line
+    std::vector<std::size_t> bounds{0};
+    for (std::size_t i = 1; i < threadCount; ++i)
+    {
+        std::size_t position = std::max(bounds.back(), size * i / threadCount);
+        const char *newline = static_cast<const char *>(std::memchr(data + position, '\n', size - position));
+        if (!newline)
+        {
+            break;
+        }
+        bounds.push_back(newline - data + 1);
+    }
+    bounds.push_back(size);
+    std::size_t ranges = bounds.size() - 1;
+
+    // First pass: count the lines of every range to know the line number each range starts with
+    std::vector<std::size_t> firstLines(ranges + 1, 0);
+    std::vector<std::thread> threads;
+    for (std::size_t r = 1; r < ranges; ++r)
+    {
+        threads.emplace_back([&, r]()
+                             { firstLines[r + 1] = std::count(data + bounds[r], data + bounds[r + 1], '\n'); });
+    }
+    if (ranges > 1)
+    {
+        firstLines[1] = std::count(data, data + bounds[1], '\n');
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    threads.clear();
+    for (std::size_t r = 1; r <= ranges; ++r)
+    {
+        firstLines[r] += firstLines[r - 1];
+    }
+
+    // Second pass: parse and validate the records of every range
+    std::vector<std::vector<LoadedRecord>> rangeRecords(ranges);
+    std::vector<std::vector<LoadError>> rangeErrors(ranges);
+    for (std::size_t r = 1; r < ranges; ++r)
+    {
+        threads.emplace_back([&, r]()
+                             { parseRange(data, size, bounds[r], bounds[r + 1], firstLines[r], rangeRecords[r], rangeErrors[r]); });
+    }
+    parseRange(data, size, bounds[0], bounds[1], firstLines[0], rangeRecords[0], rangeErrors[0]);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    std::size_t total = records.size();
+    for (const std::vector<LoadedRecord> &loaded : rangeRecords)
+    {
+        total += loaded.size();
+    }
+    records.reserve(total);
+    for (std::size_t r = 0; r < ranges; ++r)
+    {
+        records.insert(records.end(), rangeRecords[r].begin(), rangeRecords[r].end());
+        errors.insert(errors.end(), rangeErrors[r].begin(), rangeErrors[r].end());
+    }
+}
+
+bool TextLoader::write(const std::string &filename, const MagazineStore &store)
+{
+    std::ofstream file(filename);
+    for (std::uint32_t row = 0; row < store.size(); ++row)
+    {
+        std::uint32_t cents = store.priceCents(row);
+        int stock;
+        int borrowedCopies;
+        store.copiesOf(row, stock, borrowedCopies);
+        char price[16];
+        std::snprintf(price, sizeof(price), "%u.%02u", cents / 100, cents % 100);
+        file << store.author(row) << "\n"
+             << store.title(row) << "\n"
+             << store.publisher(row) << "\n"
+             << Utils::unpackISSN(store.issn(row)) << "\n"
+             << stock << "\n"
+             << Utils::daysToDate(store.date(row)) << "\n"
+             << price << "\n"
+             << borrowedCopies << "\n"; // Save borrowedCopies
+    }
+    file.close();
+    return !file.fail();
+}
@@ -0,0 +1,100 @@
+/**
+ * @file textloader.hpp
+ * @brief File containing the declaration of the TextLoader class.
+ */
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "magazine.hpp"
+#include "magazinestore.hpp"
+
+#ifndef TEXTLOADER_HPP
+#define TEXTLOADER_HPP
+
+/**
+ * @struct LoadError
+ * @brief Describes a record of a database file that could not be loaded.
+ */
+struct LoadError
+{
+    std::size_t line;  ///< The line number of the first line of the record, starting at 1.
+    std::string message;  ///< A description of the problem for the user.
+};
+
+/**
+ * @struct LoadedRecord
+ * @brief A magazine that was read from a database file.
+ *
+ * @details The strings of the record point into the parsed data, which must outlive the record.
+ */
+struct LoadedRecord
+{
+    std::size_t line;  ///< The line number of the first line of the record, starting at 1.
+    MagazineRecord record;  ///< The fields of the magazine, ready for MagazineStore::append().
+};
+
+/**
+ * @class TextLoader
+ * @brief Reads and writes the text database format.
+ *
+ * @details Every magazine is stored as eight lines: author, title, publisher, ISSN, stock, publication date,
+ * price and borrowed copies. Large files are split into chunks that are parsed and validated on several threads.
+ * Each chunk first counts its lines, so every thread knows where its first record starts, and the results are
+ * merged in file order afterwards. The lines are never copied: valid records refer to them where they lie in the data. Invalid records are reported with their line number and skipped.
+ */
+class TextLoader
+{
+private:
+    static const std::size_t blockSize = 256;  ///< The number of records that are validated together.
+
+    /**
+     * @brief Parses and validates a block of records.
+     *
+     * Every field is checked for the whole block at once with the batch functions of Utils.
+     * @param lines The eight lines of every record, without line breaks, one record after the other.
+     * @param recordLines The line number of the first line of every record.
+     * @param count The number of records, at most blockSize.
+     * @param records Receives the valid records in file order.
+     * @param errors Receives the problems in file order.
+     */
+    static void parseBlock(const std::string_view *lines, const std::size_t *recordLines, std::size_t count,
+                           std::vector<LoadedRecord> &records, std::vector<LoadError> &errors);
+
+    /**
+     * @brief Parses all records that start within a byte range.
+     *
+     * @param data The contents of the whole file.
+     * @param size The size of the whole file.
+     * @param begin The start of the range, which must be the start of a line.
+     * @param end The end of the range.
+     * @param firstLine The line number of the line starting at begin, counting from 0.
+     * @param records Receives the valid records in file order.
+     * @param errors Receives the problems in file order.
+     */
+    static void parseRange(const char *data, std::size_t size, std::size_t begin, std::size_t end, std::size_t firstLine,
+                           std::vector<LoadedRecord> &records, std::vector<LoadError> &errors);
+
+public:
+    /**
+     * @brief Parses a database file that has been read or mapped into memory.
+     *
+     * @param data The contents of the file.
+     * @param size The size of the file in bytes.
+     * @param records Receives all valid records in file order.
+     * @param errors Receives all invalid records in file order.
+     */
+    static void parse(const char *data, std::size_t size, std::vector<LoadedRecord> &records, std::vector<LoadError> &errors);
+
+    /**
+     * @brief Writes magazines to a text database file.
+     *
+     * @param filename The name of the file to write. An existing file is overwritten.
+     * @param store The magazines to write.
+     * @return true if the file was written completely, false otherwise.
+     */
+    static bool write(const std::string &filename, const MagazineStore &store);
+};
+
+#endif // TEXTLOADER_HPP
@@ -0,0 +1,109 @@
+/**
+ * @file threadpool.cpp
+ * @brief File containing the implementation of the ThreadPool class.
+ */
+
+#include "threadpool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(unsigned threadCount)
+{
+    threads.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i)
+    {
+        threads.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::work()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true)
+    {
+        wakeup.wait(lock, [this]
+                    { return stopping || !tasks.empty(); });
+        if (tasks.empty())
+        {
+            return;
+        }
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+void ThreadPool::forEach(std::size_t count, const std::function<void(std::size_t)> &task)
+{
+    // The progress of the loop, shared with the helpers, which may only get to run after the loop is done
+    struct Loop
+    {
+        std::atomic<std::size_t> next{0};  ///< The next index to run.
+        std::size_t count;  ///< The number of indexes.
+        const std::function<void(std::size_t)> *task;  ///< The function, only called for indexes below count.
+        std::mutex mutex;  ///< Protects done.
+        std::condition_variable finished;  ///< Signalled when done reaches count.
+        std::size_t done = 0;  ///< The number of indexes that were run.
+    };
+    auto loop = std::make_shared<Loop>();
+    loop->count = count;
+    loop->task = &task;
+    auto run = [loop]
+    {
+        std::size_t ran = 0;
+        for (std::size_t index; (index = loop->next.fetch_add(1)) < loop->count; ++ran)
+        {
+            (*loop->task)(index);
+        }
+        if (ran > 0)
+        {
+            std::lock_guard<std::mutex> lock(loop->mutex);
+            loop->done += ran;
+            if (loop->done == loop->count)
+            {
+                loop->finished.notify_all();
+            }
+        }
+    };
+
+    // The caller takes one share itself, so only the rest is handed to the threads
+    std::size_t helpers = std::min(threads.size(), count > 0 ? count - 1 : 0);
+    if (helpers > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::size_t i = 0; i < helpers; ++i)
+            {
+                tasks.emplace_back(run);
+            }
+        }
+        if (helpers == 1)
+        {
+            wakeup.notify_one();
+        }
+        else
+        {
+            wakeup.notify_all();
+        }
+    }
+    run();
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&loop]
+                        { return loop->done == loop->count; });
+}
@@ -0,0 +1,67 @@
+/**
+ * @file threadpool.hpp
+ * @brief File containing the declaration of the ThreadPool class.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+/**
+ * @class ThreadPool
+ * @brief A fixed set of threads that run the parts of a parallel loop, see forEach().
+ *
+ * @details The caller of forEach() works on the loop itself as well, so a pool without threads runs everything on
+ * the caller, and a loop started from inside another one cannot wait for threads that are all busy waiting.
+ */
+class ThreadPool
+{
+private:
+    std::vector<std::thread> threads;  ///< The threads of the pool.
+    std::deque<std::function<void()>> tasks;  ///< The tasks waiting for a thread.
+    std::mutex mutex;  ///< Protects tasks and stopping.
+    std::condition_variable wakeup;  ///< Wakes a thread when a task arrives or the pool stops.
+    bool stopping = false;  ///< Whether the threads should end.
+
+    /**
+     * @brief Runs tasks until the pool is destroyed.
+     */
+    void work();
+
+public:
+    /**
+     * @brief Starts the threads.
+     * @param threadCount The number of threads, 0 to run everything on the callers of forEach().
+     */
+    explicit ThreadPool(unsigned threadCount);
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * @brief Waits for the running tasks and ends the threads.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Returns the number of threads, not counting the callers of forEach().
+     */
+    std::size_t size() const { return threads.size(); }
+
+    /**
+     * @brief Runs a function for every index of a range, on the threads of the pool and on the calling thread.
+     *
+     * Returns once the function returned for every index. The function must not throw.
+     * @param count The number of indexes, from 0 to count - 1.
+     * @param task The function to run for every index.
+     */
+    void forEach(std::size_t count, const std::function<void(std::size_t)> &task);
+};
+
+#endif // THREADPOOL_HPP
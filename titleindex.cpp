@@ -0,0 +1,210 @@
+/**
+ * @file titleindex.cpp
+ * @brief File containing the implementation of the TitleIndex class.
+ */
+
+#include "titleindex.hpp"
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+
+/**
+ * @brief Splits a text into lower case words and calls visit with every word.
+ *
+ * A word is a run of letters, digits and apostrophes. All other characters separate words.
+ * @param text The text to split.
+ * @param word Holds the word while it is collected, so that it can be reused between calls.
+ * @param visit Called with every word, in the order the words appear in the text.
+ */
+template <typename Visit>
+static void forEachWord(std::string_view text, std::string &word, Visit visit)
+{
+    word.clear();
+    for (char c : text)
+    {
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '\'')
+        {
+            word += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        else if (!word.empty())
+        {
+            visit(word);
+            word.clear();
+        }
+    }
+    if (!word.empty())
+    {
+        visit(word);
+    }
+}
+
+std::vector<std::string> TitleIndex::tokenize(std::string_view text)
+{
+    std::vector<std::string> words;
+    std::string word;
+    forEachWord(text, word, [&words](const std::string &found)
+                { words.push_back(found); });
+    return words;
+}
+
+void TitleIndex::addWord(std::uint32_t id, const std::string &word)
+{
+    std::vector<std::uint32_t> &ids = postings[word];
+    // A word may appear several times in the same title
+    if (ids.empty() || ids.back() != id)
+    {
+        ids.push_back(id);
+    }
+}
+
+void TitleIndex::add(std::uint32_t id, std::string_view title)
+{
+    forEachWord(title, word, [this, id](const std::string &found)
+                { addWord(id, found); });
+}
+
+std::string_view TitleIndex::builtWord(std::size_t index) const
+{
+    return std::string_view(builtWords).substr(wordStarts[index], wordStarts[index + 1] - wordStarts[index]);
+}
+
+void TitleIndex::collectWords(std::uint32_t id, std::string_view title, Collection &collection)
+{
+    forEachWord(title, word, [id, &collection](const std::string &found)
+                {
+                    auto it = collection.numbers.find(found);
+                    if (it == collection.numbers.end())
+                    {
+                        it = collection.numbers.emplace(found, static_cast<std::uint32_t>(collection.counts.size())).first;
+                        collection.counts.push_back(0);
+                        collection.lastIds.push_back(0);
+                    }
+                    // A word may appear several times in the same title
+                    if (collection.lastIds[it->second] != id + 1)
+                    {
+                        collection.lastIds[it->second] = id + 1;
+                        ++collection.counts[it->second];
+                        collection.occurrences.emplace_back(it->second, id);
+                    }
+                });
+}
+
+void TitleIndex::build(const Collection &collection)
+{
+    std::size_t words = collection.counts.size();
+    std::vector<const std::string *> wordOf(words);
+    std::size_t characters = 0;
+    for (const auto &entry : collection.numbers)
+    {
+        wordOf[entry.second] = &entry.first;
+        characters += entry.first.size();
+    }
+    // Only the distinct words are sorted, the posting lists are filled in the order of the ids
+    std::vector<std::uint32_t> order(words);
+    for (std::uint32_t number = 0; number < words; ++number)
+    {
+        order[number] = number;
+    }
+    std::sort(order.begin(), order.end(), [&wordOf](std::uint32_t a, std::uint32_t b)
+              { return *wordOf[a] < *wordOf[b]; });
+
+    // The next free place in the posting list of every word, by number
+    std::vector<std::size_t> next(words);
+    std::size_t start = 0;
+    builtWords.reserve(characters);
+    wordStarts.reserve(words + 1);
+    postingStarts.reserve(words + 1);
+    for (std::uint32_t number : order)
+    {
+        wordStarts.push_back(builtWords.size());
+        builtWords += *wordOf[number];
+        postingStarts.push_back(start);
+        next[number] = start;
+        start += collection.counts[number];
+    }
+    wordStarts.push_back(builtWords.size());
+    postingStarts.push_back(start);
+    builtIds.resize(collection.occurrences.size());
+    for (const auto &occurrence : collection.occurrences)
+    {
+        builtIds[next[occurrence.first]++] = occurrence.second;
+    }
+}
+
+std::vector<std::uint32_t> TitleIndex::lookupPrefix(const std::string &prefix) const
+{
+    std::vector<std::uint32_t> ids;
+    std::size_t matchingWords = 0;
+    // The words given to assign() are sorted, so the words with the prefix start at the first word not below it
+    std::size_t builtCount = wordStarts.empty() ? 0 : wordStarts.size() - 1;
+    std::size_t low = 0;
+    std::size_t high = builtCount;
+    while (low < high)
+    {
+        std::size_t middle = low + (high - low) / 2;
+        if (builtWord(middle) < prefix)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    for (std::size_t w = low; w < builtCount && builtWord(w).compare(0, prefix.size(), prefix) == 0; ++w)
+    {
+        ids.insert(ids.end(), builtIds.begin() + static_cast<std::ptrdiff_t>(postingStarts[w]), builtIds.begin() + static_cast<std::ptrdiff_t>(postingStarts[w + 1]));
+        ++matchingWords;
+    }
+    for (auto it = postings.lower_bound(prefix); it != postings.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+    {
+        ids.insert(ids.end(), it->second.begin(), it->second.end());
+        ++matchingWords;
+    }
+    // Posting lists of different words can overlap, e.g. "spiegel" and "spiegelbild" in the same title, and a word
+    // given to assign() can have a second list for the titles added later
+    if (matchingWords > 1)
+    {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    }
+    return ids;
+}
+
+std::vector<std::uint32_t> TitleIndex::search(const std::string &query) const
+{
+    std::vector<std::vector<std::uint32_t>> lists;
+    for (const std::string &word : tokenize(query))
+    {
+        lists.push_back(lookupPrefix(word));
+        if (lists.back().empty())
+        {
+            return {};
+        }
+    }
+    if (lists.empty())
+    {
+        return {};
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const std::vector<std::uint32_t> &a, const std::vector<std::uint32_t> &b)
+              { return a.size() < b.size(); });
+    std::vector<std::uint32_t> result = lists.front();
+    for (std::size_t i = 1; i < lists.size() && !result.empty(); ++i)
+    {
+        std::vector<std::uint32_t> intersection;
+        std::set_intersection(result.begin(), result.end(), lists[i].begin(), lists[i].end(), std::back_inserter(intersection));
+        result.swap(intersection);
+    }
+    return result;
+}
+
+void TitleIndex::clear()
+{
+    postings.clear();
+    word.clear();
+    builtWords.clear();
+    wordStarts.clear();
+    postingStarts.clear();
+    builtIds.clear();
+}
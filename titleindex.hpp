@@ -0,0 +1,141 @@
+/**
+ * @file titleindex.hpp
+ * @brief File containing the declaration of the TitleIndex class.
+ */
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef TITLEINDEX_HPP
+#define TITLEINDEX_HPP
+
+/**
+ * @class TitleIndex
+ * @brief An inverted index over the words of magazine titles.
+ *
+ * @details Titles are split into lower case words. For every word the index keeps a sorted posting list with the
+ * ids of all magazines whose title contains the word. A query matches a magazine if every query word is a prefix
+ * of at least one word of its title, so "spieg" finds "Der Spiegel" and "c't" finds "c't Magazin".
+ *
+ * A whole library is indexed at once with assign(), which keeps all words in one sorted array and all posting lists
+ * in another, so loading does not allocate per word. Titles added later go to a map of growing posting lists.
+ */
+class TitleIndex
+{
+private:
+    /**
+     * @brief The words assign() has collected from the titles so far.
+     */
+    struct Collection
+    {
+        std::unordered_map<std::string, std::uint32_t> numbers;  ///< The number of every distinct word, in the order the words were found.
+        std::vector<std::uint32_t> counts;  ///< The number of titles containing every word.
+        std::vector<std::uint32_t> lastIds;  ///< 1 + the id of the last title containing every word.
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> occurrences;  ///< The number of a word and the id of a title containing it, once per title.
+    };
+
+    /**
+     * @brief Posting lists for every word of the titles added after assign(), ordered by word so that all words with
+     * a common prefix are adjacent.
+     */
+    std::map<std::string, std::vector<std::uint32_t>> postings;
+
+    std::string builtWords;  ///< The distinct words of the titles given to assign(), sorted and concatenated.
+    std::vector<std::size_t> wordStarts;  ///< The start of every word in builtWords, plus the end of the last one.
+    std::vector<std::size_t> postingStarts;  ///< The start of the posting list of every word in builtIds, plus the end of the last one.
+    std::vector<std::uint32_t> builtIds;  ///< The posting lists of all words given to assign(), one after the other.
+
+    /**
+     * @brief The word add() is collecting, kept between calls so that adding a title does not allocate.
+     */
+    std::string word;
+
+    /**
+     * @brief Adds an id to the posting list of a word, once per title.
+     */
+    void addWord(std::uint32_t id, const std::string &word);
+
+    /**
+     * @brief Returns a word of builtWords.
+     */
+    std::string_view builtWord(std::size_t index) const;
+
+    /**
+     * @brief Numbers the words of a title and counts the title for every word, for assign().
+     */
+    void collectWords(std::uint32_t id, std::string_view title, Collection &collection);
+
+    /**
+     * @brief Sorts the collected words and fills the word and posting arrays from the collection.
+     */
+    void build(const Collection &collection);
+
+    /**
+     * @brief Collects the ids of all magazines that contain a word starting with the given prefix.
+     *
+     * @param prefix The lower case prefix to look up.
+     * @return The sorted ids of all matching magazines.
+     */
+    std::vector<std::uint32_t> lookupPrefix(const std::string &prefix) const;
+
+public:
+    /**
+     * @brief Splits a title into lower case words.
+     *
+     * A word is a run of letters, digits and apostrophes. All other characters separate words.
+     * @param text The text to split.
+     * @return The words in the order they appear in the text.
+     */
+    static std::vector<std::string> tokenize(std::string_view text);
+
+    /**
+     * @brief Adds a title to the index.
+     *
+     * Ids must be added in ascending order, which keeps every posting list sorted without extra work.
+     * @param id The id of the magazine.
+     * @param title The title of the magazine.
+     */
+    void add(std::uint32_t id, std::string_view title);
+
+    /**
+     * @brief Replaces all titles with the titles of the ids from 0 to count - 1.
+     *
+     * Numbers the words and counts the titles of every word first and then fills every array once, which is much faster
+     * than adding the titles one by one when a whole library is loaded.
+     * @param count The number of ids.
+     * @param titleOf Returns the title of an id.
+     */
+    template <typename TitleOf>
+    void assign(std::uint32_t count, TitleOf titleOf)
+    {
+        clear();
+        Collection collection;
+        for (std::uint32_t id = 0; id < count; ++id)
+        {
+            collectWords(id, titleOf(id), collection);
+        }
+        build(collection);
+    }
+
+    /**
+     * @brief Finds all magazines whose title matches every word of the query as a prefix.
+     *
+     * The posting lists of the query words are intersected starting with the shortest one,
+     * so the cost depends on the number of matches and not on the number of indexed titles.
+     * @param query The words to search for.
+     * @return The sorted ids of all matching magazines. Empty if the query contains no words.
+     */
+    std::vector<std::uint32_t> search(const std::string &query) const;
+
+    /**
+     * @brief Removes all titles from the index.
+     */
+    void clear();
+};
+
+#endif // TITLEINDEX_HPP
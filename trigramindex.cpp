@@ -0,0 +1,303 @@
+/**
+ * @file trigramindex.cpp
+ * @brief File containing the implementation of the TrigramIndex class.
+ */
+
+#include "trigramindex.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+
+/**
+ * @brief The digit of every character in the number of a slot, see TrigramIndex::slotOf(). 64 for characters
+ * without one. Digits are below 38, so or-ing the digits of a trigram reaches 64 only if one of its characters has none.
+ */
+static const std::array<unsigned char, 256> slotDigits = []()
+{
+    std::array<unsigned char, 256> digits;
+    digits.fill(64);
+    digits[' '] = 0;
+    digits['\''] = 1;
+    for (int c = '0'; c <= '9'; ++c)
+    {
+        digits[c] = static_cast<unsigned char>(2 + c - '0');
+    }
+    for (int c = 'a'; c <= 'z'; ++c)
+    {
+        digits[c] = static_cast<unsigned char>(12 + c - 'a');
+    }
+    return digits;
+}();
+
+std::string TrigramIndex::normalize(std::string_view text)
+{
+    std::string normalized;
+    normalizeInto(text, normalized);
+    return normalized;
+}
+
+void TrigramIndex::normalizeInto(std::string_view text, std::string &normalized)
+{
+    normalized.assign(1, ' ');
+    for (char c : text)
+    {
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '\'')
+        {
+            normalized += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        else if (normalized.back() != ' ')
+        {
+            normalized += ' ';
+        }
+    }
+    if (normalized.back() != ' ')
+    {
+        normalized += ' ';
+    }
+}
+
+std::vector<std::uint32_t> TrigramIndex::trigrams(const std::string &normalized)
+{
+    std::vector<std::uint32_t> result;
+    collectTrigrams(normalized, result);
+    return result;
+}
+
+void TrigramIndex::collectTrigrams(const std::string &normalized, std::vector<std::uint32_t> &result)
+{
+    result.clear();
+    for (std::size_t i = 0; i + 3 <= normalized.size(); ++i)
+    {
+        result.push_back(trigramAt(normalized, i));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+std::uint32_t TrigramIndex::trigramAt(const std::string &normalized, std::size_t position)
+{
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(normalized[position])) << 16 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(normalized[position + 1])) << 8 |
+           static_cast<std::uint32_t>(static_cast<unsigned char>(normalized[position + 2]));
+}
+
+int TrigramIndex::boundedDistance(std::string_view pattern, std::string_view text, int maxDistance)
+{
+    const std::size_t length = std::min<std::size_t>(pattern.size(), 64);
+    if (length == 0)
+    {
+        return 0;
+    }
+
+    // Bit i of peq[c] is set if the pattern has the character c at position i
+    std::uint64_t peq[256] = {};
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        peq[static_cast<unsigned char>(pattern[i])] |= std::uint64_t(1) << i;
+    }
+
+    const std::uint64_t lastBit = std::uint64_t(1) << (length - 1);
+    std::uint64_t pv = ~std::uint64_t(0);
+    std::uint64_t mv = 0;
+    int score = static_cast<int>(length);
+    int best = score;
+    for (std::size_t j = 0; j < text.size(); ++j)
+    {
+        std::uint64_t eq = peq[static_cast<unsigned char>(text[j])];
+        std::uint64_t xv = eq | mv;
+        std::uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        std::uint64_t ph = mv | ~(xh | pv);
+        std::uint64_t mh = pv & xh;
+        if (ph & lastBit)
+        {
+            ++score;
+        }
+        else if (mh & lastBit)
+        {
+            --score;
+        }
+        // The match may start anywhere in the text, so the top row of the matrix stays zero
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        best = std::min(best, score);
+
+        // The score drops by at most one per remaining character
+        if (score - static_cast<int>(text.size() - j - 1) > maxDistance && best > maxDistance)
+        {
+            break;
+        }
+    }
+    return std::min(best, maxDistance + 1);
+}
+
+void TrigramIndex::add(std::uint32_t id, std::string_view title)
+{
+    normalizeInto(title, normalizedTitle);
+    collectTrigrams(normalizedTitle, titleTrigrams);
+    for (std::uint32_t trigram : titleTrigrams)
+    {
+        postings[trigram].push_back(id);
+    }
+}
+
+bool TrigramIndex::slotOf(std::uint32_t trigram, std::size_t &slot)
+{
+    std::size_t first = slotDigits[(trigram >> 16) & 0xFF];
+    std::size_t second = slotDigits[(trigram >> 8) & 0xFF];
+    std::size_t third = slotDigits[trigram & 0xFF];
+    slot = (first * 38 + second) * 38 + third;
+    return (first | second | third) < 64;
+}
+
+void TrigramIndex::scanTrigrams(std::uint32_t id, std::string_view title, bool fill)
+{
+    normalizeInto(title, normalizedTitle);
+    for (std::size_t i = 0; i + 3 <= normalizedTitle.size(); ++i)
+    {
+        std::uint32_t trigram = trigramAt(normalizedTitle, i);
+        std::size_t slot;
+        if (!slotOf(trigram, slot))
+        {
+            if (fill)
+            {
+                std::vector<std::uint32_t> &ids = postings[trigram];
+                if (ids.empty() || ids.back() != id)
+                {
+                    ids.push_back(id);
+                }
+            }
+        }
+        // A trigram may appear several times in the same title
+        else if (lastIds[slot] != id + 1)
+        {
+            lastIds[slot] = id + 1;
+            // Counted two places ahead, so that startFilling() and the filling leave the start of slot s at s
+            if (fill)
+            {
+                builtIds[slotStarts[slot + 1]++] = id;
+            }
+            else
+            {
+                ++slotStarts[slot + 2];
+            }
+        }
+    }
+}
+
+void TrigramIndex::startFilling()
+{
+    for (std::size_t i = 1; i < slotStarts.size(); ++i)
+    {
+        slotStarts[i] += slotStarts[i - 1];
+    }
+    builtIds.resize(slotStarts.back());
+    std::fill(lastIds.begin(), lastIds.end(), 0);
+}
+
+std::vector<std::uint32_t> TrigramIndex::candidates(const std::string &query, int maxDistance) const
+{
+    std::vector<std::uint32_t> queryTrigrams = trigrams(normalize(query));
+    std::vector<PostingList> lists;
+    // A trigram given to assign() may also have a list for the titles added later, both are joined here
+    std::vector<std::vector<std::uint32_t>> joined;
+    joined.reserve(queryTrigrams.size());
+    for (std::uint32_t trigram : queryTrigrams)
+    {
+        PostingList built = {nullptr, nullptr};
+        std::size_t slot;
+        if (slotOf(trigram, slot) && slot + 1 < slotStarts.size())
+        {
+            built = {builtIds.data() + slotStarts[slot], builtIds.data() + slotStarts[slot + 1]};
+        }
+        auto it = postings.find(trigram);
+        if (it == postings.end())
+        {
+            if (built.first != built.last)
+            {
+                lists.push_back(built);
+            }
+        }
+        else if (built.first == built.last)
+        {
+            lists.push_back({it->second.data(), it->second.data() + it->second.size()});
+        }
+        else
+        {
+            joined.emplace_back(built.first, built.last);
+            joined.back().insert(joined.back().end(), it->second.begin(), it->second.end());
+            lists.push_back({joined.back().data(), joined.back().data() + joined.back().size()});
+        }
+    }
+
+    // Every edit destroys at most three trigrams of the query
+    std::size_t lost = static_cast<std::size_t>(3 * maxDistance);
+    std::size_t required = queryTrigrams.size() > lost ? queryTrigrams.size() - lost : 1;
+    if (lists.size() < required)
+    {
+        return {};
+    }
+
+    // A candidate with enough shared trigrams must appear in at least one of the rarest lists
+    std::sort(lists.begin(), lists.end(), [](const PostingList &a, const PostingList &b)
+              { return a.last - a.first < b.last - b.first; });
+    std::size_t collecting = lists.size() - required + 1;
+    std::vector<std::uint32_t> collected;
+    for (std::size_t i = 0; i < collecting; ++i)
+    {
+        collected.insert(collected.end(), lists[i].first, lists[i].last);
+    }
+    std::sort(collected.begin(), collected.end());
+
+    std::vector<std::uint32_t> ids;
+    std::vector<std::uint32_t> counts;
+    for (std::size_t i = 0; i < collected.size(); ++i)
+    {
+        if (ids.empty() || ids.back() != collected[i])
+        {
+            ids.push_back(collected[i]);
+            counts.push_back(0);
+        }
+        ++counts.back();
+    }
+
+    // The frequent lists are only probed for the collected ids, dropping every id that can no longer
+    // reach the required number of shared trigrams with the lists that are left
+    for (std::size_t i = collecting; i < lists.size() && !ids.empty(); ++i)
+    {
+        std::size_t remaining = lists.size() - i - 1;
+        std::size_t kept = 0;
+        const std::uint32_t *position = lists[i].first;
+        for (std::size_t c = 0; c < ids.size(); ++c)
+        {
+            position = std::lower_bound(position, lists[i].last, ids[c]);
+            std::uint32_t count = counts[c] + (position != lists[i].last && *position == ids[c]);
+            if (count + remaining >= required)
+            {
+                ids[kept] = ids[c];
+                counts[kept] = count;
+                ++kept;
+            }
+        }
+        ids.resize(kept);
+        counts.resize(kept);
+    }
+
+    std::vector<std::uint32_t> result;
+    for (std::size_t c = 0; c < ids.size(); ++c)
+    {
+        if (counts[c] >= required)
+        {
+            result.push_back(ids[c]);
+        }
+    }
+    return result;
+}
+
+void TrigramIndex::clear()
+{
+    postings.clear();
+    slotStarts.clear();
+    builtIds.clear();
+}
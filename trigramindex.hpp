@@ -0,0 +1,186 @@
+/**
+ * @file trigramindex.hpp
+ * @brief File containing the declaration of the TrigramIndex class.
+ */
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifndef TRIGRAMINDEX_HPP
+#define TRIGRAMINDEX_HPP
+
+/**
+ * @class TrigramIndex
+ * @brief An index over the character trigrams of magazine titles for typo tolerant search.
+ *
+ * @details Every title is normalized (lower case, runs of other characters replaced by a single space, padded with
+ * a space on both sides) and split into overlapping three character sequences. A misspelled query still shares
+ * most of its trigrams with the intended title, because a single typo changes at most three of them.
+ * The index only produces a small candidate set; the candidates are then ranked with boundedDistance().
+ *
+ * A whole library is indexed at once with assign(). Trigrams made of the characters normalize() keeps in the default
+ * locale are numbered densely, so assign() can count the ids of every trigram first and then fill all posting lists
+ * into one array. Titles added later go to a map of growing posting lists.
+ */
+class TrigramIndex
+{
+private:
+    /**
+     * @brief A posting list in builtIds or in postings.
+     */
+    struct PostingList
+    {
+        const std::uint32_t *first;  ///< The first id of the list.
+        const std::uint32_t *last;  ///< One past the last id of the list.
+    };
+
+    /**
+     * @brief Sorted ids of the titles added after assign() containing a trigram, keyed by the three packed characters.
+     *
+     * Also holds the trigrams given to assign() that have no slot, see slotOf().
+     */
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> postings;
+
+    /**
+     * @brief The number of trigrams with a slot, see slotOf().
+     */
+    static const std::size_t slotCount = 38 * 38 * 38;
+
+    std::vector<std::size_t> slotStarts;  ///< The start of the posting list of every slot in builtIds, see assign().
+    std::vector<std::uint32_t> builtIds;  ///< The posting lists of all slots given to assign(), one after the other.
+    std::vector<std::uint32_t> lastIds;  ///< 1 + the id of the last title assign() has seen every slot in, only while it runs.
+
+    /**
+     * @brief Numbers a trigram densely if it consists of spaces, apostrophes, digits and lower case ASCII letters.
+     *
+     * @param trigram The packed trigram.
+     * @param slot Receives the number of the trigram, below slotCount.
+     * @return Whether the trigram has a slot.
+     */
+    static bool slotOf(std::uint32_t trigram, std::size_t &slot);
+
+    /**
+     * @brief Counts the id of a title in slotStarts or adds it to the posting lists of its trigrams, for assign().
+     *
+     * @param id The id of the magazine.
+     * @param title The title of the magazine.
+     * @param fill Whether to add the id, which needs the counts turned into starts by startFilling().
+     */
+    void scanTrigrams(std::uint32_t id, std::string_view title, bool fill);
+
+    /**
+     * @brief Turns the counts in slotStarts into the start of every posting list and makes room for them in builtIds.
+     */
+    void startFilling();
+
+    /**
+     * @brief Packs the three characters of a normalized text starting at a position into a trigram.
+     */
+    static std::uint32_t trigramAt(const std::string &normalized, std::size_t position);
+
+    /**
+     * @brief Collects the distinct trigrams of a normalized text.
+     *
+     * @param normalized A text returned by normalize().
+     * @return The packed trigrams, each one only once.
+     */
+    static std::vector<std::uint32_t> trigrams(const std::string &normalized);
+
+    /**
+     * @brief Collects the distinct trigrams of a normalized text into a vector that may be reused.
+     *
+     * @param normalized A text returned by normalize().
+     * @param result Receives the packed trigrams, each one only once. Its previous contents are replaced.
+     */
+    static void collectTrigrams(const std::string &normalized, std::vector<std::uint32_t> &result);
+
+    /**
+     * @brief Normalizes a text into a string that may be reused, see normalize().
+     *
+     * @param text The text to normalize.
+     * @param normalized Receives the normalized text. Its previous contents are replaced.
+     */
+    static void normalizeInto(std::string_view text, std::string &normalized);
+
+    std::string normalizedTitle;  ///< The title add() is working on, kept between calls so that adding a title does not allocate.
+    std::vector<std::uint32_t> titleTrigrams;  ///< The trigrams of that title, kept for the same reason.
+
+public:
+    /**
+     * @brief Normalizes a text for trigram extraction and distance computation.
+     *
+     * @param text The text to normalize.
+     * @return The lower case text with letters, digits and apostrophes kept and all other runs replaced by one space.
+     */
+    static std::string normalize(std::string_view text);
+
+    /**
+     * @brief Computes the edit distance of the best matching substring of a text, giving up early above a bound.
+     *
+     * Uses Myers' bit-parallel algorithm, which processes the whole pattern with a few 64 bit operations per
+     * character of the text. Only the first 64 characters of the pattern are considered.
+     * @param pattern The normalized pattern, usually the query.
+     * @param text The normalized text, usually a title.
+     * @param maxDistance The largest distance of interest.
+     * @return The smallest number of edits needed to turn the pattern into a substring of the text,
+     * or maxDistance + 1 if it is larger than maxDistance.
+     */
+    static int boundedDistance(std::string_view pattern, std::string_view text, int maxDistance);
+
+    /**
+     * @brief Adds a title to the index.
+     *
+     * Ids must be added in ascending order, which keeps every posting list sorted.
+     * @param id The id of the magazine.
+     * @param title The title of the magazine.
+     */
+    void add(std::uint32_t id, std::string_view title);
+
+    /**
+     * @brief Replaces all titles with the titles of the ids from 0 to count - 1.
+     *
+     * Counts the ids of every trigram first and then fills all posting lists into one array, which is much faster
+     * than adding the titles one by one when a whole library is loaded.
+     * @param count The number of ids.
+     * @param titleOf Returns the title of an id.
+     */
+    template <typename TitleOf>
+    void assign(std::uint32_t count, TitleOf titleOf)
+    {
+        clear();
+        slotStarts.assign(slotCount + 2, 0);
+        lastIds.assign(slotCount, 0);
+        for (std::uint32_t id = 0; id < count; ++id)
+        {
+            scanTrigrams(id, titleOf(id), false);
+        }
+        startFilling();
+        for (std::uint32_t id = 0; id < count; ++id)
+        {
+            scanTrigrams(id, titleOf(id), true);
+        }
+        std::vector<std::uint32_t>().swap(lastIds);
+    }
+
+    /**
+     * @brief Finds the titles that may be within a given edit distance of a query.
+     *
+     * A title is a candidate if it shares enough trigrams with the query to be within maxDistance edits.
+     * The rarest trigrams are used to collect candidates and the frequent ones only to count them,
+     * so long posting lists of common trigrams are never fully merged.
+     * @param query The query as typed by the user.
+     * @param maxDistance The largest number of typos to tolerate.
+     * @return The sorted ids of all candidates.
+     */
+    std::vector<std::uint32_t> candidates(const std::string &query, int maxDistance) const;
+
+    /**
+     * @brief Removes all titles from the index.
+     */
+    void clear();
+};
+
+#endif // TRIGRAMINDEX_HPP
@@ -1,39 +1,135 @@
 #include "utils.hpp"
 #include <string>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
 
-bool Utils::isValidDate(const std::string& date) {
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define UTILS_USE_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UTILS_USE_SSE2
+#endif
+
+/**
+ * @brief The highest bit of every byte of a 64 bit word.
+ */
+static const std::uint64_t highBits = 0x8080808080808080ull;
+
+/**
+ * @brief Repeats a byte in all eight bytes of a 64 bit word.
+ */
+static constexpr std::uint64_t repeatByte(unsigned char byte)
+{
+    return 0x0101010101010101ull * byte;
+}
+
+/**
+ * @brief Checks whether all eight bytes of a word lie within a range of 7 bit characters.
+ *
+ * @param word The bytes to check.
+ * @param low The smallest allowed character.
+ * @param high The largest allowed character, below 128.
+ * @return true if every byte is between low and high, false otherwise.
+ */
+static bool bytesInRange(std::uint64_t word, unsigned char low, unsigned char high)
+{
+    // With the highest bit of every byte set, subtracting cannot borrow from the next byte,
+    // and bytes below 128 cannot carry into the next byte when adding up to 127
+    return (word & highBits) == 0 && (((word | highBits) - repeatByte(low)) & highBits) == highBits &&
+           ((word + repeatByte(static_cast<unsigned char>(0x7F - high))) & highBits) == 0;
+}
+
+/**
+ * @brief Converts a date that is known to be valid into the number of days since 01.01.1970.
+ */
+static std::int32_t daysFromCivil(int day, int month, int year)
+{
+    // Count years from March, so the leap day is the last day of the year
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+bool Utils::isValidDate(std::string_view date) {
+    std::int32_t days;
+    return parseDate(date, days);
+}
+
+bool Utils::parseDate(std::string_view date, std::int32_t &days) {
     if (date.length() != 10 || date[2] != '.' || date[5] != '.') {
         return false;
     }
 
-    int day = std::stoi(date.substr(0, 2));
-    int month = std::stoi(date.substr(3, 2));
-    int year = std::stoi(date.substr(6, 4));
-
-    if (year < 0) {
+    const char digits[8] = {date[0], date[1], date[3], date[4], date[6], date[7], date[8], date[9]};
+    std::uint64_t word;
+    std::memcpy(&word, digits, sizeof(word));
+    if (!bytesInRange(word, '0', '9')) {
         return false;
     }
 
+    int day = (digits[0] - '0') * 10 + (digits[1] - '0');
+    int month = (digits[2] - '0') * 10 + (digits[3] - '0');
+    int year = (digits[4] - '0') * 1000 + (digits[5] - '0') * 100 + (digits[6] - '0') * 10 + (digits[7] - '0');
+
     if (month < 1 || month > 12) {
         return false;
     }
 
-    int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    static const int daysInMonth[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 
     // Check for leap year
-    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
-        daysInMonth[1] = 29;
-    }
+    bool leapDay = month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
 
-    if (day < 1 || day > daysInMonth[month - 1]) {
+    if (day < 1 || day > daysInMonth[month - 1] + leapDay) {
         return false;
     }
 
+    days = daysFromCivil(day, month, year);
     return true;
 }
 
-bool Utils::containsValidChars(const std::string& str) {
-    for (char c : str) {
+bool Utils::containsValidChars(std::string_view str) {
+    const char *data = str.data();
+    std::size_t size = str.size();
+    std::size_t i = 0;
+#ifdef UTILS_USE_AVX2
+    const __m256i space32 = _mm256_set1_epi8(31);
+    const __m256i delete32 = _mm256_set1_epi8(127);
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        // Bytes above 127 are negative as signed chars and fail the first comparison
+        __m256i valid = _mm256_andnot_si256(_mm256_cmpeq_epi8(bytes, delete32), _mm256_cmpgt_epi8(bytes, space32));
+        if (_mm256_movemask_epi8(valid) != -1) {
+            return false;
+        }
+    }
+#endif
+#ifdef UTILS_USE_SSE2
+    const __m128i space16 = _mm_set1_epi8(31);
+    const __m128i delete16 = _mm_set1_epi8(127);
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+        __m128i valid = _mm_andnot_si128(_mm_cmpeq_epi8(bytes, delete16), _mm_cmpgt_epi8(bytes, space16));
+        if (_mm_movemask_epi8(valid) != 0xFFFF) {
+            return false;
+        }
+    }
+#endif
+    for (; i + 8 <= size; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        if (!bytesInRange(word, 32, 126)) {
+            return false;
+        }
+    }
+    for (; i < size; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
         if (c < 32 || c > 126) {
             return false;
         }
@@ -41,29 +137,163 @@ bool Utils::containsValidChars(const std::string& str) {
     return true;
 }
 
-bool Utils::isValidISSN(const std::string &issn)
+bool Utils::isValidISSN(std::string_view issn)
+{
+    std::uint32_t packed;
+    return parseISSN(issn, packed) != ISSNStatus::Malformed;
+}
+
+ISSNStatus Utils::parseISSN(std::string_view issn, std::uint32_t &packed)
 {
     if (issn.length() != 9 || issn[4] != '-')
     {
-        return false;
+        return ISSNStatus::Malformed;
+    }
+    // Check the seven digits at once, with the hyphen replaced by a digit
+    char digits[8];
+    std::memcpy(digits, issn.data(), sizeof(digits));
+    digits[4] = '0';
+    std::uint64_t word;
+    std::memcpy(&word, digits, sizeof(word));
+    if (!bytesInRange(word, '0', '9'))
+    {
+        return ISSNStatus::Malformed;
+    }
+    std::uint32_t check;
+    if (issn[8] >= '0' && issn[8] <= '9')
+    {
+        check = static_cast<std::uint32_t>(issn[8] - '0');
+    }
+    else if (issn[8] == 'X' || issn[8] == 'x')
+    {
+        check = 10;
     }
-    for (int i = 0; i < 4; ++i)
+    else
     {
-        if (!std::isdigit(issn[i]))
+        return ISSNStatus::Malformed;
+    }
+
+    std::uint32_t number = 0;
+    std::uint32_t sum = check;
+    std::uint32_t weight = 8;
+    for (int i = 0; i < 8; ++i)
+    {
+        if (i != 4)
         {
-            return false;
+            std::uint32_t digit = static_cast<std::uint32_t>(digits[i] - '0');
+            number = number * 10 + digit;
+            sum += digit * weight--;
         }
     }
-    for (int i = 5; i < 8; ++i)
+    packed = (number << 4) | check;
+    return sum % 11 == 0 ? ISSNStatus::Valid : ISSNStatus::WrongCheckDigit;
+}
+
+std::size_t Utils::validateChars(const std::string_view *texts, std::size_t count, std::size_t stride, bool *valid)
+{
+    std::size_t validCount = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        valid[i] = containsValidChars(texts[i * stride]);
+        validCount += valid[i];
+    }
+    return validCount;
+}
+
+std::size_t Utils::validateDates(const std::string_view *dates, std::size_t count, std::size_t stride, std::int32_t *days, bool *valid)
+{
+    std::size_t validCount = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        valid[i] = parseDate(dates[i * stride], days[i]);
+        validCount += valid[i];
+    }
+    return validCount;
+}
+
+std::size_t Utils::validateISSNs(const std::string_view *issns, std::size_t count, std::size_t stride, std::uint32_t *packed, ISSNStatus *status)
+{
+    std::size_t validCount = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        status[i] = parseISSN(issns[i * stride], packed[i]);
+        validCount += status[i] != ISSNStatus::Malformed;
+    }
+    return validCount;
+}
+
+std::uint32_t Utils::packISSN(std::string_view issn)
+{
+    std::uint32_t digits = 0;
+    for (int i = 0; i < 8; ++i)
     {
-        if (!std::isdigit(issn[i]))
+        if (i != 4)
         {
-            return false;
+            digits = digits * 10 + (issn[i] - '0');
         }
     }
-    if (!std::isdigit(issn[8]) && !(std::isalpha(issn[8]) && std::toupper(issn[8]) == 'X'))
+    std::uint32_t check = std::isdigit(issn[8]) ? issn[8] - '0' : 10;
+    return (digits << 4) | check;
+}
+
+std::string Utils::unpackISSN(std::uint32_t packed)
+{
+    std::uint32_t digits = packed >> 4;
+    std::uint32_t check = packed & 0xF;
+    char issn[10];
+    for (int i = 7; i >= 0; --i)
     {
-        return false;
+        if (i != 4)
+        {
+            issn[i] = static_cast<char>('0' + digits % 10);
+            digits /= 10;
+        }
     }
-    return true;
+    issn[4] = '-';
+    issn[8] = check == 10 ? 'X' : static_cast<char>('0' + check);
+    issn[9] = '\0';
+    return issn;
+}
+
+std::int32_t Utils::dateToDays(std::string_view date)
+{
+    int day = (date[0] - '0') * 10 + (date[1] - '0');
+    int month = (date[3] - '0') * 10 + (date[4] - '0');
+    int year = (date[6] - '0') * 1000 + (date[7] - '0') * 100 + (date[8] - '0') * 10 + (date[9] - '0');
+    return daysFromCivil(day, month, year);
+}
+
+std::string Utils::daysToDate(std::int32_t days)
+{
+    days += 719468;
+    int era = (days >= 0 ? days : days - 146096) / 146097;
+    int dayOfEra = days - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int shiftedMonth = (5 * dayOfYear + 2) / 153;
+    int day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    int month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    int year = yearOfEra + era * 400 + (month <= 2);
+
+    char date[40];
+    std::snprintf(date, sizeof(date), "%02d.%02d.%04d", day, month, year);
+    return date;
+}
+
+std::uint64_t Utils::checksum(const char *data, std::size_t size)
+{
+    std::uint64_t hash = 0xCBF29CE484222325ull ^ size;
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; ++i)
+    {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001B3ull;
+    }
+    return hash;
 }
\ No newline at end of file
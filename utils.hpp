@@ -7,6 +7,20 @@
 #define UTILS_HPP
 
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief The result of checking an ISSN, see Utils::parseISSN().
+ */
+enum class ISSNStatus
+{
+    Malformed,  ///< The ISSN is not in the format XXXX-XXXX.
+    WrongCheckDigit,  ///< The format is right, but the check character does not match the seven digits.
+    Valid  ///< The format and the check character are right.
+};
 
 /**
  * @class Utils
@@ -14,10 +28,16 @@
  *
  * This class provides static functions that are used throughout the library management system.
  * These functions include validation checks for strings, ISSN, and dates.
+ *
+ * The checks never allocate and work directly on the bytes they are given, so loaders can run them on a mapped file.
+ * Printable characters are checked 32 bytes at a time with AVX2 or 16 bytes at a time with SSE2, depending on what the
+ * compiler targets, and 8 bytes at a time with plain integer arithmetic otherwise. The batch functions are plain
+ * loops that run a single-field check over one field of many records; they take a stride, so the field can be picked
+ * out of an array of records, and they do no more work per field than the single-field checks.
  */
 class Utils {
 public:
- /**
+    /**
      * @brief Check if a date is valid.
      *
      * This function checks if a date is valid. A date is considered valid if it is in the format DD.MM.YYYY,
@@ -26,7 +46,16 @@ public:
      * @param date The date to check.
      * @return true if the date is valid, false otherwise.
      */
-    static bool isValidDate(const std::string &date);
+    static bool isValidDate(std::string_view date);
+
+    /**
+     * @brief Checks a date and converts it into the number of days since 01.01.1970 in a single pass.
+     *
+     * @param date The date to check, see isValidDate().
+     * @param days Receives the number of days if the date is valid, see dateToDays().
+     * @return true if the date is valid, false otherwise.
+     */
+    static bool parseDate(std::string_view date, std::int32_t &days);
 
     /**
      * @brief Check if a string contains invalid characters.
@@ -36,18 +65,137 @@ public:
      * @param str The string to check.
      * @return false if the string contains invalid characters, true otherwise.
      */
-    static bool containsValidChars(const std::string &str);
+    static bool containsValidChars(std::string_view str);
 
-        /**
+    /**
      * @brief Checks if the given ISSN is valid.
      *
      * This function checks if the given ISSN is valid according to the ISSN format. An ISSN is valid if it is a 9-character string where the first 4 characters are digits, the 5th character is a hyphen, the next 3 characters are digits, and the last character is either a digit or the letter 'X'.
+     * The check character is not compared against the digits, since catalogues written before it was checked may
+     * contain ISSNs that are wrong in this respect. New data should be checked with parseISSN().
      *
      * @param issn The ISSN to check.
      * @return true If the ISSN is valid.
      * @return false If the ISSN is invalid.
      */
-    static bool isValidISSN(const std::string &issn);
+    static bool isValidISSN(std::string_view issn);
+
+    /**
+     * @brief Checks an ISSN, including its mod-11 check character, and packs it in a single pass.
+     *
+     * The check character is the number that makes the sum of the seven digits, weighted 8 down to 2, plus the
+     * check character a multiple of 11, with 'X' standing for 10.
+     * @param issn The ISSN to check.
+     * @param packed Receives the packed ISSN unless it is malformed, see packISSN().
+     * @return Whether the ISSN is malformed, has a wrong check character or is valid.
+     */
+    static ISSNStatus parseISSN(std::string_view issn, std::uint32_t &packed);
+
+    /**
+     * @brief Runs containsValidChars() on one text field of many records, one record after the other.
+     *
+     * @param texts The field of the first record.
+     * @param count The number of records.
+     * @param stride The distance between the fields of two records, in fields.
+     * @param valid Receives for every record whether its field is valid.
+     * @return The number of valid fields.
+     */
+    static std::size_t validateChars(const std::string_view *texts, std::size_t count, std::size_t stride, bool *valid);
+
+    /**
+     * @brief Runs parseDate() on the date field of many records, one record after the other.
+     *
+     * @param dates The date of the first record.
+     * @param count The number of records.
+     * @param stride The distance between the dates of two records, in fields.
+     * @param days Receives for every record the number of days, if its date is valid.
+     * @param valid Receives for every record whether its date is valid.
+     * @return The number of valid dates.
+     */
+    static std::size_t validateDates(const std::string_view *dates, std::size_t count, std::size_t stride, std::int32_t *days, bool *valid);
+
+    /**
+     * @brief Runs parseISSN() on the ISSN field of many records, one record after the other.
+     *
+     * @param issns The ISSN of the first record.
+     * @param count The number of records.
+     * @param stride The distance between the ISSNs of two records, in fields.
+     * @param packed Receives for every record the packed ISSN, unless it is malformed.
+     * @param status Receives for every record the result of the check.
+     * @return The number of ISSNs that are not malformed.
+     */
+    static std::size_t validateISSNs(const std::string_view *issns, std::size_t count, std::size_t stride, std::uint32_t *packed, ISSNStatus *status);
+
+    /**
+     * @brief Parses a number that may be surrounded by blanks.
+     *
+     * @param text The text to parse.
+     * @param value Receives the number.
+     * @return true if the whole text is a number, false otherwise.
+     */
+    template <typename T>
+    static bool parseNumber(std::string_view text, T &value)
+    {
+        std::size_t begin = text.find_first_not_of(" \t");
+        std::size_t end = text.find_last_not_of(" \t");
+        if (begin == std::string_view::npos)
+        {
+            return false;
+        }
+        const char *last = text.data() + end + 1;
+        std::from_chars_result result = std::from_chars(text.data() + begin, last, value);
+        return result.ec == std::errc() && result.ptr == last;
+    }
+
+    /**
+     * @brief Packs a valid ISSN into an integer key.
+     *
+     * The seven leading digits are stored in the upper bits and the check character (0-9, or 10 for 'X')
+     * in the lowest four bits, so every ISSN maps to a unique value below 2^28.
+     * The ISSN must have been checked with isValidISSN() before.
+     *
+     * @param issn The ISSN to pack.
+     * @return The packed ISSN.
+     */
+    static std::uint32_t packISSN(std::string_view issn);
+
+    /**
+     * @brief Turns a packed ISSN back into its text form.
+     *
+     * @param packed An ISSN packed with packISSN().
+     * @return The ISSN in the format XXXX-XXXX, with an upper case 'X' as check character if needed.
+     */
+    static std::string unpackISSN(std::uint32_t packed);
+
+    /**
+     * @brief Converts a valid date into the number of days since 01.01.1970.
+     *
+     * Dates before 1970 give negative numbers. Later dates always give larger numbers, so the result can be used to
+     * compare and sort dates. The date must have been checked with isValidDate() before.
+     *
+     * @param date The date in the format DD.MM.YYYY.
+     * @return The number of days since 01.01.1970.
+     */
+    static std::int32_t dateToDays(std::string_view date);
+
+    /**
+     * @brief Converts a number of days since 01.01.1970 back into a date.
+     *
+     * @param days The number of days since 01.01.1970, as returned by dateToDays().
+     * @return The date in the format DD.MM.YYYY.
+     */
+    static std::string daysToDate(std::int32_t days);
+
+    /**
+     * @brief Computes a 64 bit checksum of a block of memory.
+     *
+     * The checksum processes eight bytes per step and is meant to detect damaged files, not deliberate changes.
+     *
+     * @param data The start of the memory block.
+     * @param size The size of the memory block in bytes.
+     * @return The checksum.
+     */
+    static std::uint64_t checksum(const char *data, std::size_t size);
 };
 
 #endif // UTILS_HPP
\ No newline at end of file